@@ -0,0 +1,121 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#include "harness.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <utility>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include "../src/utils/json.hpp"
+
+
+static volatile uint64_t sSink;
+
+static double getMedian(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+
+    size_t middle = values.size() / 2;
+
+    if (values.size() % 2 == 0)
+        return (values.at(middle - 1) + values.at(middle)) * 0.5;
+
+    return values.at(middle);
+}
+
+BenchmarkHarness::BenchmarkHarness(uint32_t warmupIterations, uint32_t iterations, std::string filter)
+    : mWarmupIterations(warmupIterations)
+    , mIterations(std::max(iterations, 1u))
+    , mFilter(std::move(filter))
+{
+}
+
+void BenchmarkHarness::run(const std::string& name,
+                           uint64_t items,
+                           const std::function<void()>& work,
+                           const std::function<void()>& prepare)
+{
+    if (!mFilter.empty() && name.find(mFilter) == std::string::npos)
+        return;
+
+    for (uint32_t i = 0; i < mWarmupIterations; ++i)
+    {
+        if (prepare)
+            prepare();
+        work();
+    }
+
+    std::vector<double> samples;
+    samples.reserve(mIterations);
+
+    for (uint32_t i = 0; i < mIterations; ++i)
+    {
+        if (prepare)
+            prepare();
+
+        Clock::time_point start = Clock::now();
+        work();
+        samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+    }
+
+    double median = getMedian(samples);
+
+    std::vector<double> deviations;
+    deviations.reserve(samples.size());
+
+    for (double sample : samples)
+        deviations.push_back(std::abs(sample - median));
+
+    BenchmarkResult result {
+        .name = name,
+        .iterations = mIterations,
+        .medianNs = median,
+        .madNs = getMedian(deviations),
+        .minNs = *std::min_element(samples.begin(), samples.end()),
+        .items = items
+    };
+
+    std::cout << result.name << ": " << result.medianNs / 1e6 << " ms median, +/- "
+              << result.madNs / 1e6 << " ms, " << result.minNs / 1e6 << " ms min";
+
+    if (result.items > 0)
+        std::cout << ", " << result.medianNs / static_cast<double>(result.items) << " ns per item";
+
+    std::cout << '\n';
+
+    mResults.push_back(result);
+}
+
+void BenchmarkHarness::writeJson(const std::string& filename) const
+{
+    std::ofstream file(filename);
+    if (!file.is_open())
+        throw std::runtime_error("Failed to write benchmark results: " + filename);
+
+    file << "{\n  ";
+    writeBuildInfoJson(file);
+    file << ",\n  \"warmupIterations\": " << mWarmupIterations << ",\n  \"benchmarks\": [";
+
+    for (size_t i = 0; i < mResults.size(); ++i)
+    {
+        const BenchmarkResult& result = mResults.at(i);
+
+        file << (i > 0? "," : "") << "\n    {\"name\": \"" << escapeJson(result.name)
+             << "\", \"iterations\": " << result.iterations
+             << ", \"medianNs\": " << result.medianNs
+             << ", \"madNs\": " << result.madNs
+             << ", \"minNs\": " << result.minNs
+             << ", \"items\": " << result.items << "}";
+    }
+
+    file << "\n  ]\n}\n";
+}
+
+void BenchmarkHarness::consume(uint64_t value)
+{
+    sSink = sSink + value;
+}
@@ -0,0 +1,55 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_HARNESS_HPP
+#define VULKAN3DMODELVIEWER_HARNESS_HPP
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+
+struct BenchmarkResult
+{
+    std::string name;
+    uint32_t iterations;
+    double medianNs;
+    // median absolute deviation from the median
+    double madNs;
+    double minNs;
+    // e.g. vertices or bytes handled by one iteration, 0 if there's no meaningful count
+    uint64_t items;
+};
+
+// Runs each benchmark for a number of untimed warmup iterations, then times every
+// iteration on its own. The median and its absolute deviation keep a few slow
+// iterations, e.g. from preemption or page faults, from skewing the result.
+class BenchmarkHarness
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    BenchmarkHarness(uint32_t warmupIterations, uint32_t iterations, std::string filter);
+
+    // prepare runs untimed before each iteration, e.g. to restore data the work consumes
+    void run(const std::string& name,
+             uint64_t items,
+             const std::function<void()>& work,
+             const std::function<void()>& prepare = {});
+
+    void writeJson(const std::string& filename) const;
+
+    // keeps the compiler from discarding work whose result is otherwise unused
+    static void consume(uint64_t value);
+
+private:
+    uint32_t mWarmupIterations;
+    uint32_t mIterations;
+    std::string mFilter;
+    std::vector<BenchmarkResult> mResults;
+};
+
+#endif //VULKAN3DMODELVIEWER_HARNESS_HPP
@@ -0,0 +1,361 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#include <array>
+#include <memory>
+#include <random>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include "harness.hpp"
+#include "../src/model/mesh_data.hpp"
+#include "../src/utils/image_data.hpp"
+#include "../src/camera/camera.hpp"
+#include "../src/model/bounding_box.hpp"
+
+
+static constexpr uint32_t MESH_VERTEX_COUNT = 1 << 18;
+static constexpr uint32_t MESH_FACE_COUNT = 1 << 19;
+static constexpr int TEXTURE_SIZE = 2048;
+static constexpr uint32_t CAMERA_UPDATE_COUNT = 10000;
+static constexpr uint32_t BOUNDING_BOX_COUNT = 100000;
+
+struct BenchOptions
+{
+    uint32_t warmupIterations = 3;
+    uint32_t iterations = 20;
+    std::string filter;
+    std::string jsonPath;
+    std::string imagePath; // decode this file instead of the synthetic PNG
+};
+
+static void printUsage()
+{
+    std::cout << "Usage: vmv_bench [options]\n"
+                 "    --warmup <n>       untimed iterations before each benchmark (3)\n"
+                 "    --iterations <n>   timed iterations of each benchmark (20)\n"
+                 "    --filter <text>    only run the benchmarks whose name contains the text\n"
+                 "    --json <file>      also write the results to a JSON file\n"
+                 "    --image <file>     decode this image instead of the synthetic PNG\n";
+}
+
+static BenchOptions parseBenchOptions(int argc, char** argv)
+{
+    BenchOptions options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        auto nextValue = [&] () -> std::string {
+            if (i + 1 >= argc)
+                throw std::runtime_error("Missing value for option: " + arg);
+            return argv[++i];
+        };
+
+        // stoul only names itself in its exceptions
+        auto nextCount = [&] () -> uint32_t {
+            std::string value = nextValue();
+            try
+            {
+                return static_cast<uint32_t>(std::stoul(value));
+            }
+            catch (const std::logic_error&)
+            {
+                throw std::runtime_error("Invalid value for option " + arg + ": " + value);
+            }
+        };
+
+        if (arg == "--warmup")
+            options.warmupIterations = nextCount();
+        else if (arg == "--iterations")
+            options.iterations = nextCount();
+        else if (arg == "--filter")
+            options.filter = nextValue();
+        else if (arg == "--json")
+            options.jsonPath = nextValue();
+        else if (arg == "--image")
+            options.imagePath = nextValue();
+        else
+            throw std::runtime_error("Unknown option: " + arg);
+    }
+
+    return options;
+}
+
+// a mesh the way assimp hands it over after triangulation and tangent generation,
+// the destructor releases the arrays
+static std::unique_ptr<aiMesh> createSyntheticMesh(std::mt19937& random)
+{
+    std::uniform_real_distribution<float> position(-10.f, 10.f);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    std::uniform_int_distribution<uint32_t> index(0, MESH_VERTEX_COUNT - 1);
+
+    auto mesh = std::make_unique<aiMesh>();
+
+    mesh->mNumVertices = MESH_VERTEX_COUNT;
+    mesh->mVertices = new aiVector3D[MESH_VERTEX_COUNT];
+    mesh->mNormals = new aiVector3D[MESH_VERTEX_COUNT];
+    mesh->mTangents = new aiVector3D[MESH_VERTEX_COUNT];
+    mesh->mBitangents = new aiVector3D[MESH_VERTEX_COUNT];
+    mesh->mTextureCoords[0] = new aiVector3D[MESH_VERTEX_COUNT];
+    mesh->mNumUVComponents[0] = 2;
+
+    for (uint32_t i = 0; i < MESH_VERTEX_COUNT; ++i)
+    {
+        mesh->mVertices[i] = aiVector3D(position(random), position(random), position(random));
+        mesh->mNormals[i] = aiVector3D(0.f, 1.f, 0.f);
+        mesh->mTangents[i] = aiVector3D(1.f, 0.f, 0.f);
+        mesh->mBitangents[i] = aiVector3D(0.f, 0.f, 1.f);
+        mesh->mTextureCoords[0][i] = aiVector3D(unit(random), unit(random), 0.f);
+    }
+
+    mesh->mNumFaces = MESH_FACE_COUNT;
+    mesh->mFaces = new aiFace[MESH_FACE_COUNT];
+
+    for (uint32_t i = 0; i < MESH_FACE_COUNT; ++i)
+    {
+        aiFace& face = mesh->mFaces[i];
+
+        face.mNumIndices = 3;
+        face.mIndices = new unsigned int[3] {index(random), index(random), index(random)};
+    }
+
+    return mesh;
+}
+
+static void appendBigEndian(std::vector<uint8_t>& data, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        data.push_back(static_cast<uint8_t>(value >> shift));
+}
+
+static uint32_t getCrc32(const uint8_t* data, size_t size)
+{
+    static const std::array<uint32_t, 256> table = [] () {
+        std::array<uint32_t, 256> table {};
+
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = crc & 1? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+            table.at(i) = crc;
+        }
+
+        return table;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (size_t i = 0; i < size; ++i)
+        crc = table.at((crc ^ data[i]) & 0xFF) ^ (crc >> 8);
+
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static void appendPngChunk(std::vector<uint8_t>& png, const char* type, const std::vector<uint8_t>& data)
+{
+    appendBigEndian(png, static_cast<uint32_t>(data.size()));
+
+    size_t typeOffset = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+
+    appendBigEndian(png, getCrc32(png.data() + typeOffset, png.size() - typeOffset));
+}
+
+// An RGBA PNG with every row filtered, the filters cycling through all four kinds, so
+// decoding unfilters every byte. The zlib stream holds stored deflate blocks since there's
+// no compressor at hand, inflate time is therefore lower than for a compressed texture.
+// The filtered bytes are random, the decoder unfilters whatever it's given.
+static std::vector<uint8_t> createSyntheticPng(std::mt19937& random)
+{
+    std::uniform_int_distribution<uint32_t> byte(0, 255);
+
+    std::vector<uint8_t> scanlines;
+    scanlines.reserve(static_cast<size_t>(TEXTURE_SIZE) * (TEXTURE_SIZE * 4 + 1));
+
+    for (int y = 0; y < TEXTURE_SIZE; ++y)
+    {
+        scanlines.push_back(static_cast<uint8_t>(y % 4 + 1));
+        for (int x = 0; x < TEXTURE_SIZE * 4; ++x)
+            scanlines.push_back(static_cast<uint8_t>(byte(random)));
+    }
+
+    std::vector<uint8_t> zlib {0x78, 0x01};
+    uint32_t adlerA = 1;
+    uint32_t adlerB = 0;
+
+    for (size_t offset = 0; offset < scanlines.size(); offset += 65535)
+    {
+        auto blockSize = static_cast<uint16_t>(std::min<size_t>(scanlines.size() - offset, 65535));
+        auto invertedSize = static_cast<uint16_t>(~blockSize);
+        bool last = offset + blockSize == scanlines.size();
+
+        zlib.push_back(last? 1 : 0);
+        zlib.push_back(static_cast<uint8_t>(blockSize));
+        zlib.push_back(static_cast<uint8_t>(blockSize >> 8));
+        zlib.push_back(static_cast<uint8_t>(invertedSize));
+        zlib.push_back(static_cast<uint8_t>(invertedSize >> 8));
+        zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + blockSize);
+    }
+
+    for (uint8_t value : scanlines)
+    {
+        adlerA = (adlerA + value) % 65521;
+        adlerB = (adlerB + adlerA) % 65521;
+    }
+
+    appendBigEndian(zlib, (adlerB << 16) | adlerA);
+
+    std::vector<uint8_t> header;
+    appendBigEndian(header, TEXTURE_SIZE);
+    appendBigEndian(header, TEXTURE_SIZE);
+    header.insert(header.end(), {8, 6, 0, 0, 0}); // 8 bits per channel, RGBA
+
+    std::vector<uint8_t> png {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    appendPngChunk(png, "IHDR", header);
+    appendPngChunk(png, "IDAT", zlib);
+    appendPngChunk(png, "IEND", {});
+
+    return png;
+}
+
+static std::vector<uint8_t> readFile(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open image: " + filename);
+
+    std::vector<uint8_t> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+
+    return data;
+}
+
+// boxes scattered around the origin, partly in front of and partly around the camera
+static std::vector<BoundingBox> createSyntheticBounds(std::mt19937& random)
+{
+    std::uniform_real_distribution<float> position(-50.f, 50.f);
+    std::uniform_real_distribution<float> size(0.1f, 2.f);
+
+    std::vector<BoundingBox> bounds(BOUNDING_BOX_COUNT);
+
+    for (BoundingBox& box : bounds)
+    {
+        box.min = glm::vec3(position(random), position(random), position(random));
+        box.max = box.min + glm::vec3(size(random), size(random), size(random));
+    }
+
+    return bounds;
+}
+
+static void runBenchmarks(BenchmarkHarness& harness, const BenchOptions& options)
+{
+    std::mt19937 random(42);
+
+    std::unique_ptr<aiMesh> mesh = createSyntheticMesh(random);
+
+    harness.run("getVertices", MESH_VERTEX_COUNT, [&mesh] () {
+        std::vector<Vertex> vertices = getVertices(*mesh);
+        BenchmarkHarness::consume(vertices.size());
+    });
+
+    harness.run("getIndices", MESH_FACE_COUNT * 3, [&mesh] () {
+        std::vector<uint32_t> indices = getIndices(*mesh);
+        BenchmarkHarness::consume(indices.back());
+    });
+
+    mesh.reset();
+
+    std::vector<uint8_t> encoded = options.imagePath.empty()? createSyntheticPng(random) : readFile(options.imagePath);
+    ImageData source = decodeImageData(encoded.data(), encoded.size());
+
+    if (!source.pixels)
+        throw std::runtime_error("Failed to decode the benchmark image");
+
+    harness.run("decodeImageData", static_cast<uint64_t>(source.width) * source.height, [&encoded] () {
+        ImageData imageData = decodeImageData(encoded.data(), encoded.size());
+        BenchmarkHarness::consume(imageData.pixels[0]);
+        freeImageData(imageData);
+    });
+
+    // downsampleImageData replaces the pixels it's given, so each iteration starts from a copy
+    ImageData imageData {};
+    size_t sourceSize = static_cast<size_t>(source.width) * source.height * 4;
+
+    auto copySource = [&] () {
+        freeImageData(imageData);
+        imageData = {static_cast<uint8_t*>(std::malloc(sourceSize)), source.width, source.height};
+        std::memcpy(imageData.pixels, source.pixels, sourceSize);
+    };
+
+    harness.run("downsampleImageData", static_cast<uint64_t>(source.width) * source.height, [&imageData] () {
+        downsampleImageData(imageData, 1);
+        BenchmarkHarness::consume(imageData.pixels[0]);
+    }, copySource);
+
+    freeImageData(imageData);
+    freeImageData(source);
+
+    Camera camera(glm::radians(45.f), 1920.f, 1080.f);
+
+    // setRotation is the public way into recalculateView, which it calls unconditionally
+    harness.run("Camera::recalculateView", CAMERA_UPDATE_COUNT, [&camera] () {
+        for (uint32_t i = 0; i < CAMERA_UPDATE_COUNT; ++i)
+            camera.setRotation(static_cast<float>(i) * 0.001f, static_cast<float>(i) * 0.002f);
+        BenchmarkHarness::consume(static_cast<uint64_t>(camera.viewProjection()[0][0] * 1000.f));
+    });
+
+    std::vector<BoundingBox> bounds = createSyntheticBounds(random);
+
+    camera.setRotation(0.f, 0.f);
+    camera.setPosition(0.f, 0.f, 60.f);
+
+    harness.run("frustum culling", BOUNDING_BOX_COUNT, [&camera, &bounds] () {
+        Frustum frustum = getFrustum(camera.viewProjection());
+
+        uint64_t visibleCount = 0;
+        for (const BoundingBox& box : bounds)
+            visibleCount += intersectsFrustum(frustum, box);
+
+        BenchmarkHarness::consume(visibleCount);
+    });
+}
+
+// CPU hot paths on synthetic data, no window or render device is created
+int main(int argc, char** argv)
+{
+    if (argc > 1 && std::string(argv[1]) == "--help")
+    {
+        printUsage();
+        return 0;
+    }
+
+    BenchOptions options;
+
+    try
+    {
+        options = parseBenchOptions(argc, argv);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << "\n\n";
+        printUsage();
+        return 1;
+    }
+    BenchmarkHarness harness(options.warmupIterations, options.iterations, options.filter);
+
+    std::cout << "Benchmarks (" << options.warmupIterations << " warmup, " << options.iterations << " timed iterations)\n";
+    runBenchmarks(harness, options);
+
+    if (!options.jsonPath.empty())
+        harness.writeJson(options.jsonPath);
+}
@@ -0,0 +1,38 @@
+# Writes the commit the build comes from to OUTPUT. Run on every build, the file is only
+# rewritten when the commit changed, so json.cpp recompiles only then.
+
+cmake_minimum_required(VERSION 3.28)
+
+execute_process(COMMAND git rev-parse --short=12 HEAD
+        WORKING_DIRECTORY ${SOURCE_DIR}
+        OUTPUT_VARIABLE BUILD_COMMIT
+        OUTPUT_STRIP_TRAILING_WHITESPACE
+        RESULT_VARIABLE GIT_RESULT
+        ERROR_QUIET)
+
+if (GIT_RESULT EQUAL 0)
+    execute_process(COMMAND git log -1 --format=%cI
+            WORKING_DIRECTORY ${SOURCE_DIR}
+            OUTPUT_VARIABLE BUILD_DATE
+            OUTPUT_STRIP_TRAILING_WHITESPACE
+            ERROR_QUIET)
+
+    # uncommitted changes in tracked files
+    execute_process(COMMAND git diff --quiet HEAD
+            WORKING_DIRECTORY ${SOURCE_DIR}
+            RESULT_VARIABLE GIT_DIRTY
+            ERROR_QUIET)
+
+    if (NOT GIT_DIRTY EQUAL 0)
+        string(APPEND BUILD_COMMIT "-dirty")
+    endif ()
+else ()
+    set(BUILD_COMMIT "unknown")
+    set(BUILD_DATE "unknown")
+endif ()
+
+file(CONFIGURE OUTPUT ${OUTPUT} CONTENT
+"// generated by cmake/build_info.cmake
+#define VMV_BUILD_COMMIT \"@BUILD_COMMIT@\"
+#define VMV_BUILD_DATE \"@BUILD_DATE@\"
+" @ONLY)
@@ -0,0 +1,17 @@
+#version 460 core
+
+layout (location = 0) in vec3 position;
+layout (location = 5) in mat4 instanceTransform;
+
+layout (set = 0, binding = 0) uniform UBO
+{
+    mat4 mvp;
+} ubo;
+
+// has to match model_vert exactly for the depth pre-pass equal test
+invariant gl_Position;
+
+void main()
+{
+    gl_Position = ubo.mvp * (instanceTransform * vec4(position, 1.f));
+}
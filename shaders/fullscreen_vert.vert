@@ -0,0 +1,10 @@
+#version 460 core
+
+layout (location = 0) out vec2 vTexCoords;
+
+// a single triangle covering the screen, generated from the vertex index
+void main()
+{
+    vTexCoords = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    gl_Position = vec4(vTexCoords * 2.f - 1.f, 0.f, 1.f);
+}
@@ -0,0 +1,150 @@
+#version 460 core
+
+layout (location = 0) in vec2 vTexCoords;
+
+layout (location = 0) out vec4 outColor;
+
+layout (push_constant) uniform PushConstants
+{
+    vec2 inverseScreenSize;
+};
+
+layout (set = 0, binding = 0) uniform sampler2D sceneColor;
+
+const float EDGE_THRESHOLD_MIN = 0.0312;
+const float EDGE_THRESHOLD_MAX = 0.125;
+const float SUBPIXEL_QUALITY = 0.75;
+const int ITERATIONS = 12;
+const float QUALITY[ITERATIONS] = float[](1.0, 1.0, 1.0, 1.0, 1.0, 1.5, 2.0, 2.0, 2.0, 2.0, 4.0, 8.0);
+
+float luma(vec3 rgb)
+{
+    return sqrt(dot(rgb, vec3(0.299, 0.587, 0.114)));
+}
+
+float lumaAt(vec2 uv, ivec2 offset)
+{
+    return luma(textureLodOffset(sceneColor, uv, 0.0, offset).rgb);
+}
+
+void main()
+{
+    vec3 colorCenter = texture(sceneColor, vTexCoords).rgb;
+
+    float lumaCenter = luma(colorCenter);
+    float lumaDown = lumaAt(vTexCoords, ivec2(0, -1));
+    float lumaUp = lumaAt(vTexCoords, ivec2(0, 1));
+    float lumaLeft = lumaAt(vTexCoords, ivec2(-1, 0));
+    float lumaRight = lumaAt(vTexCoords, ivec2(1, 0));
+
+    float lumaMin = min(lumaCenter, min(min(lumaDown, lumaUp), min(lumaLeft, lumaRight)));
+    float lumaMax = max(lumaCenter, max(max(lumaDown, lumaUp), max(lumaLeft, lumaRight)));
+    float lumaRange = lumaMax - lumaMin;
+
+    // not an edge, or too dark to notice
+    if (lumaRange < max(EDGE_THRESHOLD_MIN, lumaMax * EDGE_THRESHOLD_MAX))
+    {
+        outColor = vec4(colorCenter, 1.0);
+        return;
+    }
+
+    float lumaDownLeft = lumaAt(vTexCoords, ivec2(-1, -1));
+    float lumaUpRight = lumaAt(vTexCoords, ivec2(1, 1));
+    float lumaUpLeft = lumaAt(vTexCoords, ivec2(-1, 1));
+    float lumaDownRight = lumaAt(vTexCoords, ivec2(1, -1));
+
+    float lumaDownUp = lumaDown + lumaUp;
+    float lumaLeftRight = lumaLeft + lumaRight;
+    float lumaLeftCorners = lumaDownLeft + lumaUpLeft;
+    float lumaDownCorners = lumaDownLeft + lumaDownRight;
+    float lumaRightCorners = lumaDownRight + lumaUpRight;
+    float lumaUpCorners = lumaUpRight + lumaUpLeft;
+
+    float edgeHorizontal = abs(-2.0 * lumaLeft + lumaLeftCorners) +
+                           abs(-2.0 * lumaCenter + lumaDownUp) * 2.0 +
+                           abs(-2.0 * lumaRight + lumaRightCorners);
+    float edgeVertical = abs(-2.0 * lumaUp + lumaUpCorners) +
+                         abs(-2.0 * lumaCenter + lumaLeftRight) * 2.0 +
+                         abs(-2.0 * lumaDown + lumaDownCorners);
+    bool isHorizontal = edgeHorizontal >= edgeVertical;
+
+    // pick the side of the edge with the steepest gradient
+    float luma1 = isHorizontal? lumaDown : lumaLeft;
+    float luma2 = isHorizontal? lumaUp : lumaRight;
+    float gradient1 = luma1 - lumaCenter;
+    float gradient2 = luma2 - lumaCenter;
+    bool is1Steepest = abs(gradient1) >= abs(gradient2);
+    float gradientScaled = 0.25 * max(abs(gradient1), abs(gradient2));
+
+    float stepLength = isHorizontal? inverseScreenSize.y : inverseScreenSize.x;
+    float lumaLocalAverage;
+
+    if (is1Steepest)
+    {
+        stepLength = -stepLength;
+        lumaLocalAverage = 0.5 * (luma1 + lumaCenter);
+    }
+    else
+    {
+        lumaLocalAverage = 0.5 * (luma2 + lumaCenter);
+    }
+
+    vec2 currentUv = vTexCoords;
+    if (isHorizontal)
+        currentUv.y += stepLength * 0.5;
+    else
+        currentUv.x += stepLength * 0.5;
+
+    // walk along the edge in both directions until its end is found
+    vec2 offset = isHorizontal? vec2(inverseScreenSize.x, 0.0) : vec2(0.0, inverseScreenSize.y);
+    vec2 uv1 = currentUv - offset * QUALITY[0];
+    vec2 uv2 = currentUv + offset * QUALITY[0];
+
+    float lumaEnd1 = luma(textureLod(sceneColor, uv1, 0.0).rgb) - lumaLocalAverage;
+    float lumaEnd2 = luma(textureLod(sceneColor, uv2, 0.0).rgb) - lumaLocalAverage;
+    bool reached1 = abs(lumaEnd1) >= gradientScaled;
+    bool reached2 = abs(lumaEnd2) >= gradientScaled;
+
+    for (int i = 1; i < ITERATIONS && !(reached1 && reached2); ++i)
+    {
+        if (!reached1)
+        {
+            uv1 -= offset * QUALITY[i];
+            lumaEnd1 = luma(textureLod(sceneColor, uv1, 0.0).rgb) - lumaLocalAverage;
+            reached1 = abs(lumaEnd1) >= gradientScaled;
+        }
+
+        if (!reached2)
+        {
+            uv2 += offset * QUALITY[i];
+            lumaEnd2 = luma(textureLod(sceneColor, uv2, 0.0).rgb) - lumaLocalAverage;
+            reached2 = abs(lumaEnd2) >= gradientScaled;
+        }
+    }
+
+    float distance1 = isHorizontal? (vTexCoords.x - uv1.x) : (vTexCoords.y - uv1.y);
+    float distance2 = isHorizontal? (uv2.x - vTexCoords.x) : (uv2.y - vTexCoords.y);
+    bool isDirection1 = distance1 < distance2;
+    float distanceFinal = min(distance1, distance2);
+    float edgeThickness = distance1 + distance2;
+
+    bool isLumaCenterSmaller = lumaCenter < lumaLocalAverage;
+    bool correctVariation = ((isDirection1? lumaEnd1 : lumaEnd2) < 0.0) != isLumaCenterSmaller;
+    float pixelOffset = correctVariation? (-distanceFinal / edgeThickness + 0.5) : 0.0;
+
+    // sub-pixel aliasing
+    float lumaAverage = (1.0 / 12.0) * (2.0 * (lumaDownUp + lumaLeftRight) + lumaLeftCorners + lumaRightCorners);
+    float subPixelOffset1 = clamp(abs(lumaAverage - lumaCenter) / lumaRange, 0.0, 1.0);
+    float subPixelOffset2 = (-2.0 * subPixelOffset1 + 3.0) * subPixelOffset1 * subPixelOffset1;
+    float subPixelOffsetFinal = subPixelOffset2 * subPixelOffset2 * SUBPIXEL_QUALITY;
+
+    pixelOffset = max(pixelOffset, subPixelOffsetFinal);
+
+    vec2 finalUv = vTexCoords;
+    if (isHorizontal)
+        finalUv.y += pixelOffset * stepLength;
+    else
+        finalUv.x += pixelOffset * stepLength;
+
+    outColor = vec4(textureLod(sceneColor, finalUv, 0.0).rgb, 1.0);
+}
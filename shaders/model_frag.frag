@@ -1,8 +1,25 @@
 #version 460 core
+#extension GL_EXT_nonuniform_qualifier : require
 #include "material.glsl"
 
 
+// the material's features, every combination in use gets its own pipeline so
+// the branches on them are resolved when the pipeline is compiled
+layout (constant_id = 0) const bool HAS_DIFFUSE_MAP = false;
+layout (constant_id = 1) const bool HAS_SPECULAR_MAP = false;
+layout (constant_id = 2) const bool HAS_NORMAL_MAP = false;
+
+// the ubershader reads the features from the material instead, draws use it
+// until their specialized pipeline finished compiling
+layout (constant_id = 3) const bool GENERIC_MATERIAL = false;
+
+const float SHININESS = 32.0;
+
 layout (location = 0) in vec2 vTexCoords;
+layout (location = 1) in vec3 vViewPosition;
+layout (location = 2) in vec3 vNormal;
+layout (location = 3) in vec3 vTangent;
+layout (location = 4) in vec3 vBitangent;
 
 layout (location = 0) out vec4 outColor;
 
@@ -16,13 +33,18 @@ layout (set = 1, binding = 0) readonly buffer MaterialSSBO
     Material materials[];
 };
 
-layout (set = 1, binding = 1) uniform sampler2D textures[46];
+// shared by every loaded model, only the loaded textures are bound
+layout (set = 1, binding = 1) uniform sampler2D textures[];
 
 void main()
 {
     Material material = materials[materialIndex];
 
-    if (material.hasDiffuseMap == 1)
+    bool hasDiffuseMap = GENERIC_MATERIAL? material.hasDiffuseMap != 0 : HAS_DIFFUSE_MAP;
+    bool hasSpecularMap = GENERIC_MATERIAL? material.hasSpecularMap != 0 : HAS_SPECULAR_MAP;
+    bool hasNormalMap = GENERIC_MATERIAL? material.hasNormalMap != 0 : HAS_NORMAL_MAP;
+
+    if (hasDiffuseMap)
     {
         outColor = texture(textures[material.diffuseMapIndex], vTexCoords);
     }
@@ -30,4 +52,21 @@ void main()
     {
         outColor = vec4(0.5, 0.5, 0.5, 1);
     }
-}
\ No newline at end of file
+
+    // a highlight from a light at the camera, shaped by the normal map where there is one
+    if (hasSpecularMap)
+    {
+        vec3 normal = normalize(vNormal);
+
+        if (hasNormalMap)
+        {
+            vec3 tangentNormal = texture(textures[material.normalMapIndex], vTexCoords).xyz * 2.0 - 1.0;
+            normal = normalize(mat3(normalize(vTangent), normalize(vBitangent), normal) * tangentNormal);
+        }
+
+        vec3 viewDirection = normalize(-vViewPosition);
+        float highlight = pow(abs(dot(normal, viewDirection)), SHININESS);
+
+        outColor.rgb += texture(textures[material.specularMapIndex], vTexCoords).rgb * highlight;
+    }
+}
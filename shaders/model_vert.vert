@@ -5,16 +5,36 @@ layout (location = 1) in vec3 normal;
 layout (location = 2) in vec3 tangent;
 layout (location = 3) in vec3 bitangent;
 layout (location = 4) in vec2 texCoords;
+layout (location = 5) in mat4 instanceTransform;
+layout (location = 9) in mat3 instanceNormalTransform;
 
 layout (location = 0) out vec2 vTexCoords;
+layout (location = 1) out vec3 vViewPosition;
+layout (location = 2) out vec3 vNormal;
+layout (location = 3) out vec3 vTangent;
+layout (location = 4) out vec3 vBitangent;
 
 layout (set = 0, binding = 0) uniform UBO
 {
     mat4 mvp;
+    mat4 modelView;
+    mat3 normalMatrix;
 } ubo;
 
+// has to match depth_vert exactly for the depth pre-pass equal test
+invariant gl_Position;
+
 void main()
 {
-    gl_Position = ubo.mvp * vec4(position, 1.f);
+    gl_Position = ubo.mvp * (instanceTransform * vec4(position, 1.f));
+
+    // the inverse transpose of a product is the product of the inverse transposes
+    mat4 instanceModelView = ubo.modelView * instanceTransform;
+    mat3 normalMatrix = ubo.normalMatrix * instanceNormalTransform;
+
     vTexCoords = texCoords;
-}
\ No newline at end of file
+    vViewPosition = vec3(instanceModelView * vec4(position, 1.f));
+    vNormal = normalMatrix * normal;
+    vTangent = normalMatrix * tangent;
+    vBitangent = normalMatrix * bitangent;
+}
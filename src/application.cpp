@@ -8,253 +8,661 @@
 static constexpr int INITIAL_WINDOW_WIDTH = 1920;
 static constexpr int INITIAL_WINDOW_HEIGHT = 1080;
 static constexpr char* const WINDOW_TITLE = "3D Model Viewer";
+static constexpr VkDeviceSize UNIFORM_RING_FRAME_SIZE = 64 * 1024;
+static constexpr VkFormat DEPTH_FORMAT = VK_FORMAT_D32_SFLOAT;
+static constexpr uint32_t MAX_TEXTURE_TABLE_SIZE = 16384;
+static constexpr const char* PIPELINE_CACHE_FILE = "pipeline_cache.bin";
 
-Application::Application()
-    : mLeftMouseButtonPressed()
+// below this, a chunk's recording is cheaper than handing it to a worker
+static constexpr size_t MIN_DRAWS_PER_CHUNK = 16;
+
+// indices into the scene pipelines referenced by draw list entries, the shaded
+// pipelines follow the depth pre-pass one in order of their material features
+static constexpr uint32_t DEPTH_PREPASS_PIPELINE = 0;
+static constexpr uint32_t SHADED_PIPELINE = 1;
+
+struct SceneUniforms
+{
+    glm::mat4 mvp;
+    glm::mat4 modelView;
+    // inverse transpose of modelView, std140 pads the mat3 columns to vec4
+    glm::mat4 normalMatrix;
+};
+
+// upper bound of the texture table, the descriptor set only allocates the loaded textures
+static uint32_t getTextureTableSize(VulkanRenderDevice& renderDevice)
+{
+    const VkPhysicalDeviceLimits& limits = getPhysicalDeviceProperties(renderDevice).limits;
+
+    return std::min({MAX_TEXTURE_TABLE_SIZE,
+                     limits.maxPerStageDescriptorSamplers,
+                     limits.maxPerStageDescriptorSampledImages,
+                     limits.maxDescriptorSetSamplers,
+                     limits.maxDescriptorSetSampledImages});
+}
+
+static uint32_t getThreadCount(uint32_t requested)
+{
+    if (requested > 0)
+        return requested;
+
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+static VkSampleCountFlagBits getRequestedSampleCount(AntiAliasing antiAliasing)
+{
+    switch (antiAliasing)
+    {
+        case AntiAliasing::MSAA2: return VK_SAMPLE_COUNT_2_BIT;
+        case AntiAliasing::MSAA4: return VK_SAMPLE_COUNT_4_BIT;
+        case AntiAliasing::MSAA8: return VK_SAMPLE_COUNT_8_BIT;
+        default: return VK_SAMPLE_COUNT_1_BIT;
+    }
+}
+
+Application::Application(const Options& options)
+    : mStartupReport()
+    , mStartupReportPath(options.startupReportPath)
+    , mFirstFramePresented()
+    , mFallbackFrameCount()
+    , mWorstFallbackFrameMs()
+    , mRenderThreadCompileMs()
+    , mRecordInputPath(options.recordInputPath)
+    , mInputRecording()
+    , mInputRecordingStart()
+    , mReplayPath(options.replayPath)
+    , mReplayRecording()
+    , mReplayTimestepMs(options.replayTimestepMs)
+    , mReplayReportPath(options.replayReportPath)
+    , mHeadless(options.headless)
+    , mRenderMode(options.renderMode)
+    , mRedrawRequested(true)
+    , mPrintFrameStats(options.printFrameStats)
+    , mLastFrameStatsReport(FramePacer::Clock::now())
+    , mMemoryReportPath(options.memoryReportPath)
+    , mLastGpuTimeMs()
+    , mGpuTimeTotalMs()
+    , mGpuTimeSamples()
+    , mFragmentInvocationsTotal()
+    , mFragmentInvocationSamples()
+    , mLoadJobSystem(getThreadCount(options.loadThreadCount) - 1)
+    , mFileReader(mLoadJobSystem, options.ioUring)
+    , mRecordThreadPool(getThreadCount(options.recordThreadCount))
+    , mRecordTimeTotalMs()
+    , mDrawSortTimeTotalMs()
+    , mRecordTimeSamples()
+    , mShadedPipelines()
+    , mShadedVertexShader()
+    , mShadedFragmentShader()
+    , mUbershaderPipeline()
+    , mSharedPipelineLibrary()
+    , mFragmentPipelineLibraries()
+    , mPipelineCompiles()
+    , mPendingPipelineCompiles()
+    , mOptimizedPipelineCompileMs()
+    , mDepthPrepass(options.depthPrepass)
+    , mDepthPrepassPipeline()
+    , mAntiAliasing(options.antiAliasing)
+    , mSampleCount(VK_SAMPLE_COUNT_1_BIT)
+    , mSwapchainResource()
+    , mSceneColorResource()
+    , mPostPipelineLayout()
+    , mPostPipeline()
+    , mPostLayout()
+    , mPostSampler()
+    , mPostSets()
+    , mPostSetVersions()
+    , mAttachmentVersion()
+    , mLeftMouseButtonPressed()
     , mCursorPosX()
     , mCursorPosY()
     , mRotationX()
     , mRotationY()
     , mScale(1.f)
     , mOrbitNavSensitivity(0.15f)
+    , mPendingRotationX()
+    , mPendingRotationY()
+    , mPendingScroll()
 {
-    initializeGLFW();
-    createInstance(mInstance);
-    createSurface(mInstance, mWindow);
-    createRenderingDevice(mInstance, mRenderDevice);
-    createSampledColorImage();
-    createDepthImage();
-    createViewProjUBO();
+    mFramePacer.setTargetFps(options.targetFps);
+    mRenderDevice.presentPolicy = options.presentPolicy;
+    mRenderDevice.requestedSwapchainImageCount = options.swapchainImageCount;
 
-    setupCamera();
-    updateViewProjUBO();
-    createModel(mModel, mRenderDevice, "../assets/sponza/sponza.obj");
+    // read up front, the recording's extent sizes the window or the headless images
+    if (!mReplayPath.empty())
+        mReplayRecording = loadInputRecording(mReplayPath);
+
+    if (mHeadless)
+    {
+        mWindow = nullptr;
+        mStartupReport.measure("create instance", [this] {
+            createInstance(mInstance, mHeadless);
+            mInstance.surface = VK_NULL_HANDLE;
+        });
+        mStartupReport.measure("create rendering device", [this] {
+            createHeadlessRenderingDevice(mInstance, mRenderDevice, mReplayRecording.extent);
+        });
+    }
+    else
+    {
+        mStartupReport.measure("initialize GLFW", [this] { initializeGLFW(); });
+        mStartupReport.measure("create instance", [this] {
+            createInstance(mInstance, mHeadless);
+            createSurface(mInstance, mWindow);
+        });
+        mStartupReport.measure("create rendering device", [this] { createRenderingDevice(mInstance, mRenderDevice); });
+    }
+
+    mStartupReport.measure("create frame resources", [this] {
+        mSampleCount = std::min(getRequestedSampleCount(mAntiAliasing), getMaxSampleCount(mRenderDevice));
+        mGpuTimer = createGpuTimer(mRenderDevice);
+        mPipelineStatistics = createPipelineStatistics(mRenderDevice);
+        mUniformRingBuffer = createUniformRingBuffer(mRenderDevice, UNIFORM_RING_FRAME_SIZE);
+        mPipelineCache = createPipelineCache(mRenderDevice, PIPELINE_CACHE_FILE);
+
+        mSecondaryCommandPools.resize(mRecordThreadPool.threadCount());
+        for (std::array<SecondaryCommandPool, FRAMES_IN_FLIGHT>& threadPools : mSecondaryCommandPools)
+            for (SecondaryCommandPool& pool : threadPools)
+                pool = createSecondaryCommandPool(mRenderDevice);
+    });
 
-    createDescriptorResources();
-    createRenderPass();
-    createFramebuffers();
-    createGraphicsPipeline();
+    setupCamera();
+    updateModelMatrix();
+    mStartupReport.measure("load scene", [this, &options] { loadScene(getModelPlacements(options)); });
+
+    mStartupReport.measure("create descriptor resources", [this] { createDescriptorResources(); });
+    mStartupReport.measure("create graphics pipelines", [this] {
+        createGraphicsPipeline();
+        createDepthPrepassPipeline();
+    });
+    mStartupReport.measure("build render graph", [this] {
+        createPostProcessing();
+        buildRenderGraph();
+    });
+
+    if (!mMemoryReportPath.empty())
+        writeMemoryReport(mRenderDevice, mMemoryReportPath);
 }
 
 Application::~Application()
 {
-    destroyBuffer(mRenderDevice, mModelViewProjUBO);
-    vkDestroyPipeline(mRenderDevice.device, mGraphicsPipeline, nullptr);
+    destroyUniformRingBuffer(mRenderDevice, mUniformRingBuffer);
+    destroyShadedPipelines();
+    vkDestroyPipeline(mRenderDevice.device, mDepthPrepassPipeline, nullptr);
     vkDestroyPipelineLayout(mRenderDevice.device, mPipelineLayout, nullptr);
     destroyModel(mModel, mRenderDevice);
-    std::for_each(mFramebuffers.begin(), mFramebuffers.end(),
-                  [this] (auto fb) { vkDestroyFramebuffer(mRenderDevice.device, fb,nullptr); });
-    vkDestroyRenderPass(mRenderDevice.device, mRenderPass, nullptr);
-    destroyImage(mRenderDevice, mDepthImage);
-    destroyImage(mRenderDevice, mSampledColorImage);
+    mRenderGraph.destroy(mRenderDevice);
+    destroyPostProcessing();
+    destroyGpuTimer(mRenderDevice, mGpuTimer);
+    destroyPipelineStatistics(mRenderDevice, mPipelineStatistics);
+    for (std::array<SecondaryCommandPool, FRAMES_IN_FLIGHT>& threadPools : mSecondaryCommandPools)
+        for (SecondaryCommandPool& pool : threadPools)
+            destroySecondaryCommandPool(mRenderDevice, pool);
     destroyDescriptorResources();
+    if (!savePipelineCache(mRenderDevice, mPipelineCache, PIPELINE_CACHE_FILE))
+        std::cerr << "Failed to save the pipeline cache to " << PIPELINE_CACHE_FILE << '\n';
+    vkDestroyPipelineCache(mRenderDevice.device, mPipelineCache, nullptr);
     destroyRenderingDevice(mRenderDevice);
     destroyInstance(mInstance);
-    glfwTerminate();
+
+    // headless replays never initialize glfw
+    if (!mHeadless)
+    {
+        glfwDestroyWindow(mWindow);
+        glfwTerminate();
+    }
 }
 
 void Application::run()
 {
+    if (!mReplayPath.empty())
+    {
+        runReplay();
+        return;
+    }
+
+    mInputRecordingStart = FramePacer::Clock::now();
+    mInputRecording = {
+        .extent = mRenderDevice.swapchainExtent,
+        .initialView = viewState(),
+        .events = {},
+        .durationMs = 0.0
+    };
+
     while (!glfwWindowShouldClose(mWindow))
     {
-        glfwPollEvents();
+        if (mRenderMode == RenderMode::OnDemand)
+        {
+            // sleep until an event or a redraw request arrives
+            if (!mRedrawRequested)
+            {
+                glfwWaitEvents();
+                mFramePacer.skipInterval();
+            }
+            else
+            {
+                glfwPollEvents();
+            }
+
+            if (!mRedrawRequested.exchange(false))
+                continue;
+        }
+        else
+        {
+            glfwPollEvents();
+        }
+
+        mFramePacer.beginFrame();
+        applyPendingInput();
+
+        auto frameStart = FramePacer::Clock::now();
         renderFrame();
+        trackStartupFrame(std::chrono::duration<double, std::milli>(FramePacer::Clock::now() - frameStart).count());
+
+        reportFrameStats();
+    }
+
+    waitForAllTickets(mRenderDevice);
+
+    if (!mRecordInputPath.empty())
+    {
+        mInputRecording.durationMs = std::chrono::duration<double, std::milli>(FramePacer::Clock::now() - mInputRecordingStart).count();
+        writeInputRecording(mInputRecording, mRecordInputPath);
     }
 
-     vkDeviceWaitIdle(mRenderDevice.device);
+    if (!mMemoryReportPath.empty())
+        writeMemoryReport(mRenderDevice, mMemoryReportPath);
 }
 
-void Application::initializeGLFW()
+void Application::runReplay()
 {
-    glfwInit();
+    ReplayReport report(mReplayPath, mReplayTimestepMs);
 
-    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    // the report frame last submitted on each frame in flight, its GPU time is read once the slot comes around again
+    std::array<std::optional<uint32_t>, FRAMES_IN_FLIGHT> submittedFrames {};
 
-    mWindow = glfwCreateWindow(INITIAL_WINDOW_WIDTH, INITIAL_WINDOW_HEIGHT, WINDOW_TITLE, nullptr, nullptr);
-    vulkanCheck(mWindow? VK_SUCCESS : static_cast<VkResult>(~VK_SUCCESS), "Failed to create window");
+    mRotationX = mReplayRecording.initialView.rotationX;
+    mRotationY = mReplayRecording.initialView.rotationY;
+    mScale = mReplayRecording.initialView.scale;
+    updateModelMatrix();
 
-    glfwSetWindowUserPointer(mWindow, this);
-    glfwSetKeyCallback(mWindow, keyCallback);
-    glfwSetMouseButtonCallback(mWindow, mouseButtonCallback);
-    glfwSetCursorPosCallback(mWindow, cursorPositionCallback);
-    glfwSetScrollCallback(mWindow, scrollCallback);
+    const std::vector<InputEventRecord>& events = mReplayRecording.events;
+    size_t nextEvent = 0;
+
+    auto frameCount = std::max(1u, static_cast<uint32_t>(std::ceil(mReplayRecording.durationMs / mReplayTimestepMs)));
+
+    for (uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        // only to keep the window responsive, its input is ignored
+        if (mWindow)
+        {
+            glfwPollEvents();
+            if (glfwWindowShouldClose(mWindow))
+                break;
+        }
+
+        // every frame takes the events of one timestep, however long the frames actually take
+        double stepEndMs = (frame + 1) * mReplayTimestepMs;
+        while (nextEvent < events.size() && events.at(nextEvent).timeMs <= stepEndMs)
+            applyInputEvent(events.at(nextEvent++));
+
+        applyPendingInput();
+
+        uint32_t frameIndex = mRenderDevice.frameIndex;
+        std::optional<uint32_t> previousFrame = submittedFrames.at(frameIndex);
+
+        auto frameStart = FramePacer::Clock::now();
+        renderFrame();
+        double frameMs = std::chrono::duration<double, std::milli>(FramePacer::Clock::now() - frameStart).count();
+        trackStartupFrame(frameMs);
+
+        if (previousFrame && mLastGpuTimeMs)
+            report.setGpuTime(*previousFrame, *mLastGpuTimeMs);
+
+        // the frame index only advances when the frame was submitted
+        uint32_t reportFrame = report.addFrame(frameMs);
+        submittedFrames.at(frameIndex) = mRenderDevice.frameIndex != frameIndex? std::optional(reportFrame) : std::nullopt;
+    }
+
+    waitForAllTickets(mRenderDevice);
+
+    for (uint32_t i = 0; i < FRAMES_IN_FLIGHT; ++i)
+    {
+        if (!submittedFrames.at(i))
+            continue;
+
+        if (std::optional<double> gpuTimeMs = readGpuTimer(mRenderDevice, mGpuTimer, i))
+            report.setGpuTime(*submittedFrames.at(i), *gpuTimeMs);
+    }
+
+    report.setFinalView(viewState());
+    report.print();
+
+    if (!mReplayReportPath.empty())
+        report.write(mReplayReportPath);
+
+    if (!mMemoryReportPath.empty())
+        writeMemoryReport(mRenderDevice, mMemoryReportPath);
 }
 
-void Application::createDepthImage()
+void Application::reportFrameStats()
 {
-    // todo: why multisampled
-    mDepthImage = createImage(mRenderDevice,
-                              VK_FORMAT_D32_SFLOAT,
-                              mRenderDevice.swapchainExtent.width,
-                              mRenderDevice.swapchainExtent.height,
-                              VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-                              VK_IMAGE_ASPECT_DEPTH_BIT,
-                              getMaxSampleCount(mRenderDevice));
+    static constexpr auto reportInterval = std::chrono::seconds(2);
+
+    if (!mPrintFrameStats)
+        return;
+
+    FramePacer::Clock::time_point now = FramePacer::Clock::now();
+    if (now - mLastFrameStatsReport < reportInterval)
+        return;
+
+    FrameStats stats = mFramePacer.stats();
+    mLastFrameStatsReport = now;
+
+    if (stats.frameCount == 0)
+        return;
+
+    std::cout << "Frame pacing (" << getPresentModeName(mRenderDevice.presentMode) << ", "
+              << mRenderDevice.swapchainImages.size() << " images): "
+              << 1000.0 / stats.meanMs << " fps, mean " << stats.meanMs << " ms, stddev "
+              << stats.stdDevMs << " ms, min " << stats.minMs << " ms, max " << stats.maxMs << " ms\n";
+
+    DeletionStats& worstFlush = mRenderDevice.deletionQueue.worstFlush;
+    if (mGpuTimeSamples > 0)
+        std::cout << "GPU frame time (" << getAntiAliasingName(mAntiAliasing) << "): " << mGpuTimeTotalMs / mGpuTimeSamples << " ms\n";
+
+    if (mFragmentInvocationSamples > 0)
+    {
+        double pixelCount = static_cast<double>(mRenderDevice.swapchainExtent.width) * mRenderDevice.swapchainExtent.height;
+        double invocations = static_cast<double>(mFragmentInvocationsTotal) / mFragmentInvocationSamples;
+
+        std::cout << "Fragment shader invocations (depth pre-pass " << (mDepthPrepass? "on" : "off") << "): "
+                  << invocations << " per frame, overdraw " << invocations / pixelCount << "x\n";
+    }
+
+    if (mRecordTimeSamples > 0)
+        std::cout << "Scene recording (" << mRecordThreadPool.threadCount() << " threads, " << mDrawList.size() << " draws): "
+                  << mRecordTimeTotalMs / mRecordTimeSamples << " ms, draw list sort "
+                  << mDrawSortTimeTotalMs / mRecordTimeSamples << " ms\n";
+
+    std::cout << "Deferred destruction: worst frame " << worstFlush.destroyedCount << " objects in "
+              << worstFlush.cpuTimeMs << " ms, " << mRenderDevice.deletionQueue.pending.size() << " pending\n";
+
+    reportMemoryUsage();
+
+    mFramePacer.resetStats();
+    worstFlush = {};
+    mGpuTimeTotalMs = 0.0;
+    mGpuTimeSamples = 0;
+    mFragmentInvocationsTotal = 0;
+    mFragmentInvocationSamples = 0;
+    mRecordTimeTotalMs = 0.0;
+    mDrawSortTimeTotalMs = 0.0;
+    mRecordTimeSamples = 0;
 }
 
-void Application::createSampledColorImage()
+void Application::reportMemoryUsage()
 {
-    VkImageUsageFlags usage {
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
-        VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT // todo: why
-    };
+    static constexpr double MB = 1024.0 * 1024.0;
+
+    MemoryStats stats = getMemoryStats(mRenderDevice);
+
+    for (size_t i = 0; i < stats.heaps.size(); ++i)
+    {
+        const MemoryHeapStats& heap = stats.heaps.at(i);
+
+        if (!heap.deviceLocal)
+            continue;
+
+        std::cout << "Device memory heap " << i << ": " << heap.usage / MB << " MB of "
+                  << heap.budget / MB << " MB budget" << (stats.budgetQueried? "" : " (heap size)")
+                  << ", " << heap.trackedBytes / MB << " MB tracked\n";
+    }
 
-    mSampledColorImage = createImage(mRenderDevice,
-                                     mRenderDevice.swapchainFormat,
-                                     mRenderDevice.swapchainExtent.width,
-                                     mRenderDevice.swapchainExtent.height,
-                                     usage,
-                                     VK_IMAGE_ASPECT_COLOR_BIT,
-                                     getMaxSampleCount(mRenderDevice));
+    std::cout << "Memory by category:";
+    for (uint32_t i = 0; i < MEMORY_CATEGORY_COUNT; ++i)
+    {
+        std::cout << (i > 0? "," : "") << ' ' << getMemoryCategoryName(static_cast<MemoryCategory>(i)) << ' '
+                  << stats.categoryBytes.at(i) / MB << " MB";
+    }
+    std::cout << '\n';
 }
 
-void Application::createRenderPass()
+void Application::loadScene(const std::vector<ModelPlacement>& placements)
 {
-    VkAttachmentDescription colorAttachment {
-        .format = mRenderDevice.swapchainFormat,
-        .samples = getMaxSampleCount(mRenderDevice),
-        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-        .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-    };
+    auto loadStart = FramePacer::Clock::now();
 
-    VkAttachmentDescription depthAttachment {
-        .format = VK_FORMAT_D32_SFLOAT,
-        .samples = getMaxSampleCount(mRenderDevice),
-        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-        .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
-    };
+    std::vector<ModelLoadStats> loadStats = createModel(mModel, mRenderDevice, mLoadJobSystem, mFileReader, placements);
 
-    // todo: why resolve
-    VkAttachmentDescription colorAttachmentResolve {
-        .format = mRenderDevice.swapchainFormat,
-        .samples = VK_SAMPLE_COUNT_1_BIT,
-        .loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE, // todo: why don't care?
-        .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED, // todo: how is it undefined?
-        .finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
-    };
+    for (const ModelLoadStats& stats : loadStats)
+    {
+        std::cout << "Loaded " << stats.filename << " in " << stats.loadTimeMs << " ms: "
+                  << stats.meshCount << " meshes (" << stats.uniqueMeshCount << " unique), "
+                  << stats.materialCount << " materials, " << stats.newTextureCount << " new textures\n";
 
-    std::array<VkAttachmentDescription, 3> attachmentsDescriptions {
-        colorAttachment,
-        depthAttachment,
-        colorAttachmentResolve
-    };
+        if (stats.reducedTextureCount > 0)
+            std::cout << "    " << stats.reducedTextureCount << " textures lost mip levels to stay within the memory budget\n";
 
-    VkAttachmentReference colorAttachmentRef {
-        .attachment = 0,
-        .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-    };
+        mStartupReport.addPhase(stats.filename, stats.loadTimeMs, stats.loadTimeMs, 0);
+        for (const LoadStageTime& stage : stats.stages)
+            mStartupReport.addPhase(stage.name, stage.wallMs, stage.cpuMs, stage.bytes, 1);
+    }
 
-    VkAttachmentReference depthAttachmentRef {
-        .attachment = 1,
-        .layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
-    };
+    double totalMs = std::chrono::duration<double, std::milli>(FramePacer::Clock::now() - loadStart).count();
 
-    VkAttachmentReference colorAttachmentResolveRef {
-        .attachment = 2,
-        .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-    };
+    std::cout << "Scene: " << loadStats.size() << " models, " << placements.size() << " placements, "
+              << mModel.meshes.size() << " meshes, " << mModel.instanceCount << " instances, "
+              << mModel.textures.size() << " textures, loaded in " << totalMs << " ms on "
+              << mLoadJobSystem.workerCount() + 1 << " threads, files read through "
+              << (mFileReader.usesIoUring()? "io_uring" : "mappings") << "\n";
+}
 
-    VkSubpassDescription subpass {
-        .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
-        .inputAttachmentCount = 0,
-        .pInputAttachments = nullptr,
-        .colorAttachmentCount = 1,
-        .pColorAttachments = &colorAttachmentRef,
-        .pResolveAttachments = &colorAttachmentResolveRef,
-        .pDepthStencilAttachment = &depthAttachmentRef
-    };
+void Application::requestRedraw()
+{
+    mRedrawRequested = true;
 
-    VkRenderPassCreateInfo renderPassCreateInfo {
-        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
-        .attachmentCount = static_cast<uint32_t>(attachmentsDescriptions.size()),
-        .pAttachments = attachmentsDescriptions.data(),
-        .subpassCount = 1,
-        .pSubpasses = &subpass
-    };
+    if (mWindow)
+        glfwPostEmptyEvent();
+}
+
+void Application::initializeGLFW()
+{
+    glfwInit();
+
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+
+    // a replay renders at the recording's size
+    int width = mReplayPath.empty()? INITIAL_WINDOW_WIDTH : static_cast<int>(mReplayRecording.extent.width);
+    int height = mReplayPath.empty()? INITIAL_WINDOW_HEIGHT : static_cast<int>(mReplayRecording.extent.height);
 
-    VkResult result = vkCreateRenderPass(mRenderDevice.device, &renderPassCreateInfo, nullptr, &mRenderPass);
-    vulkanCheck(result, "Failed to create renderpass.");
+    mWindow = glfwCreateWindow(width, height, WINDOW_TITLE, nullptr, nullptr);
+    vulkanCheck(mWindow? VK_SUCCESS : static_cast<VkResult>(~VK_SUCCESS), "Failed to create window");
+
+    glfwSetWindowUserPointer(mWindow, this);
+    glfwSetKeyCallback(mWindow, keyCallback);
+    glfwSetMouseButtonCallback(mWindow, mouseButtonCallback);
+    glfwSetCursorPosCallback(mWindow, cursorPositionCallback);
+    glfwSetScrollCallback(mWindow, scrollCallback);
+    glfwSetFramebufferSizeCallback(mWindow, framebufferSizeCallback);
+    glfwSetWindowRefreshCallback(mWindow, windowRefreshCallback);
 }
 
-void Application::createFramebuffers()
+void Application::buildRenderGraph()
 {
-    size_t imageCount = mRenderDevice.swapchainImages.size();
-    mFramebuffers.resize(imageCount);
+    static constexpr VkClearColorValue clearColor {0.2f, 0.2f, 0.2f, 1.f};
+    static constexpr VkClearDepthStencilValue clearDepth {1.f, 0};
+
+    VkExtent2D extent = mRenderDevice.swapchainExtent;
+    VkFormat colorFormat = mRenderDevice.swapchainFormat;
 
-    for (size_t i = 0; i < imageCount; ++i)
+    mRenderGraph = RenderGraph();
+    // headless images aren't presented, they stay attachments
+    VkImageLayout finalLayout = mRenderDevice.headless? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    mSwapchainResource = mRenderGraph.importImage({"swapchain", colorFormat, extent}, finalLayout);
+
+    // with FXAA the scene goes into an intermediate image that the post pass samples
+    RenderResource output = mSwapchainResource;
+    if (mAntiAliasing == AntiAliasing::FXAA)
+        output = mSceneColorResource = mRenderGraph.createImage({"scene color", colorFormat, extent});
+
+    RenderResource depth = mRenderGraph.createImage({"depth", DEPTH_FORMAT, extent, mSampleCount});
+
+    uint32_t scenePass = mRenderGraph.addPass("scene", [this] (VkCommandBuffer commandBuffer) {
+        recordScenePass(commandBuffer);
+    }, PassContents::SecondaryCommandBuffers);
+
+    // the query has to be active around the rendering scope to count the secondaries' draws
+    mRenderGraph.setPassScope(scenePass, [this] (VkCommandBuffer commandBuffer) {
+        beginPipelineStatistics(mPipelineStatistics, commandBuffer, mRenderDevice.frameIndex);
+    }, [this] (VkCommandBuffer commandBuffer) {
+        endPipelineStatistics(mPipelineStatistics, commandBuffer, mRenderDevice.frameIndex);
+    });
+
+    if (mSampleCount != VK_SAMPLE_COUNT_1_BIT)
     {
-        std::array<VkImageView, 3> attachments {
-            mSampledColorImage.imageView,
-            mDepthImage.imageView,
-            mRenderDevice.swapchainImageViews.at(i)
-        };
+        RenderResource multisampledColor = mRenderGraph.createImage({"multisampled color", colorFormat, extent, mSampleCount});
+        mRenderGraph.writeColor(scenePass, multisampledColor, clearColor, output);
+    }
+    else
+    {
+        mRenderGraph.writeColor(scenePass, output, clearColor);
+    }
 
-        VkFramebufferCreateInfo framebufferCreateInfo {
-            .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
-            .renderPass = mRenderPass,
-            .attachmentCount = static_cast<uint32_t>(attachments.size()),
-            .pAttachments = attachments.data(),
-            .width = mRenderDevice.swapchainExtent.width,
-            .height = mRenderDevice.swapchainExtent.height,
-            .layers = 1
-        };
+    mRenderGraph.writeDepth(scenePass, depth, clearDepth);
+
+    if (mAntiAliasing == AntiAliasing::FXAA)
+    {
+        uint32_t postPass = mRenderGraph.addPass("fxaa", [this] (VkCommandBuffer commandBuffer) {
+            recordPostPass(commandBuffer);
+        });
 
-        VkResult result = vkCreateFramebuffer(mRenderDevice.device, &framebufferCreateInfo, nullptr, &mFramebuffers.at(i));
-        vulkanCheck(result, "Failed to create framebuffer.");
+        mRenderGraph.readSampled(postPass, mSceneColorResource);
+        mRenderGraph.writeColor(postPass, mSwapchainResource);
     }
+
+    mRenderGraph.compile(mRenderDevice);
+    ++mAttachmentVersion;
+
+    if (mPrintFrameStats)
+        reportAttachmentMemory();
 }
 
-void Application::createViewProjUBO()
+void Application::reportAttachmentMemory()
 {
-    VkBufferUsageFlags usage {
-        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT
-    };
+    static constexpr double MB = 1024.0 * 1024.0;
+
+    const RenderGraphStats& stats = mRenderGraph.stats();
 
-    VkMemoryPropertyFlags memoryProperties  = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    std::cout << "Render graph (" << getAntiAliasingName(mAntiAliasing) << ", "
+              << mSampleCount << " samples, "
+              << mRenderDevice.swapchainExtent.width << 'x' << mRenderDevice.swapchainExtent.height << "): "
+              << stats.passCount - stats.culledPassCount << " of " << stats.passCount << " passes, "
+              << stats.imageBarrierCount << " image barriers in " << stats.barrierBatchCount << " batches\n";
 
-    mModelViewProjUBO = createBuffer(mRenderDevice,
-                                     sizeof(glm::mat4),
-                                     usage,
-                                     memoryProperties);
+    std::cout << "Attachments: " << stats.imageBytes / MB << " MB in "
+              << stats.allocatedBytes / MB << " MB after aliasing, committed "
+              << stats.committedBytes / MB << " MB\n";
+
+    std::cout << "Attachment stores per frame: " << stats.storedBytesPerFrame / MB << " MB of "
+              << stats.writtenBytesPerFrame / MB << " MB written\n";
 }
 
-void Application::updateViewProjUBO()
+void Application::updateModelMatrix()
 {
     static constexpr glm::mat4 identity(1.f);
 
     mModelMatrix = glm::rotate(identity, glm::radians(mRotationY), {1.f, 0.f, 0.f});
     mModelMatrix = glm::rotate(mModelMatrix, glm::radians(mRotationX), {0.f, 1.f, 0.f});
     mModelMatrix = glm::scale(mModelMatrix, glm::vec3(mScale));
+}
+
+// window input, recorded when there's a recording path and ignored while replaying
+void Application::handleInput(InputEventType type, double x, double y)
+{
+    if (!mReplayPath.empty())
+        return;
+
+    double timeMs = std::chrono::duration<double, std::milli>(FramePacer::Clock::now() - mInputRecordingStart).count();
+    InputEventRecord event {timeMs, type, x, y};
 
-    glm::mat4 mvp = mCamera.viewProjection() * mModelMatrix;
+    if (!mRecordInputPath.empty())
+        mInputRecording.events.push_back(event);
 
-    VkCommandBuffer commandBuffer = beginSingleCommand(mRenderDevice);
-    vkCmdUpdateBuffer(commandBuffer, mModelViewProjUBO.buffer, 0, sizeof(glm::mat4), &mvp);
-    endSingleCommand(mRenderDevice, commandBuffer);
+    applyInputEvent(event);
 }
 
-void Application::createDescriptorPool()
+void Application::applyInputEvent(const InputEventRecord& event)
+{
+    switch (event.type)
+    {
+        case InputEventType::MouseButton:
+        {
+            mLeftMouseButtonPressed = event.x != 0.0;
+            break;
+        }
+        case InputEventType::CursorPosition:
+        {
+            if (mLeftMouseButtonPressed)
+            {
+                double dx = event.x - mCursorPosX;
+                double dy = event.y - mCursorPosY;
+
+                mPendingRotationX += dx * mOrbitNavSensitivity;
+                mPendingRotationY += dy * mOrbitNavSensitivity;
+
+                requestRedraw();
+            }
+
+            mCursorPosX = event.x;
+            mCursorPosY = event.y;
+            break;
+        }
+        case InputEventType::Scroll:
+        {
+            mPendingScroll += event.y;
+
+            requestRedraw();
+            break;
+        }
+    }
+}
+
+void Application::applyPendingInput()
 {
-    VkPhysicalDeviceProperties physicalDeviceProperties;
-    vkGetPhysicalDeviceProperties(mRenderDevice.physicalDevice, &physicalDeviceProperties);
+    if (mPendingRotationX == 0.f && mPendingRotationY == 0.f && mPendingScroll == 0.f)
+        return;
+
+    mRotationX += mPendingRotationX;
+    mRotationY = glm::clamp(mRotationY + mPendingRotationY, -90.f, 90.f);
 
-    uint32_t maxPerStageDescriptorSamplers = physicalDeviceProperties.limits.maxPerStageDescriptorSamplers;
+    mScale += mPendingScroll * mScale / 10.f;
+    mScale = glm::clamp(mScale, 0.1f, 10.f);
 
+    mPendingRotationX = 0.f;
+    mPendingRotationY = 0.f;
+    mPendingScroll = 0.f;
+
+    updateModelMatrix();
+}
+
+ViewState Application::viewState() const
+{
+    return {mRotationX, mRotationY, mScale};
+}
+
+void Application::createDescriptorPool()
+{
+    // the texture table only takes as many descriptors as there are loaded textures
     std::vector<VkDescriptorPoolSize> descriptorPoolSizes {
-        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1},
         {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1},
-        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxPerStageDescriptorSamplers}
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, static_cast<uint32_t>(mModel.textures.size()) + FRAMES_IN_FLIGHT}
     };
 
+    // set 0, set 1 and a post processing set per frame in flight
     VkDescriptorPoolCreateInfo descriptorPoolCreateInfo {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-        .maxSets = 2,
+        .maxSets = 2 + FRAMES_IN_FLIGHT,
         .poolSizeCount = static_cast<uint32_t>(descriptorPoolSizes.size()),
         .pPoolSizes = descriptorPoolSizes.data()
     };
@@ -270,7 +678,7 @@ void Application::createDescriptorSetLayouts()
 {
     VkDescriptorSetLayoutBinding layout0Binding1 {
         .binding = 0,
-        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
         .descriptorCount = 1,
         .stageFlags = VK_SHADER_STAGE_VERTEX_BIT
     };
@@ -291,20 +699,36 @@ void Application::createDescriptorSetLayouts()
         .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT
     };
 
+    // texture table shared by every loaded model, sized when the set is allocated
     VkDescriptorSetLayoutBinding layout1Binding1 {
         .binding = 1,
         .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-        .descriptorCount = static_cast<uint32_t>(mModel.textures.size()),
+        .descriptorCount = getTextureTableSize(mRenderDevice),
         .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT
     };
 
+    if (mModel.textures.size() > layout1Binding1.descriptorCount)
+        throw std::runtime_error("The scene uses more textures than the texture table holds.");
+
     std::array<VkDescriptorSetLayoutBinding, 2> layout1Bindings {
         layout1Binding0,
         layout1Binding1
     };
 
+    std::array<VkDescriptorBindingFlags, 2> layout1BindingFlags {
+        0,
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT
+    };
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo layout1BindingFlagsCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+        .bindingCount = static_cast<uint32_t>(layout1BindingFlags.size()),
+        .pBindingFlags = layout1BindingFlags.data()
+    };
+
     VkDescriptorSetLayoutCreateInfo layout1CreateInfo {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = &layout1BindingFlagsCreateInfo,
         .bindingCount = static_cast<uint32_t>(layout1Bindings.size()),
         .pBindings = layout1Bindings.data()
     };
@@ -320,8 +744,21 @@ void Application::createDescriptorSets()
         mLayout1
     };
 
+    // only set 1 has a variable sized binding, the count is ignored for set 0
+    std::array<uint32_t, 2> variableDescriptorCounts {
+        0,
+        static_cast<uint32_t>(mModel.textures.size())
+    };
+
+    VkDescriptorSetVariableDescriptorCountAllocateInfo variableDescriptorCountAllocateInfo {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO,
+        .descriptorSetCount = static_cast<uint32_t>(variableDescriptorCounts.size()),
+        .pDescriptorCounts = variableDescriptorCounts.data()
+    };
+
     VkDescriptorSetAllocateInfo descriptorSetAllocateInfo {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .pNext = &variableDescriptorCountAllocateInfo,
         .descriptorPool = mDescriptorPool,
         .descriptorSetCount = static_cast<uint32_t>(layouts.size()),
         .pSetLayouts = layouts.data()
@@ -333,12 +770,13 @@ void Application::createDescriptorSets()
     vulkanCheck(result, "Failed to allocate descriptor sets.");
 
     // update set 0
-    std::array<VkWriteDescriptorSet, 3> descriptorWrites;
+    std::vector<VkWriteDescriptorSet> descriptorWrites(3);
 
+    // the offset into the ring buffer is supplied when binding
     VkDescriptorBufferInfo mvpBufferInfo {
-        .buffer = mModelViewProjUBO.buffer,
+        .buffer = mUniformRingBuffer.buffer.buffer,
         .offset = 0,
-        .range = VK_WHOLE_SIZE
+        .range = sizeof(SceneUniforms)
     };
 
     descriptorWrites.at(0) = {
@@ -347,7 +785,7 @@ void Application::createDescriptorSets()
         .dstBinding = 0,
         .dstArrayElement = 0,
         .descriptorCount = 1,
-        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
         .pBufferInfo = &mvpBufferInfo
     };
 
@@ -389,6 +827,9 @@ void Application::createDescriptorSets()
         .pImageInfo = texturesInfo.data()
     };
 
+    if (textureCount == 0)
+        descriptorWrites.pop_back();
+
     vkUpdateDescriptorSets(mRenderDevice.device, descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
 }
 
@@ -438,92 +879,386 @@ void Application::createGraphicsPipeline()
 {
     createPipelineLayout();
 
-    VkShaderModule vertexShader = createShaderModule(mRenderDevice, "shaders/model_vert.spv");
-    VkShaderModule fragmentShader = createShaderModule(mRenderDevice, "shaders/model_frag.spv");
+    mShadedVertexShader = createShaderModule(mRenderDevice, "shaders/model_vert.spv");
+    mShadedFragmentShader = createShaderModule(mRenderDevice, "shaders/model_frag.spv");
 
-    VkPipelineShaderStageCreateInfo vertexShaderStageCreateInfo {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-        .stage = VK_SHADER_STAGE_VERTEX_BIT,
-        .module = vertexShader,
-        .pName = "main"
-    };
+    // only the feature combinations the loaded materials use
+    std::vector<uint32_t> permutations;
+    for (const Material& material : mModel.materials)
+        permutations.push_back(getMaterialFeatures(material));
 
-    VkPipelineShaderStageCreateInfo fragmentShaderStageCreateInfo {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-        .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-        .module = fragmentShader,
-        .pName = "main"
-    };
+    std::sort(permutations.begin(), permutations.end());
+    permutations.erase(std::unique(permutations.begin(), permutations.end()), permutations.end());
 
-    std::vector<VkPipelineShaderStageCreateInfo> shaderStages {
-        vertexShaderStageCreateInfo,
-        fragmentShaderStageCreateInfo
-    };
+    // the first frame only waits for pipelines that are quick to create, the
+    // optimized ones compile in the background and are swapped in once ready
+    auto createStart = FramePacer::Clock::now();
 
-    auto bindingDescription = Vertex::bindingDescription();
-    auto attributeDescription = Vertex::attributeDescription();
-    VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-        .vertexBindingDescriptionCount = 1,
-        .pVertexBindingDescriptions = &bindingDescription,
-        .vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescription.size()),
-        .pVertexAttributeDescriptions = attributeDescription.data()
-    };
+    if (mRenderDevice.graphicsPipelineLibrary)
+        createFastLinkedPipelines(permutations);
+    else
+        createUbershaderPipeline(permutations);
 
-    VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
-    };
+    double createMs = std::chrono::duration<double, std::milli>(FramePacer::Clock::now() - createStart).count();
+    std::cout << "Created " << permutations.size() << " material pipeline permutations in " << createMs << " ms using "
+              << (mRenderDevice.graphicsPipelineLibrary? "fast-linked pipeline libraries" : "the ubershader")
+              << ", optimizing them in the background\n";
 
-    VkPipelineTessellationStateCreateInfo tessellationStateCreateInfo {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO
-    };
+    scheduleOptimizedPipelines(permutations);
+}
 
-    VkPipelineViewportStateCreateInfo viewportStateCreateInfo {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
-        .viewportCount = 1,
-        .scissorCount = 1
-    };
+void Application::createFastLinkedPipelines(const std::vector<uint32_t>& permutations)
+{
+    // the vertex input, vertex shader and output state are the same for every material,
+    // only the fragment shader part is compiled per feature combination
+    static constexpr VkGraphicsPipelineLibraryFlagsEXT sharedParts =
+        VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT |
+        VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT |
+        VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+
+    VkResult sharedResult;
+    std::vector<VkResult> results(permutations.size());
+
+    JobSystem::JobHandle sharedLibrary = mLoadJobSystem.schedule([&] {
+        sharedResult = createShadedPipeline(0, false, sharedParts, mSharedPipelineLibrary);
+    });
+
+    JobSystem::JobHandle fragmentLibraries = mLoadJobSystem.parallelFor(permutations.size(), 1, [&] (uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            results.at(i) = createShadedPipeline(permutations.at(i),
+                                                 false,
+                                                 VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+                                                 mFragmentPipelineLibraries.at(permutations.at(i)));
+        }
+    });
 
-    VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
-        .depthClampEnable = VK_FALSE,
-        .polygonMode = VK_POLYGON_MODE_FILL,
-        .cullMode = VK_CULL_MODE_NONE,
-        .depthBiasEnable = VK_FALSE,
-        .lineWidth = 1.f
-    };
+    // the compiles write into this frame, a failure is rethrown once all of them finished
+    mLoadJobSystem.wait(mLoadJobSystem.schedule([] {}, {sharedLibrary, fragmentLibraries}));
 
-    VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-        .rasterizationSamples = getMaxSampleCount(mRenderDevice),
-        .sampleShadingEnable = VK_TRUE,
-        .minSampleShading = 0.2f
-    };
+    vulkanCheck(sharedResult, "Failed to create the shared pipeline library.");
+    for (VkResult result : results)
+        vulkanCheck(result, "Failed to create a fragment shader pipeline library.");
 
-    VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
-        .depthTestEnable = VK_TRUE,
-        .depthWriteEnable = VK_TRUE,
-        .depthCompareOp = VK_COMPARE_OP_LESS,
-        .depthBoundsTestEnable = VK_FALSE,
-        .stencilTestEnable = VK_FALSE
-    };
+    // linking without link time optimization only combines the compiled parts
+    for (uint32_t materialFeatures : permutations)
+    {
+        VkResult result = linkShadedPipeline(materialFeatures, false, mShadedPipelines.at(materialFeatures));
+        vulkanCheck(result, "Failed to link graphics pipeline.");
+    }
+}
 
-    VkPipelineColorBlendAttachmentState colorBlendAttachmentState {
-        .blendEnable = VK_FALSE,
-        .colorWriteMask {
-            VK_COLOR_COMPONENT_R_BIT |
-            VK_COLOR_COMPONENT_G_BIT |
-            VK_COLOR_COMPONENT_B_BIT |
-            VK_COLOR_COMPONENT_A_BIT
-        }
-    };
+void Application::createUbershaderPipeline(const std::vector<uint32_t>& permutations)
+{
+    VkResult result = createShadedPipeline(0, true, 0, mUbershaderPipeline);
+    vulkanCheck(result, "Failed to create the ubershader pipeline.");
 
-    VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
-        .logicOpEnable = VK_FALSE,
-        .logicOp = VK_LOGIC_OP_CLEAR,
+    for (uint32_t materialFeatures : permutations)
+        mShadedPipelines.at(materialFeatures) = mUbershaderPipeline;
+}
+
+void Application::scheduleOptimizedPipelines(const std::vector<uint32_t>& permutations)
+{
+    // the pipeline cache is internally synchronized, the permutations compile side by side
+    for (uint32_t materialFeatures : permutations)
+    {
+        PipelineCompile& compile = mPipelineCompiles.at(materialFeatures);
+
+        compile.job = mLoadJobSystem.schedule([this, materialFeatures, &compile] {
+            auto compileStart = FramePacer::Clock::now();
+
+            if (mRenderDevice.graphicsPipelineLibrary)
+                compile.result = linkShadedPipeline(materialFeatures, true, compile.pipeline);
+            else
+                compile.result = createShadedPipeline(materialFeatures, false, 0, compile.pipeline);
+
+            compile.compileMs = std::chrono::duration<double, std::milli>(FramePacer::Clock::now() - compileStart).count();
+        });
+    }
+
+    mPendingPipelineCompiles = permutations.size();
+}
+
+void Application::swapInOptimizedPipelines()
+{
+    if (mPendingPipelineCompiles == 0)
+        return;
+
+    // without workers nobody else runs the compiles, each frame takes one on
+    if (mLoadJobSystem.workerCount() == 0)
+    {
+        auto compileStart = FramePacer::Clock::now();
+
+        if (mLoadJobSystem.runPendingJob())
+            mRenderThreadCompileMs += std::chrono::duration<double, std::milli>(FramePacer::Clock::now() - compileStart).count();
+    }
+
+    for (uint32_t materialFeatures = 0; materialFeatures < MATERIAL_PERMUTATION_COUNT; ++materialFeatures)
+    {
+        PipelineCompile& compile = mPipelineCompiles.at(materialFeatures);
+
+        if (!compile.job || !compile.job->finished)
+            continue;
+
+        // returns right away, rethrows what the compile threw
+        mLoadJobSystem.wait(compile.job);
+        vulkanCheck(compile.result, "Failed to create graphics pipeline.");
+
+        // submitted frames may still draw with the fast-linked pipeline
+        VkPipeline fallback = mShadedPipelines.at(materialFeatures);
+        if (fallback != mUbershaderPipeline)
+        {
+            deferDestruction(mRenderDevice, mRenderDevice.lastSubmittedTicket, [this, fallback] () {
+                vkDestroyPipeline(mRenderDevice.device, fallback, nullptr);
+            });
+        }
+
+        mShadedPipelines.at(materialFeatures) = compile.pipeline;
+        mOptimizedPipelineCompileMs += compile.compileMs;
+        compile = {};
+        --mPendingPipelineCompiles;
+    }
+
+    if (mPendingPipelineCompiles == 0)
+        releasePipelineFallbacks();
+}
+
+void Application::releasePipelineFallbacks()
+{
+    VkPipeline ubershader = mUbershaderPipeline;
+    std::vector<VkPipeline> libraries(mFragmentPipelineLibraries.begin(), mFragmentPipelineLibraries.end());
+    libraries.push_back(mSharedPipelineLibrary);
+
+    deferDestruction(mRenderDevice, mRenderDevice.lastSubmittedTicket, [this, ubershader, libraries] () {
+        vkDestroyPipeline(mRenderDevice.device, ubershader, nullptr);
+        for (VkPipeline library : libraries)
+            vkDestroyPipeline(mRenderDevice.device, library, nullptr);
+    });
+
+    mUbershaderPipeline = VK_NULL_HANDLE;
+    mSharedPipelineLibrary = VK_NULL_HANDLE;
+    mFragmentPipelineLibraries = {};
+
+    vkDestroyShaderModule(mRenderDevice.device, mShadedVertexShader, nullptr);
+    vkDestroyShaderModule(mRenderDevice.device, mShadedFragmentShader, nullptr);
+    mShadedVertexShader = VK_NULL_HANDLE;
+    mShadedFragmentShader = VK_NULL_HANDLE;
+
+    std::cout << "Optimized material pipelines in use " << mStartupReport.elapsedMs() << " ms after startup ("
+              << mOptimizedPipelineCompileMs << " ms compiling): " << mFallbackFrameCount
+              << " frames drawn with fallback pipelines, slowest " << mWorstFallbackFrameMs << " ms, "
+              << mRenderThreadCompileMs << " ms compiling on the render thread\n";
+}
+
+void Application::trackStartupFrame(double frameMs)
+{
+    if (!mFirstFramePresented)
+    {
+        uint32_t compilingCount = std::count_if(mPipelineCompiles.begin(), mPipelineCompiles.end(), [] (const PipelineCompile& compile) {
+            return compile.job != nullptr;
+        });
+
+        // the startup ends with the first frame
+        mStartupReport.addPhase("first frame", frameMs, frameMs, 0);
+        mStartupReport.print();
+
+        if (!mStartupReportPath.empty())
+            mStartupReport.writeJson(mStartupReportPath);
+
+        std::cout << "First frame after " << mStartupReport.elapsedMs() << " ms, " << compilingCount
+                  << " material pipelines still compiling\n";
+
+        mFirstFramePresented = true;
+    }
+
+    // a frame recorded while compiles were pending drew with at least one fallback
+    if (mPendingPipelineCompiles > 0)
+    {
+        ++mFallbackFrameCount;
+        mWorstFallbackFrameMs = std::max(mWorstFallbackFrameMs, frameMs);
+    }
+}
+
+void Application::destroyShadedPipelines()
+{
+    // background compiles still use the shader modules and libraries
+    for (PipelineCompile& compile : mPipelineCompiles)
+    {
+        if (!compile.job)
+            continue;
+
+        // runs during teardown, a compile that threw left no pipeline behind
+        try
+        {
+            mLoadJobSystem.wait(compile.job);
+        }
+        catch (...)
+        {
+        }
+
+        vkDestroyPipeline(mRenderDevice.device, compile.pipeline, nullptr);
+    }
+
+    for (VkPipeline pipeline : mShadedPipelines)
+        if (pipeline != mUbershaderPipeline)
+            vkDestroyPipeline(mRenderDevice.device, pipeline, nullptr);
+
+    for (VkPipeline library : mFragmentPipelineLibraries)
+        vkDestroyPipeline(mRenderDevice.device, library, nullptr);
+
+    vkDestroyPipeline(mRenderDevice.device, mUbershaderPipeline, nullptr);
+    vkDestroyPipeline(mRenderDevice.device, mSharedPipelineLibrary, nullptr);
+    vkDestroyShaderModule(mRenderDevice.device, mShadedVertexShader, nullptr);
+    vkDestroyShaderModule(mRenderDevice.device, mShadedFragmentShader, nullptr);
+}
+
+VkResult Application::linkShadedPipeline(uint32_t materialFeatures, bool optimize, VkPipeline& pipeline)
+{
+    std::array<VkPipeline, 2> libraries {
+        mSharedPipelineLibrary,
+        mFragmentPipelineLibraries.at(materialFeatures)
+    };
+
+    VkPipelineLibraryCreateInfoKHR libraryCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+        .libraryCount = static_cast<uint32_t>(libraries.size()),
+        .pLibraries = libraries.data()
+    };
+
+    // link time optimization compiles the parts into one pipeline as fast as a monolithic one
+    VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &libraryCreateInfo,
+        .flags = optimize? static_cast<VkPipelineCreateFlags>(VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT) : 0u,
+        .layout = mPipelineLayout
+    };
+
+    return vkCreateGraphicsPipelines(mRenderDevice.device,
+                                     mPipelineCache,
+                                     1, &graphicsPipelineCreateInfo,
+                                     nullptr,
+                                     &pipeline);
+}
+
+VkResult Application::createShadedPipeline(uint32_t materialFeatures,
+                                           bool genericMaterial,
+                                           VkGraphicsPipelineLibraryFlagsEXT libraryParts,
+                                           VkPipeline& pipeline)
+{
+    // constant ids 0 to 2 match the feature bits, 3 selects the ubershader
+    std::array<VkBool32, 4> featureConstants {
+        static_cast<VkBool32>((materialFeatures & MATERIAL_FEATURE_DIFFUSE_MAP) != 0),
+        static_cast<VkBool32>((materialFeatures & MATERIAL_FEATURE_SPECULAR_MAP) != 0),
+        static_cast<VkBool32>((materialFeatures & MATERIAL_FEATURE_NORMAL_MAP) != 0),
+        static_cast<VkBool32>(genericMaterial)
+    };
+
+    std::array<VkSpecializationMapEntry, 4> specializationMapEntries;
+    for (uint32_t i = 0; i < specializationMapEntries.size(); ++i)
+        specializationMapEntries.at(i) = {i, static_cast<uint32_t>(i * sizeof(VkBool32)), sizeof(VkBool32)};
+
+    VkSpecializationInfo specializationInfo {
+        .mapEntryCount = static_cast<uint32_t>(specializationMapEntries.size()),
+        .pMapEntries = specializationMapEntries.data(),
+        .dataSize = sizeof(featureConstants),
+        .pData = featureConstants.data()
+    };
+
+    VkPipelineShaderStageCreateInfo vertexShaderStageCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+        .stage = VK_SHADER_STAGE_VERTEX_BIT,
+        .module = mShadedVertexShader,
+        .pName = "main"
+    };
+
+    VkPipelineShaderStageCreateInfo fragmentShaderStageCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+        .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+        .module = mShadedFragmentShader,
+        .pName = "main",
+        .pSpecializationInfo = &specializationInfo
+    };
+
+    // a pipeline library only gets the stages of the parts it contains, the state of the
+    // other parts is ignored. No library parts means a complete pipeline.
+    std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
+
+    if (libraryParts == 0 || (libraryParts & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT))
+        shaderStages.push_back(vertexShaderStageCreateInfo);
+    if (libraryParts == 0 || (libraryParts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT))
+        shaderStages.push_back(fragmentShaderStageCreateInfo);
+
+    std::array<VkVertexInputBindingDescription, 2> bindingDescriptions {
+        getVertexBindingDescription(),
+        getInstanceBindingDescription()
+    };
+
+    auto attributeDescription = getVertexAttributeDescriptions();
+    auto instanceAttributeDescription = getInstanceAttributeDescriptions();
+    attributeDescription.insert(attributeDescription.end(), instanceAttributeDescription.begin(), instanceAttributeDescription.end());
+
+    VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        .vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size()),
+        .pVertexBindingDescriptions = bindingDescriptions.data(),
+        .vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescription.size()),
+        .pVertexAttributeDescriptions = attributeDescription.data()
+    };
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
+    };
+
+    VkPipelineTessellationStateCreateInfo tessellationStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO
+    };
+
+    VkPipelineViewportStateCreateInfo viewportStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+        .viewportCount = 1,
+        .scissorCount = 1
+    };
+
+    VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .depthClampEnable = VK_FALSE,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .cullMode = VK_CULL_MODE_NONE,
+        .depthBiasEnable = VK_FALSE,
+        .lineWidth = 1.f
+    };
+
+    VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+        .rasterizationSamples = mSampleCount,
+        .sampleShadingEnable = VK_FALSE
+    };
+
+    // with the pre-pass the depth buffer already holds the nearest surfaces
+    VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .depthTestEnable = VK_TRUE,
+        .depthWriteEnable = mDepthPrepass? VK_FALSE : VK_TRUE,
+        .depthCompareOp = mDepthPrepass? VK_COMPARE_OP_EQUAL : VK_COMPARE_OP_LESS,
+        .depthBoundsTestEnable = VK_FALSE,
+        .stencilTestEnable = VK_FALSE
+    };
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachmentState {
+        .blendEnable = VK_FALSE,
+        .colorWriteMask {
+            VK_COLOR_COMPONENT_R_BIT |
+            VK_COLOR_COMPONENT_G_BIT |
+            VK_COLOR_COMPONENT_B_BIT |
+            VK_COLOR_COMPONENT_A_BIT
+        }
+    };
+
+    VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+        .logicOpEnable = VK_FALSE,
+        .logicOp = VK_LOGIC_OP_CLEAR,
         .attachmentCount = 1,
         .pAttachments = &colorBlendAttachmentState
     };
@@ -539,8 +1274,25 @@ void Application::createGraphicsPipeline()
         .pDynamicStates = dynamicStates.data()
     };
 
+    VkPipelineRenderingCreateInfo renderingCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+        .colorAttachmentCount = 1,
+        .pColorAttachmentFormats = &mRenderDevice.swapchainFormat,
+        .depthAttachmentFormat = DEPTH_FORMAT
+    };
+
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+        .pNext = &renderingCreateInfo,
+        .flags = libraryParts
+    };
+
+    // libraries keep what link time optimization needs to compile the linked pipeline anew
     VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo {
         .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = libraryParts? static_cast<const void*>(&libraryCreateInfo) : &renderingCreateInfo,
+        .flags = libraryParts? static_cast<VkPipelineCreateFlags>(VK_PIPELINE_CREATE_LIBRARY_BIT_KHR |
+                                                                  VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT) : 0u,
         .stageCount = static_cast<uint32_t>(shaderStages.size()),
         .pStages = shaderStages.data(),
         .pVertexInputState = &vertexInputStateCreateInfo,
@@ -552,54 +1304,376 @@ void Application::createGraphicsPipeline()
         .pDepthStencilState = &depthStencilStateCreateInfo,
         .pColorBlendState = &colorBlendStateCreateInfo,
         .pDynamicState = &dynamicStateCreateInfo,
-        .layout = mPipelineLayout,
-        .renderPass = mRenderPass,
-        .subpass = 0
+        .layout = mPipelineLayout
+    };
+
+    return vkCreateGraphicsPipelines(mRenderDevice.device,
+                                     mPipelineCache,
+                                     1, &graphicsPipelineCreateInfo,
+                                     nullptr,
+                                     &pipeline);
+}
+
+void Application::createDepthPrepassPipeline()
+{
+    if (!mDepthPrepass)
+        return;
+
+    VkShaderModule vertexShader = createShaderModule(mRenderDevice, "shaders/depth_vert.spv");
+
+    // no fragment shader, only depth is written
+    VkPipelineShaderStageCreateInfo vertexShaderStageCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+        .stage = VK_SHADER_STAGE_VERTEX_BIT,
+        .module = vertexShader,
+        .pName = "main"
+    };
+
+    // same vertex buffers as the main pass, only the position and instance transform are fetched
+    std::array<VkVertexInputBindingDescription, 2> bindingDescriptions {
+        getVertexBindingDescription(),
+        getInstanceBindingDescription()
+    };
+
+    std::vector<VkVertexInputAttributeDescription> attributeDescription = getInstanceAttributeDescriptions();
+    attributeDescription.push_back(getVertexAttributeDescriptions().front());
+
+    VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        .vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size()),
+        .pVertexBindingDescriptions = bindingDescriptions.data(),
+        .vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescription.size()),
+        .pVertexAttributeDescriptions = attributeDescription.data()
+    };
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
+    };
+
+    VkPipelineViewportStateCreateInfo viewportStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+        .viewportCount = 1,
+        .scissorCount = 1
+    };
+
+    VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .depthClampEnable = VK_FALSE,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .cullMode = VK_CULL_MODE_NONE,
+        .depthBiasEnable = VK_FALSE,
+        .lineWidth = 1.f
+    };
+
+    VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+        .rasterizationSamples = mSampleCount,
+        .sampleShadingEnable = VK_FALSE
+    };
+
+    VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .depthTestEnable = VK_TRUE,
+        .depthWriteEnable = VK_TRUE,
+        .depthCompareOp = VK_COMPARE_OP_LESS,
+        .depthBoundsTestEnable = VK_FALSE,
+        .stencilTestEnable = VK_FALSE
+    };
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachmentState {
+        .blendEnable = VK_FALSE,
+        .colorWriteMask = 0
+    };
+
+    VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+        .logicOpEnable = VK_FALSE,
+        .attachmentCount = 1,
+        .pAttachments = &colorBlendAttachmentState
+    };
+
+    std::array<VkDynamicState, 2> dynamicStates {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+        .dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()),
+        .pDynamicStates = dynamicStates.data()
+    };
+
+    VkPipelineRenderingCreateInfo renderingCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+        .colorAttachmentCount = 1,
+        .pColorAttachmentFormats = &mRenderDevice.swapchainFormat,
+        .depthAttachmentFormat = DEPTH_FORMAT
+    };
+
+    // shares the main pipeline's layout so the descriptor sets stay bound between the passes
+    VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &renderingCreateInfo,
+        .stageCount = 1,
+        .pStages = &vertexShaderStageCreateInfo,
+        .pVertexInputState = &vertexInputStateCreateInfo,
+        .pInputAssemblyState = &inputAssemblyStateCreateInfo,
+        .pViewportState = &viewportStateCreateInfo,
+        .pRasterizationState = &rasterizationStateCreateInfo,
+        .pMultisampleState = &multisampleStateCreateInfo,
+        .pDepthStencilState = &depthStencilStateCreateInfo,
+        .pColorBlendState = &colorBlendStateCreateInfo,
+        .pDynamicState = &dynamicStateCreateInfo,
+        .layout = mPipelineLayout
     };
 
     VkResult result = vkCreateGraphicsPipelines(mRenderDevice.device,
-                                       VK_NULL_HANDLE,
+                                                mPipelineCache,
+                                                1, &graphicsPipelineCreateInfo,
+                                                nullptr,
+                                                &mDepthPrepassPipeline);
+    vulkanCheck(result, "Failed to create depth pre-pass pipeline.");
+
+    vkDestroyShaderModule(mRenderDevice.device, vertexShader, nullptr);
+}
+
+void Application::createPostProcessing()
+{
+    if (mAntiAliasing != AntiAliasing::FXAA)
+        return;
+
+    // sampler, the edge search relies on bilinear filtering between texels
+    VkSamplerCreateInfo samplerCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .magFilter = VK_FILTER_LINEAR,
+        .minFilter = VK_FILTER_LINEAR,
+        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+        .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .maxLod = 0.f
+    };
+
+    VkResult result = vkCreateSampler(mRenderDevice.device, &samplerCreateInfo, nullptr, &mPostSampler);
+    vulkanCheck(result, "Failed to create post processing sampler.");
+
+    // descriptor sets
+    VkDescriptorSetLayoutBinding sceneColorBinding {
+        .binding = 0,
+        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .descriptorCount = 1,
+        .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT
+    };
+
+    VkDescriptorSetLayoutCreateInfo layoutCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = 1,
+        .pBindings = &sceneColorBinding
+    };
+
+    result = vkCreateDescriptorSetLayout(mRenderDevice.device, &layoutCreateInfo, nullptr, &mPostLayout);
+    vulkanCheck(result, "Failed to create post processing descriptor set layout.");
+
+    std::array<VkDescriptorSetLayout, FRAMES_IN_FLIGHT> layouts;
+    layouts.fill(mPostLayout);
+
+    VkDescriptorSetAllocateInfo descriptorSetAllocateInfo {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = mDescriptorPool,
+        .descriptorSetCount = static_cast<uint32_t>(layouts.size()),
+        .pSetLayouts = layouts.data()
+    };
+
+    result = vkAllocateDescriptorSets(mRenderDevice.device, &descriptorSetAllocateInfo, mPostSets.data());
+    vulkanCheck(result, "Failed to allocate post processing descriptor sets.");
+
+    // pipeline layout
+    VkPushConstantRange pushConstantRange {
+        .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+        .offset = 0,
+        .size = sizeof(glm::vec2)
+    };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &mPostLayout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange
+    };
+
+    result = vkCreatePipelineLayout(mRenderDevice.device, &pipelineLayoutCreateInfo, nullptr, &mPostPipelineLayout);
+    vulkanCheck(result, "Failed to create post processing pipeline layout.");
+
+    // pipeline
+    VkShaderModule vertexShader = createShaderModule(mRenderDevice, "shaders/fullscreen_vert.spv");
+    VkShaderModule fragmentShader = createShaderModule(mRenderDevice, "shaders/fxaa_frag.spv");
+
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages {{
+        {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_VERTEX_BIT,
+            .module = vertexShader,
+            .pName = "main"
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .module = fragmentShader,
+            .pName = "main"
+        }
+    }};
+
+    // the fullscreen triangle is generated in the vertex shader
+    VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO
+    };
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
+    };
+
+    VkPipelineViewportStateCreateInfo viewportStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+        .viewportCount = 1,
+        .scissorCount = 1
+    };
+
+    VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .depthClampEnable = VK_FALSE,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .cullMode = VK_CULL_MODE_NONE,
+        .depthBiasEnable = VK_FALSE,
+        .lineWidth = 1.f
+    };
+
+    VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+        .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+    };
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachmentState {
+        .blendEnable = VK_FALSE,
+        .colorWriteMask {
+            VK_COLOR_COMPONENT_R_BIT |
+            VK_COLOR_COMPONENT_G_BIT |
+            VK_COLOR_COMPONENT_B_BIT |
+            VK_COLOR_COMPONENT_A_BIT
+        }
+    };
+
+    VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+        .logicOpEnable = VK_FALSE,
+        .attachmentCount = 1,
+        .pAttachments = &colorBlendAttachmentState
+    };
+
+    std::array<VkDynamicState, 2> dynamicStates {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+        .dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()),
+        .pDynamicStates = dynamicStates.data()
+    };
+
+    VkPipelineRenderingCreateInfo renderingCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+        .colorAttachmentCount = 1,
+        .pColorAttachmentFormats = &mRenderDevice.swapchainFormat
+    };
+
+    VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &renderingCreateInfo,
+        .stageCount = static_cast<uint32_t>(shaderStages.size()),
+        .pStages = shaderStages.data(),
+        .pVertexInputState = &vertexInputStateCreateInfo,
+        .pInputAssemblyState = &inputAssemblyStateCreateInfo,
+        .pViewportState = &viewportStateCreateInfo,
+        .pRasterizationState = &rasterizationStateCreateInfo,
+        .pMultisampleState = &multisampleStateCreateInfo,
+        .pColorBlendState = &colorBlendStateCreateInfo,
+        .pDynamicState = &dynamicStateCreateInfo,
+        .layout = mPostPipelineLayout
+    };
+
+    result = vkCreateGraphicsPipelines(mRenderDevice.device,
+                                       mPipelineCache,
                                        1, &graphicsPipelineCreateInfo,
                                        nullptr,
-                                       &mGraphicsPipeline);
-    vulkanCheck(result, "Failed to create graphics pipeline.");
+                                       &mPostPipeline);
+    vulkanCheck(result, "Failed to create post processing pipeline.");
 
     vkDestroyShaderModule(mRenderDevice.device, vertexShader, nullptr);
     vkDestroyShaderModule(mRenderDevice.device, fragmentShader, nullptr);
 }
 
+void Application::destroyPostProcessing()
+{
+    // the descriptor sets are freed with the descriptor pool
+    vkDestroyPipeline(mRenderDevice.device, mPostPipeline, nullptr);
+    vkDestroyPipelineLayout(mRenderDevice.device, mPostPipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(mRenderDevice.device, mPostLayout, nullptr);
+    vkDestroySampler(mRenderDevice.device, mPostSampler, nullptr);
+}
+
+void Application::updatePostDescriptorSet(uint32_t frameIndex)
+{
+    VkDescriptorImageInfo sceneColorInfo {
+        .sampler = mPostSampler,
+        .imageView = mRenderGraph.imageView(mSceneColorResource),
+        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+
+    VkWriteDescriptorSet descriptorWrite {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = mPostSets.at(frameIndex),
+        .dstBinding = 0,
+        .dstArrayElement = 0,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .pImageInfo = &sceneColorInfo
+    };
+
+    vkUpdateDescriptorSets(mRenderDevice.device, 1, &descriptorWrite, 0, nullptr);
+    mPostSetVersions.at(frameIndex) = mAttachmentVersion;
+}
+
 void Application::setupCamera()
 {
-    mCamera = Camera(45.f, INITIAL_WINDOW_WIDTH, INITIAL_WINDOW_HEIGHT);
+    mCamera = Camera(45.f, mRenderDevice.swapchainExtent.width, mRenderDevice.swapchainExtent.height);
     mCamera.setPosition(0, 0, 5);
 }
 
-void Application::recordRenderCommands(uint32_t imageIndex)
+void Application::recordRenderCommands(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 {
     VkCommandBufferBeginInfo beginInfo {
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
         .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
     };
 
-    vkBeginCommandBuffer(mRenderDevice.commandBuffer, &beginInfo);
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    beginGpuTimer(mGpuTimer, commandBuffer, mRenderDevice.frameIndex);
+    resetPipelineStatistics(mPipelineStatistics, commandBuffer, mRenderDevice.frameIndex);
 
-    static std::vector<VkClearValue> clearValues {
-        {.color = {0.2f, 0.2f, 0.2f, 1.f}},
-        {.depthStencil = {1.f, 0}}
-    };
+    mRenderGraph.setImportedImage(mSwapchainResource,
+                                  mRenderDevice.swapchainImages.at(imageIndex),
+                                  mRenderDevice.swapchainImageViews.at(imageIndex));
+    mRenderGraph.execute(commandBuffer);
 
-    VkRenderPassBeginInfo renderPassBeginInfo {
-        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-        .renderPass = mRenderPass,
-        .framebuffer = mFramebuffers.at(imageIndex),
-        .renderArea {
-            .offset = {0, 0},
-            .extent = mRenderDevice.swapchainExtent
-        },
-        .clearValueCount = static_cast<uint32_t>(clearValues.size()),
-        .pClearValues = clearValues.data()
-    };
+    endGpuTimer(mGpuTimer, commandBuffer, mRenderDevice.frameIndex);
+    vkEndCommandBuffer(commandBuffer);
+}
 
+void Application::setViewportAndScissor(VkCommandBuffer commandBuffer)
+{
     VkViewport viewport {
         .x = 0,
         .y = 0,
@@ -614,31 +1688,239 @@ void Application::recordRenderCommands(uint32_t imageIndex)
         .extent = mRenderDevice.swapchainExtent
     };
 
-    vkCmdBeginRenderPass(mRenderDevice.commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-    vkCmdBindPipeline(mRenderDevice.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mGraphicsPipeline);
-    vkCmdSetViewport(mRenderDevice.commandBuffer, 0, 1, &viewport);
-    vkCmdSetScissor(mRenderDevice.commandBuffer, 0, 1, &scissor);
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+void Application::buildDrawList()
+{
+    // only the view space z of each mesh center is needed, the camera looks down -z
+    glm::mat4 modelView = mCamera.view() * mModelMatrix;
+    glm::vec4 depthRow {modelView[0][2], modelView[1][2], modelView[2][2], modelView[3][2]};
+
+    mDrawList.clear();
+
+    for (uint32_t i = 0; i < mModel.meshes.size(); ++i)
+    {
+        const Mesh& mesh = mModel.meshes.at(i);
+
+        if (mesh.instanceCount == 0)
+            continue;
+
+        float viewDepth = -glm::dot(depthRow, glm::vec4(mesh.center, 1.f));
+
+        if (mDepthPrepass)
+            mDrawList.add({DrawPass::DepthPrepass, DEPTH_PREPASS_PIPELINE, mesh.materialIndex, i}, viewDepth);
+
+        // the key sorts by pipeline first, so draws end up grouped per permutation
+        DrawPass pass = mesh.blended? DrawPass::Blended : DrawPass::Opaque;
+        uint32_t pipelineIndex = SHADED_PIPELINE + getMaterialFeatures(mModel.materials.at(mesh.materialIndex));
+        mDrawList.add({pass, pipelineIndex, mesh.materialIndex, i}, viewDepth);
+    }
+
+    mDrawList.sort();
+}
+
+void Application::recordScenePass(VkCommandBuffer commandBuffer)
+{
+    FramePacer::Clock::time_point recordStart = FramePacer::Clock::now();
+
+    buildDrawList();
+    mDrawSortTimeTotalMs += std::chrono::duration<double, std::milli>(FramePacer::Clock::now() - recordStart).count();
+
+    // the ring buffer isn't thread safe, allocate before handing out the work
+    glm::mat4 modelView = mCamera.view() * mModelMatrix;
+
+    UniformAllocation mvp = allocateUniform(mUniformRingBuffer, sizeof(SceneUniforms));
+    *static_cast<SceneUniforms*>(mvp.data) = {
+        .mvp = mCamera.viewProjection() * mModelMatrix,
+        .modelView = modelView,
+        .normalMatrix = glm::mat4(glm::transpose(glm::inverse(glm::mat3(modelView))))
+    };
+
+    // chunks are contiguous ranges of the sorted list, executed in order they keep its ordering
+    size_t drawCount = mDrawList.size();
+    size_t chunkCount = std::min<size_t>(mRecordThreadPool.threadCount() * 2,
+                                         (drawCount + MIN_DRAWS_PER_CHUNK - 1) / MIN_DRAWS_PER_CHUNK);
+    chunkCount = std::max<size_t>(chunkCount, 1);
+    size_t drawsPerChunk = (drawCount + chunkCount - 1) / chunkCount;
+
+    mSceneCommandBuffers.assign(chunkCount, VK_NULL_HANDLE);
+
+    mRecordThreadPool.run(mSceneCommandBuffers.size(), [&] (uint32_t taskIndex, uint32_t threadIndex) {
+        SecondaryCommandPool& pool = mSecondaryCommandPools.at(threadIndex).at(mRenderDevice.frameIndex);
+        VkCommandBuffer secondary = allocateSecondaryCommandBuffer(mRenderDevice, pool);
+
+        size_t firstDraw = std::min(taskIndex * drawsPerChunk, drawCount);
+        size_t chunkDrawCount = std::min(drawsPerChunk, drawCount - firstDraw);
+
+        recordSceneChunk(secondary, firstDraw, chunkDrawCount, mvp.offset);
+
+        mSceneCommandBuffers.at(taskIndex) = secondary;
+    });
+
+    vkCmdExecuteCommands(commandBuffer, mSceneCommandBuffers.size(), mSceneCommandBuffers.data());
+
+    mRecordTimeTotalMs += std::chrono::duration<double, std::milli>(FramePacer::Clock::now() - recordStart).count();
+    ++mRecordTimeSamples;
+}
+
+void Application::recordSceneChunk(VkCommandBuffer commandBuffer,
+                                   size_t firstDraw,
+                                   size_t drawCount,
+                                   uint32_t mvpOffset)
+{
+    VkCommandBufferInheritanceRenderingInfo inheritanceRenderingInfo {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+        .colorAttachmentCount = 1,
+        .pColorAttachmentFormats = &mRenderDevice.swapchainFormat,
+        .depthAttachmentFormat = DEPTH_FORMAT,
+        .rasterizationSamples = mSampleCount
+    };
+
+    VkCommandBufferInheritanceInfo inheritanceInfo {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .pNext = &inheritanceRenderingInfo,
+        .pipelineStatistics = mPipelineStatistics.supported?
+            static_cast<VkQueryPipelineStatisticFlags>(VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT) : 0u
+    };
+
+    VkCommandBufferBeginInfo beginInfo {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        .pInheritanceInfo = &inheritanceInfo
+    };
+
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    // secondaries don't inherit state, every chunk binds everything it uses.
+    // both scene pipelines share the layout, so the sets stay bound across pipeline changes
+    setViewportAndScissor(commandBuffer);
 
     std::array<VkDescriptorSet, 2> descriptorSets {mSet0, mSet1};
-    vkCmdBindDescriptorSets(mRenderDevice.commandBuffer,
+    vkCmdBindDescriptorSets(commandBuffer,
                             VK_PIPELINE_BIND_POINT_GRAPHICS,
                             mPipelineLayout,
                             0, descriptorSets.size(), descriptorSets.data(),
-                            0, nullptr);
+                            1, &mvpOffset);
 
-    renderModel(mModel, mRenderDevice, mPipelineLayout, mRenderDevice.commandBuffer);
-    vkCmdEndRenderPass(mRenderDevice.commandBuffer);
+    // without instances the draw list is empty and there is no instance buffer
+    if (mModel.instanceCount > 0)
+    {
+        VkDeviceSize instanceOffset = getInstanceBufferOffset(mModel, mRenderDevice.frameIndex);
+        vkCmdBindVertexBuffers(commandBuffer, 1, 1, &mModel.instanceBuffer.buffer, &instanceOffset);
+    }
+
+    std::array<VkPipeline, SHADED_PIPELINE + MATERIAL_PERMUTATION_COUNT> pipelines {mDepthPrepassPipeline};
+    std::copy(mShadedPipelines.begin(), mShadedPipelines.end(), pipelines.begin() + SHADED_PIPELINE);
+    VkPipeline boundPipeline = VK_NULL_HANDLE;
+    VkBuffer boundVertexBuffer = VK_NULL_HANDLE;
+    VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
+    std::optional<uint32_t> boundMaterial;
+
+    for (size_t i = firstDraw; i < firstDraw + drawCount; ++i)
+    {
+        const DrawCommand& draw = mDrawList.at(i);
+        const Mesh& mesh = mModel.meshes.at(draw.meshIndex);
 
-    vkEndCommandBuffer(mRenderDevice.commandBuffer);
+        if (VkPipeline pipeline = pipelines.at(draw.pipelineIndex); pipeline != boundPipeline)
+        {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+            boundPipeline = pipeline;
+        }
+
+        if (mesh.vertexBuffer.buffer != boundVertexBuffer)
+        {
+            VkDeviceSize offset = 0;
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &mesh.vertexBuffer.buffer, &offset);
+            boundVertexBuffer = mesh.vertexBuffer.buffer;
+        }
+
+        if (mesh.indexBuffer.buffer.buffer != boundIndexBuffer)
+        {
+            vkCmdBindIndexBuffer(commandBuffer, mesh.indexBuffer.buffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+            boundIndexBuffer = mesh.indexBuffer.buffer.buffer;
+        }
+
+        // the depth-only pipeline has no fragment stage reading the material
+        if (draw.pass != DrawPass::DepthPrepass && boundMaterial != draw.materialIndex)
+        {
+            vkCmdPushConstants(commandBuffer, mPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uint32_t), &draw.materialIndex);
+            boundMaterial = draw.materialIndex;
+        }
+
+        vkCmdDrawIndexed(commandBuffer, mesh.indexBuffer.count, mesh.instanceCount, 0, 0, mesh.firstInstance);
+    }
+
+    vkEndCommandBuffer(commandBuffer);
+}
+
+void Application::recordPostPass(VkCommandBuffer commandBuffer)
+{
+    glm::vec2 inverseScreenSize {
+        1.f / mRenderDevice.swapchainExtent.width,
+        1.f / mRenderDevice.swapchainExtent.height
+    };
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPostPipeline);
+    setViewportAndScissor(commandBuffer);
+    vkCmdBindDescriptorSets(commandBuffer,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            mPostPipelineLayout,
+                            0, 1, &mPostSets.at(mRenderDevice.frameIndex),
+                            0, nullptr);
+    vkCmdPushConstants(commandBuffer,
+                       mPostPipelineLayout,
+                       VK_SHADER_STAGE_FRAGMENT_BIT,
+                       0, sizeof(glm::vec2), &inverseScreenSize);
+    vkCmdDraw(commandBuffer, 3, 1, 0, 0);
 }
 
 void Application::renderFrame()
 {
+    VulkanFrame& frame = mRenderDevice.frames.at(mRenderDevice.frameIndex);
+
+    // the frame's command buffer and semaphores are free once its previous submission retired
+    waitForTicket(mRenderDevice, frame.ticket);
+    flushDeletionQueue(mRenderDevice);
+    swapInOptimizedPipelines();
+    beginUniformRingFrame(mUniformRingBuffer, mRenderDevice.frameIndex);
+    updateModelTransforms(mModel, mRenderDevice.frameIndex);
+
+    for (std::array<SecondaryCommandPool, FRAMES_IN_FLIGHT>& threadPools : mSecondaryCommandPools)
+        resetSecondaryCommandPool(mRenderDevice, threadPools.at(mRenderDevice.frameIndex));
+
+    mLastGpuTimeMs = readGpuTimer(mRenderDevice, mGpuTimer, mRenderDevice.frameIndex);
+    if (mLastGpuTimeMs)
+    {
+        mGpuTimeTotalMs += *mLastGpuTimeMs;
+        ++mGpuTimeSamples;
+    }
+
+    if (std::optional<uint64_t> fragmentInvocations = readFragmentInvocations(mRenderDevice, mPipelineStatistics, mRenderDevice.frameIndex))
+    {
+        mFragmentInvocationsTotal += *fragmentInvocations;
+        ++mFragmentInvocationSamples;
+    }
+
+    // the set is no longer in use, point it at the current attachments
+    if (mAntiAliasing == AntiAliasing::FXAA && mPostSetVersions.at(mRenderDevice.frameIndex) != mAttachmentVersion)
+        updatePostDescriptorSet(mRenderDevice.frameIndex);
+
+    // a headless frame renders into its own image, nothing is acquired or presented
+    if (mRenderDevice.headless)
+    {
+        recordRenderCommands(frame.commandBuffer, mRenderDevice.frameIndex);
+        frame.ticket = submitCommandBuffer(mRenderDevice, frame.commandBuffer, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+        mRenderDevice.frameIndex = (mRenderDevice.frameIndex + 1) % FRAMES_IN_FLIGHT;
+        return;
+    }
+
     uint32_t imageIndex;
     VkResult result = vkAcquireNextImageKHR(mRenderDevice.device,
                                             mRenderDevice.swapchain,
                                             UINT64_MAX,
-                                            mRenderDevice.imageReadySemaphore,
+                                            frame.imageReadySemaphore,
                                             VK_NULL_HANDLE,
                                             &imageIndex);
     if (result == VK_ERROR_OUT_OF_DATE_KHR)
@@ -647,37 +1929,29 @@ void Application::renderFrame()
         return;
     }
 
-    recordRenderCommands(imageIndex);
-
-    VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    recordRenderCommands(frame.commandBuffer, imageIndex);
 
-    VkSubmitInfo renderSubmitInfo {
-        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-        .waitSemaphoreCount = 1,
-        .pWaitSemaphores = &mRenderDevice.imageReadySemaphore,
-        .pWaitDstStageMask = &dstStage,
-        .commandBufferCount = 1,
-        .pCommandBuffers = &mRenderDevice.commandBuffer,
-        .signalSemaphoreCount = 1,
-        .pSignalSemaphores = &mRenderDevice.renderFinishedSemaphore
-    };
+    frame.ticket = submitCommandBuffer(mRenderDevice,
+                                       frame.commandBuffer,
+                                       frame.imageReadySemaphore,
+                                       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                       frame.renderFinishedSemaphore);
 
-    vkQueueSubmit(mRenderDevice.graphicsQueue, 1, &renderSubmitInfo, VK_NULL_HANDLE);
 
     VkPresentInfoKHR presentInfo {
         .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
         .waitSemaphoreCount = 1,
-        .pWaitSemaphores = &mRenderDevice.renderFinishedSemaphore,
+        .pWaitSemaphores = &frame.renderFinishedSemaphore,
         .swapchainCount = 1,
         .pSwapchains = &mRenderDevice.swapchain,
         .pImageIndices = &imageIndex
     };
 
+    mRenderDevice.frameIndex = (mRenderDevice.frameIndex + 1) % FRAMES_IN_FLIGHT;
+
     result = vkQueuePresentKHR(mRenderDevice.graphicsQueue, &presentInfo);
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
         resize();
-
-    vkDeviceWaitIdle(mRenderDevice.device);
 }
 
 void Application::resize()
@@ -691,27 +1965,31 @@ void Application::resize()
         glfwGetFramebufferSize(mWindow, &width, &height);
     }
 
-    vkDeviceWaitIdle(mRenderDevice.device);
-
-    // destroy resources
-    for (size_t i = 0, size = mRenderDevice.swapchainImages.size(); i < size; ++i)
-    {
-        vkDestroyFramebuffer(mRenderDevice.device, mFramebuffers.at(i), nullptr);
-        vkDestroyImageView(mRenderDevice.device, mRenderDevice.swapchainImageViews.at(i), nullptr);
-    }
-
-    destroyImage(mRenderDevice, mDepthImage);
-    vkDestroySwapchainKHR(mRenderDevice.device, mRenderDevice.swapchain, nullptr);
-
-    // recreate resources
-    createSwapchain(mInstance, mRenderDevice);
+    // Frames in flight still reference the current swapchain and attachments, so they are
+    // retired instead of destroyed. Presentation has no completion signal, so they are only
+    // released once FRAMES_IN_FLIGHT further submissions have finished.
+    VkSwapchainKHR oldSwapchain = mRenderDevice.swapchain;
+    uint64_t releaseTicket = mRenderDevice.lastSubmittedTicket + FRAMES_IN_FLIGHT;
+
+    deferDestruction(mRenderDevice, releaseTicket, [this,
+                                                    oldSwapchain,
+                                                    imageViews = std::move(mRenderDevice.swapchainImageViews),
+                                                    renderGraph = mRenderGraph] () mutable {
+        for (VkImageView imageView : imageViews)
+            vkDestroyImageView(mRenderDevice.device, imageView, nullptr);
+
+        renderGraph.destroy(mRenderDevice);
+        vkDestroySwapchainKHR(mRenderDevice.device, oldSwapchain, nullptr);
+    });
+
+    // recreate resources, handing the old swapchain over so its images can be reused
+    createSwapchain(mInstance, mRenderDevice, oldSwapchain);
     createSwapchainImages(mRenderDevice);
-    createDepthImage();
-    createFramebuffers();
+    buildRenderGraph();
 
     // update resources
     mCamera.resize(mRenderDevice.swapchainExtent.width, mRenderDevice.swapchainExtent.height);
-    updateViewProjUBO();
+    mRedrawRequested = true;
 
 #ifdef DEBUG_MODE
     std::cout << "Resized: " << mRenderDevice.swapchainExtent.width << ' ' << mRenderDevice.swapchainExtent.height << '\n';
@@ -734,11 +2012,11 @@ void Application::mouseButtonCallback(GLFWwindow *window, int button, int action
     {
         if (action == GLFW_PRESS)
         {
-            app.mLeftMouseButtonPressed = true;
+            app.handleInput(InputEventType::MouseButton, 1.0, 0.0);
         }
         else if (action == GLFW_RELEASE)
         {
-            app.mLeftMouseButtonPressed = false;
+            app.handleInput(InputEventType::MouseButton, 0.0, 0.0);
         }
     }
 }
@@ -746,25 +2024,7 @@ void Application::mouseButtonCallback(GLFWwindow *window, int button, int action
 void Application::cursorPositionCallback(GLFWwindow *window, double x, double y)
 {
     Application& app = *reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
-
-    if (app.mLeftMouseButtonPressed)
-    {
-        double dx = x - app.mCursorPosX;
-        double dy = y - app.mCursorPosY;
-
-        app.mRotationX += dx * app.mOrbitNavSensitivity;
-        app.mRotationY += dy * app.mOrbitNavSensitivity;
-
-        if (glm::abs(app.mRotationY) > 90.f)
-        {
-            app.mRotationY = glm::clamp(app.mRotationY, -90.f, 90.f);
-        }
-
-        app.updateViewProjUBO();
-    }
-
-    app.mCursorPosX = x;
-    app.mCursorPosY = y;
+    app.handleInput(InputEventType::CursorPosition, x, y);
 }
 
 void Application::scrollCallback(GLFWwindow *window, double xOffset, double yOffset)
@@ -773,9 +2033,17 @@ void Application::scrollCallback(GLFWwindow *window, double xOffset, double yOff
         return;
 
     Application& app = *reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
+    app.handleInput(InputEventType::Scroll, 0.0, yOffset);
+}
 
-    app.mScale += yOffset * app.mScale / 10.f;
-    app.mScale = glm::clamp(app.mScale, 0.1f, 10.f);
+void Application::framebufferSizeCallback(GLFWwindow *window, int width, int height)
+{
+    Application& app = *reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
+    app.requestRedraw();
+}
 
-    app.updateViewProjUBO();
+void Application::windowRefreshCallback(GLFWwindow *window)
+{
+    Application& app = *reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
+    app.requestRedraw();
 }
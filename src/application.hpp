@@ -6,31 +6,61 @@
 #define VULKAN3DMODELVIEWER_APPLICATION_HPP
 
 #include <array>
+#include <atomic>
+#include <optional>
 #include <vulkan/vulkan.h>
 #include <glfw/glfw3.h>
 #include <glm/glm.hpp>
 #include "vk/vulkan_types.hpp"
 #include "vk/vulkan_functions.hpp"
 #include "model/model.hpp"
+#include "model/vertex_input.hpp"
 #include "camera/camera.hpp"
-
+#include "options.hpp"
+#include "frame_pacer.hpp"
+#include "startup_report.hpp"
+#include "input_recording.hpp"
+#include "replay_report.hpp"
+#include "renderer/render_graph.hpp"
+#include "renderer/draw_list.hpp"
+#include "utils/thread_pool.hpp"
+#include "utils/job_system.hpp"
+#include "utils/file_reader.hpp"
+
+
+// an optimized material pipeline compiling in the background, swapped in by the first frame after it finished
+struct PipelineCompile
+{
+    JobSystem::JobHandle job;
+    VkPipeline pipeline;
+    VkResult result;
+    double compileMs;
+};
 
 class Application
 {
 public:
-    Application();
+    Application(const Options& options);
     ~Application();
 
     void run();
 
+    // thread safe, wakes up the event loop in on-demand mode
+    void requestRedraw();
+
 private:
     void initializeGLFW();
-    void createDepthImage();
-    void createSampledColorImage();
-    void createRenderPass();
-    void createFramebuffers();
-    void createViewProjUBO();
-    void updateViewProjUBO();
+    void loadScene(const std::vector<ModelPlacement>& placements);
+    void buildRenderGraph();
+    void reportAttachmentMemory();
+    void updateModelMatrix();
+    void handleInput(InputEventType type, double x, double y);
+    void applyInputEvent(const InputEventRecord& event);
+    void applyPendingInput();
+    ViewState viewState() const;
+    void runReplay();
+    void reportFrameStats();
+    void reportMemoryUsage();
     void createDescriptorPool();
     void createDescriptorSetLayouts();
     void createDescriptorSets();
@@ -38,31 +68,141 @@ private:
     void destroyDescriptorResources();
     void createPipelineLayout();
     void createGraphicsPipeline();
+    void createFastLinkedPipelines(const std::vector<uint32_t>& permutations);
+    void createUbershaderPipeline(const std::vector<uint32_t>& permutations);
+    void scheduleOptimizedPipelines(const std::vector<uint32_t>& permutations);
+    void swapInOptimizedPipelines();
+    void releasePipelineFallbacks();
+    void trackStartupFrame(double frameMs);
+    void destroyShadedPipelines();
+    VkResult createShadedPipeline(uint32_t materialFeatures,
+                                  bool genericMaterial,
+                                  VkGraphicsPipelineLibraryFlagsEXT libraryParts,
+                                  VkPipeline& pipeline);
+    VkResult linkShadedPipeline(uint32_t materialFeatures, bool optimize, VkPipeline& pipeline);
+    void createDepthPrepassPipeline();
+    void createPostProcessing();
+    void destroyPostProcessing();
+    void updatePostDescriptorSet(uint32_t frameIndex);
     void setupCamera();
     void resize();
 
-    void recordRenderCommands(uint32_t imageIndex);
+    void recordRenderCommands(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+    void setViewportAndScissor(VkCommandBuffer commandBuffer);
+    void buildDrawList();
+    void recordScenePass(VkCommandBuffer commandBuffer);
+    void recordSceneChunk(VkCommandBuffer commandBuffer,
+                          size_t firstDraw,
+                          size_t drawCount,
+                          uint32_t mvpOffset);
+    void recordPostPass(VkCommandBuffer commandBuffer);
     void renderFrame();
 
     static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
     static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
     static void cursorPositionCallback(GLFWwindow* window, double x, double y);
     static void scrollCallback(GLFWwindow* window, double xOffset, double yOffset);
+    static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
+    static void windowRefreshCallback(GLFWwindow* window);
 
 private:
+    // time to first frame and the frames drawn before the optimized pipelines were ready
+    StartupReport mStartupReport;
+    std::string mStartupReportPath;
+    bool mFirstFramePresented;
+    uint32_t mFallbackFrameCount;
+    double mWorstFallbackFrameMs;
+    double mRenderThreadCompileMs;
+
+    // window input is recorded when a path is given. A replay feeds a recording's events in at
+    // a fixed timestep and ignores the window's input, headless replays don't open a window.
+    std::string mRecordInputPath;
+    InputRecording mInputRecording;
+    FramePacer::Clock::time_point mInputRecordingStart;
+    std::string mReplayPath;
+    InputRecording mReplayRecording;
+    double mReplayTimestepMs;
+    std::string mReplayReportPath;
+    bool mHeadless;
+
     GLFWwindow* mWindow;
+    RenderMode mRenderMode;
+    std::atomic<bool> mRedrawRequested;
+
+    FramePacer mFramePacer;
+    bool mPrintFrameStats;
+    FramePacer::Clock::time_point mLastFrameStatsReport;
+    std::string mMemoryReportPath;
+
+    GpuTimer mGpuTimer;
+    // of the frame last submitted on the current frame in flight, read by renderFrame
+    std::optional<double> mLastGpuTimeMs;
+    double mGpuTimeTotalMs;
+    uint32_t mGpuTimeSamples;
+
+    PipelineStatistics mPipelineStatistics;
+    uint64_t mFragmentInvocationsTotal;
+    uint32_t mFragmentInvocationSamples;
+
+    // runs the import stages, the main thread helps while it waits for them
+    JobSystem mLoadJobSystem;
+    FileReader mFileReader;
+
+    // the scene's draws are split into chunks, each recorded into a secondary command
+    // buffer by a worker. Every worker owns one command pool per frame in flight.
+    ThreadPool mRecordThreadPool;
+    std::vector<std::array<SecondaryCommandPool, FRAMES_IN_FLIGHT>> mSecondaryCommandPools;
+    std::vector<VkCommandBuffer> mSceneCommandBuffers;
+    double mRecordTimeTotalMs;
+    double mDrawSortTimeTotalMs;
+    uint32_t mRecordTimeSamples;
+
+    // the scene's draws of the current frame, sorted by state and view depth
+    DrawList mDrawList;
+
     VulkanInstance mInstance;
     VulkanRenderDevice mRenderDevice;
 
-    VkRenderPass mRenderPass;
     VkPipelineLayout mPipelineLayout;
-    VkPipeline mGraphicsPipeline;
-
-    VulkanImage mDepthImage;
-    VulkanImage mSampledColorImage;
-    std::vector<VkFramebuffer> mFramebuffers;
-
-    VulkanBuffer mModelViewProjUBO;
+    // one pipeline per material feature combination in use, specialized so the fragment
+    // shader has no branches on the material. Indexed by the feature bits.
+    std::array<VkPipeline, MATERIAL_PERMUTATION_COUNT> mShadedPipelines;
+
+    // Until their optimized pipeline compiled in the background, draws use a pipeline
+    // fast-linked from separately compiled libraries or, without library support, the
+    // ubershader that reads the features from the material.
+    VkShaderModule mShadedVertexShader;
+    VkShaderModule mShadedFragmentShader;
+    VkPipeline mUbershaderPipeline;
+    VkPipeline mSharedPipelineLibrary;
+    std::array<VkPipeline, MATERIAL_PERMUTATION_COUNT> mFragmentPipelineLibraries;
+    std::array<PipelineCompile, MATERIAL_PERMUTATION_COUNT> mPipelineCompiles;
+    uint32_t mPendingPipelineCompiles;
+    double mOptimizedPipelineCompileMs;
+    VkPipelineCache mPipelineCache;
+
+    // lays down depth before shading, the main pass then only shades visible fragments
+    bool mDepthPrepass;
+    VkPipeline mDepthPrepassPipeline;
+
+    AntiAliasing mAntiAliasing;
+    VkSampleCountFlagBits mSampleCount;
+
+    // rebuilt whenever the swapchain is recreated
+    RenderGraph mRenderGraph;
+    RenderResource mSwapchainResource;
+    RenderResource mSceneColorResource;
+
+    // FXAA pass, samples the scene color and writes the swapchain image
+    VkPipelineLayout mPostPipelineLayout;
+    VkPipeline mPostPipeline;
+    VkDescriptorSetLayout mPostLayout;
+    VkSampler mPostSampler;
+    std::array<VkDescriptorSet, FRAMES_IN_FLIGHT> mPostSets;
+    std::array<uint32_t, FRAMES_IN_FLIGHT> mPostSetVersions;
+    uint32_t mAttachmentVersion;
+
+    UniformRingBuffer mUniformRingBuffer;
     VulkanBuffer mMaterialsUBO;
 
     VkDescriptorPool mDescriptorPool;
@@ -82,6 +222,11 @@ private:
     float mRotationY;
     float mScale;
     float mOrbitNavSensitivity;
+
+    // input accumulated between frames, applied once per frame
+    float mPendingRotationX;
+    float mPendingRotationY;
+    float mPendingScroll;
 };
 
 
@@ -0,0 +1,110 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#include "frame_pacer.hpp"
+
+
+FramePacer::FramePacer()
+    : mFramePeriod()
+    , mNextDeadline()
+    , mLastFrameStart()
+    , mSleepOvershoot(std::chrono::milliseconds(1))
+    , mHasLastFrame()
+    , mFrameCount()
+    , mMean()
+    , mM2()
+    , mMin()
+    , mMax()
+{
+}
+
+void FramePacer::setTargetFps(double fps)
+{
+    mFramePeriod = fps > 0.0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps))
+        : Clock::duration::zero();
+    mNextDeadline = Clock::now();
+}
+
+void FramePacer::beginFrame()
+{
+    if (mFramePeriod != Clock::duration::zero())
+    {
+        Clock::time_point now = Clock::now();
+
+        // don't try to catch up after a long stall, start a new cadence instead
+        if (now > mNextDeadline + mFramePeriod)
+            mNextDeadline = now;
+
+        waitUntil(mNextDeadline);
+        mNextDeadline += mFramePeriod;
+    }
+
+    Clock::time_point frameStart = Clock::now();
+
+    if (mHasLastFrame)
+        recordInterval(std::chrono::duration<double, std::milli>(frameStart - mLastFrameStart).count());
+
+    mLastFrameStart = frameStart;
+    mHasLastFrame = true;
+}
+
+void FramePacer::skipInterval()
+{
+    mHasLastFrame = false;
+}
+
+FrameStats FramePacer::stats() const
+{
+    return {
+        .frameCount = mFrameCount,
+        .meanMs = mMean,
+        .stdDevMs = mFrameCount > 1? std::sqrt(mM2 / (mFrameCount - 1)) : 0.0,
+        .minMs = mMin,
+        .maxMs = mMax
+    };
+}
+
+void FramePacer::resetStats()
+{
+    mFrameCount = 0;
+    mMean = 0.0;
+    mM2 = 0.0;
+    mMin = 0.0;
+    mMax = 0.0;
+}
+
+void FramePacer::waitUntil(Clock::time_point deadline)
+{
+    // sleep for the bulk of the wait, then spin through the part the OS scheduler can't hit reliably
+    Clock::time_point sleepDeadline = deadline - mSleepOvershoot;
+    Clock::time_point sleepStart = Clock::now();
+
+    if (sleepDeadline > sleepStart)
+    {
+        std::this_thread::sleep_until(sleepDeadline);
+
+        // track how late sleeps wake up, decaying slowly so one spike doesn't stick forever
+        Clock::duration overshoot = Clock::now() - sleepDeadline;
+        mSleepOvershoot = std::max(overshoot, mSleepOvershoot - mSleepOvershoot / 64);
+        mSleepOvershoot = std::clamp<Clock::duration>(mSleepOvershoot,
+                                                      std::chrono::microseconds(200),
+                                                      std::chrono::milliseconds(20));
+    }
+
+    while (Clock::now() < deadline)
+        std::this_thread::yield();
+}
+
+void FramePacer::recordInterval(double ms)
+{
+    ++mFrameCount;
+
+    double delta = ms - mMean;
+    mMean += delta / mFrameCount;
+    mM2 += delta * (ms - mMean);
+
+    mMin = mFrameCount == 1? ms : std::min(mMin, ms);
+    mMax = mFrameCount == 1? ms : std::max(mMax, ms);
+}
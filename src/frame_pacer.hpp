@@ -0,0 +1,60 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_FRAME_PACER_HPP
+#define VULKAN3DMODELVIEWER_FRAME_PACER_HPP
+
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+
+struct FrameStats
+{
+    uint32_t frameCount;
+    double meanMs;
+    double stdDevMs;
+    double minMs;
+    double maxMs;
+};
+
+class FramePacer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    FramePacer();
+
+    // 0 disables the limiter
+    void setTargetFps(double fps);
+
+    // blocks until the next frame is due and records the interval since the previous frame
+    void beginFrame();
+
+    // the next interval is not recorded, used after the loop idled waiting for events
+    void skipInterval();
+
+    FrameStats stats() const;
+    void resetStats();
+
+private:
+    void waitUntil(Clock::time_point deadline);
+    void recordInterval(double ms);
+
+    Clock::duration mFramePeriod;
+    Clock::time_point mNextDeadline;
+    Clock::time_point mLastFrameStart;
+    Clock::duration mSleepOvershoot;
+    bool mHasLastFrame;
+
+    // Welford's running mean and variance
+    uint32_t mFrameCount;
+    double mMean;
+    double mM2;
+    double mMin;
+    double mMax;
+};
+
+#endif //VULKAN3DMODELVIEWER_FRAME_PACER_HPP
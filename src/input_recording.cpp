@@ -0,0 +1,143 @@
+//
+// Created by Gianni on 19/10/2026.
+//
+
+#include "input_recording.hpp"
+
+#include <limits>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+
+static double parseTime(std::istringstream& line)
+{
+    double timeMs;
+    if (!(line >> timeMs) || timeMs < 0.0)
+        throw std::runtime_error("Missing or negative time.");
+
+    return timeMs;
+}
+
+void writeInputRecording(const InputRecording& recording, const std::string& filename)
+{
+    std::ofstream file(filename);
+    if (!file.is_open())
+        throw std::runtime_error("Failed to write input recording: " + filename);
+
+    // enough digits to read back the exact values, so replays see the same input
+    file.precision(std::numeric_limits<double>::max_digits10);
+
+    file << "# input recording, times in ms since the first frame\n"
+         << "extent " << recording.extent.width << ' ' << recording.extent.height << '\n'
+         << "view " << recording.initialView.rotationX << ' '
+         << recording.initialView.rotationY << ' '
+         << recording.initialView.scale << '\n';
+
+    for (const InputEventRecord& event : recording.events)
+    {
+        switch (event.type)
+        {
+            case InputEventType::MouseButton:
+                file << "button " << event.timeMs << ' ' << (event.x != 0.0? 1 : 0) << '\n';
+                break;
+            case InputEventType::CursorPosition:
+                file << "cursor " << event.timeMs << ' ' << event.x << ' ' << event.y << '\n';
+                break;
+            case InputEventType::Scroll:
+                file << "scroll " << event.timeMs << ' ' << event.y << '\n';
+                break;
+        }
+    }
+
+    file << "end " << recording.durationMs << '\n';
+}
+
+InputRecording loadInputRecording(const std::string& filename)
+{
+    std::ifstream file(filename);
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open input recording: " + filename);
+
+    InputRecording recording {
+        .extent = {0, 0},
+        .initialView = {0.f, 0.f, 1.f},
+        .events = {},
+        .durationMs = 0.0
+    };
+
+    std::string text;
+    for (uint32_t lineNumber = 1; std::getline(file, text); ++lineNumber)
+    {
+        std::istringstream line(text.substr(0, text.find('#')));
+
+        std::string statement;
+        if (!(line >> statement))
+            continue;
+
+        try
+        {
+            InputEventRecord event {};
+
+            if (statement == "extent")
+            {
+                if (!(line >> recording.extent.width >> recording.extent.height))
+                    throw std::runtime_error("Extent needs a width and a height.");
+                continue;
+            }
+            else if (statement == "view")
+            {
+                ViewState& view = recording.initialView;
+                if (!(line >> view.rotationX >> view.rotationY >> view.scale))
+                    throw std::runtime_error("View needs two rotations and a scale.");
+                continue;
+            }
+            else if (statement == "end")
+            {
+                recording.durationMs = parseTime(line);
+                continue;
+            }
+            else if (statement == "button")
+            {
+                event = {parseTime(line), InputEventType::MouseButton, 0.0, 0.0};
+                if (!(line >> event.x))
+                    throw std::runtime_error("Button event is missing its state.");
+            }
+            else if (statement == "cursor")
+            {
+                event = {parseTime(line), InputEventType::CursorPosition, 0.0, 0.0};
+                if (!(line >> event.x >> event.y))
+                    throw std::runtime_error("Cursor event is missing its position.");
+            }
+            else if (statement == "scroll")
+            {
+                event = {parseTime(line), InputEventType::Scroll, 0.0, 0.0};
+                if (!(line >> event.y))
+                    throw std::runtime_error("Scroll event is missing its offset.");
+            }
+            else
+            {
+                throw std::runtime_error("Unknown statement: " + statement);
+            }
+
+            if (!recording.events.empty() && event.timeMs < recording.events.back().timeMs)
+                throw std::runtime_error("Events are out of order.");
+
+            recording.events.push_back(event);
+        }
+        catch (const std::runtime_error& error)
+        {
+            throw std::runtime_error(filename + ":" + std::to_string(lineNumber) + ": " + error.what());
+        }
+    }
+
+    if (recording.extent.width == 0 || recording.extent.height == 0)
+        throw std::runtime_error(filename + ": missing extent");
+
+    // a recording cut short still replays all of its events
+    if (!recording.events.empty())
+        recording.durationMs = std::max(recording.durationMs, recording.events.back().timeMs);
+
+    return recording;
+}
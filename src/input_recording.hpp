@@ -0,0 +1,58 @@
+//
+// Created by Gianni on 19/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_INPUT_RECORDING_HPP
+#define VULKAN3DMODELVIEWER_INPUT_RECORDING_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+
+enum class InputEventType
+{
+    MouseButton,
+    CursorPosition,
+    Scroll
+};
+
+// window input as the GLFW callbacks received it. A mouse button event stores whether
+// the left button went down in x, a scroll event its offset in y.
+struct InputEventRecord
+{
+    double timeMs;
+    InputEventType type;
+    double x;
+    double y;
+};
+
+// the orbit navigation state input is applied to
+struct ViewState
+{
+    float rotationX;
+    float rotationY;
+    float scale;
+};
+
+// Input of one session with the view it started from, times count from the first frame.
+// Stored as text, one statement per line:
+//   extent <width> <height>
+//   view <rotation x> <rotation y> <scale>
+//   button <time> <0 or 1>
+//   cursor <time> <x> <y>
+//   scroll <time> <offset>
+//   end <time>
+struct InputRecording
+{
+    VkExtent2D extent;
+    ViewState initialView;
+    std::vector<InputEventRecord> events;
+    double durationMs;
+};
+
+void writeInputRecording(const InputRecording& recording, const std::string& filename);
+InputRecording loadInputRecording(const std::string& filename);
+
+#endif //VULKAN3DMODELVIEWER_INPUT_RECORDING_HPP
@@ -1,8 +1,17 @@
 #include "application.hpp"
+#include "model/io_benchmark.hpp"
 
 
-int main()
+int main(int argc, char** argv)
 {
-    Application window;
+    Options options = parseOptions(argc, argv);
+
+    if (options.ioBenchmark)
+    {
+        runIoBenchmark(getModelPlacements(options));
+        return 0;
+    }
+
+    Application window(options);
     window.run();
 }
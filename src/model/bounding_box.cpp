@@ -0,0 +1,70 @@
+//
+// Created by Gianni on 19/10/2026.
+//
+
+#include "bounding_box.hpp"
+
+
+BoundingBox transformBoundingBox(const BoundingBox& boundingBox, const glm::mat4& transform)
+{
+    BoundingBox transformed {glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX)};
+
+    for (uint32_t corner = 0; corner < 8; ++corner)
+    {
+        glm::vec3 point {
+            corner & 1? boundingBox.max.x : boundingBox.min.x,
+            corner & 2? boundingBox.max.y : boundingBox.min.y,
+            corner & 4? boundingBox.max.z : boundingBox.min.z
+        };
+
+        point = glm::vec3(transform * glm::vec4(point, 1.f));
+        transformed.min = glm::min(transformed.min, point);
+        transformed.max = glm::max(transformed.max, point);
+    }
+
+    return transformed;
+}
+
+void expandBoundingBox(BoundingBox& boundingBox, const BoundingBox& other)
+{
+    boundingBox.min = glm::min(boundingBox.min, other.min);
+    boundingBox.max = glm::max(boundingBox.max, other.max);
+}
+
+Frustum getFrustum(const glm::mat4& viewProjection)
+{
+    glm::mat4 rows = glm::transpose(viewProjection);
+
+    // clip space depth runs from 0 to w
+    Frustum frustum {{
+        rows[3] + rows[0],
+        rows[3] - rows[0],
+        rows[3] + rows[1],
+        rows[3] - rows[1],
+        rows[2],
+        rows[3] - rows[2]
+    }};
+
+    for (glm::vec4& plane : frustum.planes)
+        plane /= glm::length(glm::vec3(plane));
+
+    return frustum;
+}
+
+bool intersectsFrustum(const Frustum& frustum, const BoundingBox& boundingBox)
+{
+    for (const glm::vec4& plane : frustum.planes)
+    {
+        // the corner furthest along the plane normal
+        glm::vec3 corner {
+            plane.x >= 0.f? boundingBox.max.x : boundingBox.min.x,
+            plane.y >= 0.f? boundingBox.max.y : boundingBox.min.y,
+            plane.z >= 0.f? boundingBox.max.z : boundingBox.min.z
+        };
+
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.f)
+            return false;
+    }
+
+    return true;
+}
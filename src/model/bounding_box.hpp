@@ -0,0 +1,32 @@
+//
+// Created by Gianni on 19/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_BOUNDING_BOX_HPP
+#define VULKAN3DMODELVIEWER_BOUNDING_BOX_HPP
+
+#include <array>
+#include <cfloat>
+#include <glm/glm.hpp>
+
+
+struct BoundingBox
+{
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+// planes as normal and distance, points inside the frustum are on the positive side of all six
+struct Frustum
+{
+    std::array<glm::vec4, 6> planes;
+};
+
+BoundingBox transformBoundingBox(const BoundingBox& boundingBox, const glm::mat4& transform);
+void expandBoundingBox(BoundingBox& boundingBox, const BoundingBox& other);
+
+// planes of the clip volume, in the space viewProjection transforms from
+Frustum getFrustum(const glm::mat4& viewProjection);
+bool intersectsFrustum(const Frustum& frustum, const BoundingBox& boundingBox);
+
+#endif //VULKAN3DMODELVIEWER_BOUNDING_BOX_HPP
@@ -0,0 +1,227 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#include "io_benchmark.hpp"
+
+#include <set>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include "model.hpp"
+
+
+static constexpr uint32_t RUN_COUNT = 3;
+
+enum class ReadMethod
+{
+    Buffered,
+    Mapped,
+    IoUring
+};
+
+struct IoTimes
+{
+    double parseMs;
+    double decodeMs;
+};
+
+static std::vector<uint8_t> readFile(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+
+    if (!file.is_open())
+        return {};
+
+    std::vector<uint8_t> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+
+    return data;
+}
+
+// the textures loadMaterials would load for the file
+static std::vector<std::string> getTexturePaths(const aiScene& scene, const std::string& directory)
+{
+    std::set<std::string> paths;
+
+    for (uint32_t i = 0; i < scene.mNumMaterials; ++i)
+    {
+        for (aiTextureType type : {aiTextureType_DIFFUSE, aiTextureType_SPECULAR, aiTextureType_HEIGHT})
+        {
+            aiString filename;
+
+            if (scene.mMaterials[i]->GetTextureCount(type) && scene.mMaterials[i]->GetTexture(type, 0, &filename) == aiReturn_SUCCESS)
+                paths.insert(directory + filename.C_Str());
+        }
+    }
+
+    return {paths.begin(), paths.end()};
+}
+
+// the model's directory holds the files it references besides the textures, e.g. an OBJ's MTL
+static bool evictFiles(const std::string& filename, const std::vector<std::string>& texturePaths)
+{
+    bool evicted = MappedFile::evictFromPageCache(filename);
+
+    std::error_code error;
+    std::filesystem::path directory = std::filesystem::path(filename).parent_path();
+
+    for (const auto& entry : std::filesystem::directory_iterator(directory.empty()? "." : directory, error))
+        if (entry.is_regular_file(error))
+            MappedFile::evictFromPageCache(entry.path().string());
+
+    for (const std::string& path : texturePaths)
+        MappedFile::evictFromPageCache(path);
+
+    return evicted;
+}
+
+static const char* getReadMethodName(ReadMethod method)
+{
+    switch (method)
+    {
+        case ReadMethod::Buffered: return "buffered";
+        case ReadMethod::Mapped: return "mapped";
+        case ReadMethod::IoUring: return "io_uring";
+        default: return "unknown";
+    }
+}
+
+// the file reader's batches are processed on the calling thread, no decoding overlaps the reads
+static IoTimes loadFiles(const std::string& filename,
+                         const std::vector<std::string>& texturePaths,
+                         ReadMethod method,
+                         JobSystem& jobSystem,
+                         FileReader& fileReader)
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    auto parseStart = Clock::now();
+
+    FileData modelFile;
+    if (method == ReadMethod::IoUring)
+    {
+        jobSystem.wait(fileReader.readFiles({filename}, [&modelFile] (uint32_t, FileData& file) {
+            modelFile = std::move(file);
+        }));
+    }
+
+    Assimp::Importer importer;
+    if (method != ReadMethod::Buffered)
+    {
+        MappedIOSystem* ioSystem = new MappedIOSystem();
+        if (modelFile.read)
+            ioSystem->addFile(filename, modelFile.data, modelFile.size);
+
+        importer.SetIOHandler(ioSystem);
+    }
+
+    importModelFile(importer, filename);
+
+    auto decodeStart = Clock::now();
+
+    if (method == ReadMethod::IoUring)
+    {
+        jobSystem.wait(fileReader.readFiles(texturePaths, [] (uint32_t, FileData& file) {
+            ImageData imageData = decodeImageData(file.data, file.size);
+            freeImageData(imageData);
+        }));
+
+        return {
+            .parseMs = Milliseconds(decodeStart - parseStart).count(),
+            .decodeMs = Milliseconds(Clock::now() - decodeStart).count()
+        };
+    }
+
+    for (const std::string& path : texturePaths)
+    {
+        ImageData imageData;
+
+        if (method == ReadMethod::Mapped)
+        {
+            imageData = loadImageData(path);
+        }
+        else
+        {
+            std::vector<uint8_t> data = readFile(path);
+            imageData = decodeImageData(data.data(), data.size());
+        }
+
+        freeImageData(imageData);
+    }
+
+    auto decodeEnd = Clock::now();
+
+    return {
+        .parseMs = Milliseconds(decodeStart - parseStart).count(),
+        .decodeMs = Milliseconds(decodeEnd - decodeStart).count()
+    };
+}
+
+static void printTimes(const char* label, const IoTimes& times)
+{
+    std::cout << label << " " << times.parseMs + times.decodeMs << " ms (parse "
+              << times.parseMs << " ms, textures " << times.decodeMs << " ms)";
+}
+
+void runIoBenchmark(const std::vector<ModelPlacement>& placements)
+{
+    JobSystem jobSystem(0);
+    FileReader fileReader(jobSystem, true);
+
+    std::vector<ReadMethod> methods {ReadMethod::Buffered, ReadMethod::Mapped};
+    if (fileReader.usesIoUring())
+        methods.push_back(ReadMethod::IoUring);
+
+    std::set<std::string> filenames;
+    for (const ModelPlacement& placement : placements)
+        filenames.insert(placement.filename);
+
+    for (const std::string& filename : filenames)
+    {
+        std::vector<std::string> texturePaths;
+        {
+            Assimp::Importer importer;
+            texturePaths = getTexturePaths(*importModelFile(importer, filename),
+                                           filename.substr(0, filename.find_last_of('/') + 1));
+        }
+
+        for (ReadMethod method : methods)
+        {
+            IoTimes cold {};
+            IoTimes warm {};
+            bool evicted = true;
+
+            for (uint32_t run = 0; run < RUN_COUNT; ++run)
+            {
+                evicted = evictFiles(filename, texturePaths) && evicted;
+
+                IoTimes coldRun = loadFiles(filename, texturePaths, method, jobSystem, fileReader);
+                IoTimes warmRun = loadFiles(filename, texturePaths, method, jobSystem, fileReader);
+
+                cold.parseMs += coldRun.parseMs / RUN_COUNT;
+                cold.decodeMs += coldRun.decodeMs / RUN_COUNT;
+                warm.parseMs += warmRun.parseMs / RUN_COUNT;
+                warm.decodeMs += warmRun.decodeMs / RUN_COUNT;
+            }
+
+            std::cout << filename << ", " << texturePaths.size() << " textures, "
+                      << getReadMethodName(method) << " reads: ";
+
+            // without eviction the cold runs read from the page cache as well
+            if (evicted)
+            {
+                printTimes("cold", cold);
+                std::cout << ", ";
+            }
+
+            printTimes("warm", warm);
+            std::cout << "\n";
+        }
+    }
+
+    std::cout << "Mean of " << RUN_COUNT << " runs each\n";
+}
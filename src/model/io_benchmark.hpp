@@ -0,0 +1,18 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_IO_BENCHMARK_HPP
+#define VULKAN3DMODELVIEWER_IO_BENCHMARK_HPP
+
+#include <vector>
+#include "../scene/scene_description.hpp"
+
+
+// Parses every model of the scene and decodes its textures through buffered reads
+// (assimp's default IO system, whole files read into memory), mapped files and, where
+// available, io_uring batches. Cold runs evict the files from the page cache first, warm
+// runs read them again right after. Nothing is uploaded, so no render device is needed.
+void runIoBenchmark(const std::vector<ModelPlacement>& placements);
+
+#endif //VULKAN3DMODELVIEWER_IO_BENCHMARK_HPP
@@ -0,0 +1,118 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#include "mapped_io_system.hpp"
+
+#include <assimp/MemoryIOWrapper.h>
+
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+
+
+MappedIOStream::MappedIOStream(MappedFile&& file)
+    : mFile(std::move(file))
+    , mPosition()
+{
+}
+
+size_t MappedIOStream::Read(void* pvBuffer, size_t pSize, size_t pCount)
+{
+    if (pSize == 0)
+        return 0;
+
+    // like fread, only whole elements are read
+    size_t count = std::min(pCount, (mFile.size() - mPosition) / pSize);
+
+    if (count > 0)
+    {
+        std::memcpy(pvBuffer, mFile.data() + mPosition, count * pSize);
+        mPosition += count * pSize;
+    }
+
+    return count;
+}
+
+size_t MappedIOStream::Write(const void*, size_t, size_t)
+{
+    return 0;
+}
+
+aiReturn MappedIOStream::Seek(size_t pOffset, aiOrigin pOrigin)
+{
+    size_t position;
+
+    switch (pOrigin)
+    {
+        case aiOrigin_SET: position = pOffset; break;
+        case aiOrigin_CUR: position = mPosition + pOffset; break;
+        case aiOrigin_END: position = mFile.size() - pOffset; break;
+        default: return aiReturn_FAILURE;
+    }
+
+    if (position > mFile.size())
+        return aiReturn_FAILURE;
+
+    mPosition = position;
+
+    return aiReturn_SUCCESS;
+}
+
+size_t MappedIOStream::Tell() const
+{
+    return mPosition;
+}
+
+size_t MappedIOStream::FileSize() const
+{
+    return mFile.size();
+}
+
+void MappedIOStream::Flush()
+{
+}
+
+void MappedIOSystem::addFile(const std::string& filename, const uint8_t* data, size_t size)
+{
+    mFiles.insert_or_assign(filename, FileContents{data, size});
+}
+
+bool MappedIOSystem::Exists(const char* pFile) const
+{
+    if (mFiles.contains(pFile))
+        return true;
+
+    std::error_code error;
+    return std::filesystem::is_regular_file(pFile, error);
+}
+
+char MappedIOSystem::getOsSeparator() const
+{
+#ifdef _WIN32
+    return '\\';
+#else
+    return '/';
+#endif
+}
+
+Assimp::IOStream* MappedIOSystem::Open(const char* pFile, const char* pMode)
+{
+    if (std::strchr(pMode, 'w') || std::strchr(pMode, 'a') || std::strchr(pMode, '+'))
+        return nullptr;
+
+    if (auto it = mFiles.find(pFile); it != mFiles.end())
+        return new Assimp::MemoryIOStream(it->second.data, it->second.size);
+
+    MappedFile file(pFile);
+
+    if (!file.isOpen())
+        return nullptr;
+
+    return new MappedIOStream(std::move(file));
+}
+
+void MappedIOSystem::Close(Assimp::IOStream* pFile)
+{
+    delete pFile;
+}
@@ -0,0 +1,56 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_MAPPED_IO_SYSTEM_HPP
+#define VULKAN3DMODELVIEWER_MAPPED_IO_SYSTEM_HPP
+
+#include <string>
+#include <unordered_map>
+#include <assimp/IOSystem.hpp>
+#include <assimp/IOStream.hpp>
+#include "../utils/mapped_file.hpp"
+
+
+// read-only assimp stream over a mapped file, reads copy straight out of the mapping
+class MappedIOStream : public Assimp::IOStream
+{
+public:
+    explicit MappedIOStream(MappedFile&& file);
+
+    size_t Read(void* pvBuffer, size_t pSize, size_t pCount) override;
+    size_t Write(const void* pvBuffer, size_t pSize, size_t pCount) override;
+    aiReturn Seek(size_t pOffset, aiOrigin pOrigin) override;
+    size_t Tell() const override;
+    size_t FileSize() const override;
+    void Flush() override;
+
+private:
+    MappedFile mFile;
+    size_t mPosition;
+};
+
+// Opens the files assimp reads (the model and files it references, e.g. an OBJ's MTL)
+// as mapped streams instead of buffered stdio streams. Opening for writing fails.
+class MappedIOSystem : public Assimp::IOSystem
+{
+public:
+    // serves the file from memory that was already read, it has to outlive the importer
+    void addFile(const std::string& filename, const uint8_t* data, size_t size);
+
+    bool Exists(const char* pFile) const override;
+    char getOsSeparator() const override;
+    Assimp::IOStream* Open(const char* pFile, const char* pMode = "rb") override;
+    void Close(Assimp::IOStream* pFile) override;
+
+private:
+    struct FileContents
+    {
+        const uint8_t* data;
+        size_t size;
+    };
+
+    std::unordered_map<std::string, FileContents> mFiles;
+};
+
+#endif //VULKAN3DMODELVIEWER_MAPPED_IO_SYSTEM_HPP
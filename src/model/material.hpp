@@ -17,4 +17,28 @@ struct Material
     int hasNormalMap;
 };
 
+// shading features of a material, the shaded pipelines are specialized per combination
+enum MaterialFeature : uint32_t
+{
+    MATERIAL_FEATURE_DIFFUSE_MAP = 1 << 0,
+    MATERIAL_FEATURE_SPECULAR_MAP = 1 << 1,
+    MATERIAL_FEATURE_NORMAL_MAP = 1 << 2
+};
+
+static constexpr uint32_t MATERIAL_PERMUTATION_COUNT = 1 << 3;
+
+inline uint32_t getMaterialFeatures(const Material& material)
+{
+    uint32_t features = 0;
+
+    if (material.hasDiffuseMap)
+        features |= MATERIAL_FEATURE_DIFFUSE_MAP;
+    if (material.hasSpecularMap)
+        features |= MATERIAL_FEATURE_SPECULAR_MAP;
+    if (material.hasNormalMap)
+        features |= MATERIAL_FEATURE_NORMAL_MAP;
+
+    return features;
+}
+
 #endif //VULKAN3DMODELVIEWER_MATERIAL_HPP
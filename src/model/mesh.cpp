@@ -11,11 +11,9 @@ void destroyMesh(Mesh& mesh, VulkanRenderDevice& renderDevice)
     destroyIndexBuffer(renderDevice, mesh.indexBuffer);
 }
 
-void renderMesh(Mesh& mesh, VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout)
+void deferDestroyMesh(Mesh& mesh, VulkanRenderDevice& renderDevice)
 {
-    VkDeviceSize offset = 0;
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &mesh.vertexBuffer.buffer, &offset);
-    vkCmdBindIndexBuffer(commandBuffer, mesh.indexBuffer.buffer.buffer, 0, VK_INDEX_TYPE_UINT32);
-    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uint32_t), &mesh.materialIndex);
-    vkCmdDrawIndexed(commandBuffer, mesh.indexBuffer.count, 1, 0, 0, 0);
-}
\ No newline at end of file
+    deferDestroyBuffer(renderDevice, mesh.vertexBuffer);
+    deferDestroyBuffer(renderDevice, mesh.indexBuffer.buffer);
+    mesh.indexBuffer.count = 0;
+}
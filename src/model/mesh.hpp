@@ -7,19 +7,30 @@
 
 #include <array>
 #include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include "bounding_box.hpp"
 #include "../vk/vulkan_types.hpp"
 #include "../vk/vulkan_functions.hpp"
 
 
+// one copy of a geometry, drawn once per node that references it
 struct Mesh
 {
     VulkanBuffer vertexBuffer;
     IndexBuffer indexBuffer;
     uint32_t materialIndex;
+    BoundingBox bounds;
+    bool blended;
+
+    // range of the model's instance transforms
+    uint32_t firstInstance;
+    uint32_t instanceCount;
+
+    // center of all instances' bounds in model space, used to sort draws by view depth
+    glm::vec3 center;
 };
 
 void destroyMesh(Mesh& mesh, VulkanRenderDevice& renderDevice);
-
-void renderMesh(Mesh& mesh, VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout);
+void deferDestroyMesh(Mesh& mesh, VulkanRenderDevice& renderDevice);
 
 #endif //VULKAN3DMODELVIEWER_MESH_HPP
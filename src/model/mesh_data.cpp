@@ -0,0 +1,145 @@
+//
+// Created by Gianni on 19/10/2026.
+//
+
+#include "mesh_data.hpp"
+
+#include <cstring>
+#include <utility>
+
+
+uint64_t getMeshDataSize(const MeshData& meshData)
+{
+    return meshData.vertices.size() * sizeof(Vertex) + meshData.indices.size() * sizeof(uint32_t);
+}
+
+MeshData convertMesh(aiMesh& mesh)
+{
+    std::vector<Vertex> vertices = getVertices(mesh);
+    BoundingBox bounds = getBoundingBox(vertices);
+
+    return {
+        .hash = hashGeometry(mesh),
+        .vertices = std::move(vertices),
+        .indices = getIndices(mesh),
+        .bounds = bounds
+    };
+}
+
+// FNV-1a over the attributes the vertices and indices are built from
+uint64_t hashGeometry(const aiMesh& mesh)
+{
+    uint64_t hash = 14695981039346656037ull;
+
+    auto hashBytes = [&hash] (const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+    };
+
+    hashBytes(&mesh.mMaterialIndex, sizeof(mesh.mMaterialIndex));
+    hashBytes(&mesh.mNumVertices, sizeof(mesh.mNumVertices));
+    hashBytes(&mesh.mNumFaces, sizeof(mesh.mNumFaces));
+    hashBytes(mesh.mVertices, mesh.mNumVertices * sizeof(aiVector3D));
+
+    if (mesh.HasTextureCoords(0))
+        hashBytes(mesh.mTextureCoords[0], mesh.mNumVertices * sizeof(aiVector3D));
+
+    for (uint32_t i = 0; i < mesh.mNumFaces; ++i)
+        hashBytes(mesh.mFaces[i].mIndices, mesh.mFaces[i].mNumIndices * sizeof(uint32_t));
+
+    return hash;
+}
+
+bool isSameGeometry(const aiMesh& a, const aiMesh& b)
+{
+    if (a.mMaterialIndex != b.mMaterialIndex ||
+        a.mNumVertices != b.mNumVertices ||
+        a.mNumFaces != b.mNumFaces ||
+        a.HasTextureCoords(0) != b.HasTextureCoords(0) ||
+        a.HasNormals() != b.HasNormals())
+        return false;
+
+    size_t vectorBytes = a.mNumVertices * sizeof(aiVector3D);
+
+    if (std::memcmp(a.mVertices, b.mVertices, vectorBytes) != 0)
+        return false;
+
+    if (a.HasNormals() && std::memcmp(a.mNormals, b.mNormals, vectorBytes) != 0)
+        return false;
+
+    if (a.HasTextureCoords(0) && std::memcmp(a.mTextureCoords[0], b.mTextureCoords[0], vectorBytes) != 0)
+        return false;
+
+    for (uint32_t i = 0; i < a.mNumFaces; ++i)
+    {
+        const aiFace& faceA = a.mFaces[i];
+        const aiFace& faceB = b.mFaces[i];
+
+        if (faceA.mNumIndices != faceB.mNumIndices ||
+            std::memcmp(faceA.mIndices, faceB.mIndices, faceA.mNumIndices * sizeof(uint32_t)) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+std::vector<Vertex> getVertices(aiMesh& mesh)
+{
+    size_t vertexCount = mesh.mNumVertices;
+
+    std::vector<Vertex> vertices;
+    vertices.reserve(vertexCount);
+
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        Vertex vertex {};
+
+         vertex.position = *reinterpret_cast<glm::vec3*>(&mesh.mVertices[i]);
+         vertex.normal = *reinterpret_cast<glm::vec3*>(&mesh.mNormals[i]);
+
+        if (mesh.HasTextureCoords(0))
+        {
+            vertex.tangent = *reinterpret_cast<glm::vec3*>(&mesh.mTangents[i]);
+            vertex.bitangent = *reinterpret_cast<glm::vec3*>(&mesh.mBitangents[i]);
+            vertex.texCoords = *reinterpret_cast<glm::vec2*>(&mesh.mTextureCoords[0][i]);
+        }
+
+        vertices.push_back(vertex);
+    }
+
+    return vertices;
+}
+
+BoundingBox getBoundingBox(const std::vector<Vertex>& vertices)
+{
+    BoundingBox boundingBox {glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX)};
+
+    for (const Vertex& vertex : vertices)
+    {
+        boundingBox.min = glm::min(boundingBox.min, vertex.position);
+        boundingBox.max = glm::max(boundingBox.max, vertex.position);
+    }
+
+    return boundingBox;
+}
+
+std::vector<uint32_t> getIndices(aiMesh& mesh)
+{
+    uint32_t faceCount = mesh.mNumFaces;
+    size_t indexCount = faceCount * 3;
+
+    std::vector<uint32_t> indices;
+    indices.reserve(indexCount);
+
+    for (uint32_t i = 0; i < faceCount; ++i)
+    {
+        aiFace& face = mesh.mFaces[i];
+
+        indices.push_back(face.mIndices[0]);
+        indices.push_back(face.mIndices[1]);
+        indices.push_back(face.mIndices[2]);
+    }
+
+    return indices;
+}
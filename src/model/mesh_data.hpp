@@ -0,0 +1,34 @@
+//
+// Created by Gianni on 19/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_MESH_DATA_HPP
+#define VULKAN3DMODELVIEWER_MESH_DATA_HPP
+
+#include <vector>
+#include <cstdint>
+#include <assimp/mesh.h>
+#include "vertex.hpp"
+#include "bounding_box.hpp"
+
+
+// an assimp mesh converted on a worker, uploaded on the main thread
+struct MeshData
+{
+    uint64_t hash;
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    BoundingBox bounds;
+};
+
+MeshData convertMesh(aiMesh& mesh);
+uint64_t getMeshDataSize(const MeshData& meshData);
+
+uint64_t hashGeometry(const aiMesh& mesh);
+bool isSameGeometry(const aiMesh& a, const aiMesh& b);
+
+std::vector<Vertex> getVertices(aiMesh& mesh);
+BoundingBox getBoundingBox(const std::vector<Vertex>& vertices);
+std::vector<uint32_t> getIndices(aiMesh& mesh);
+
+#endif //VULKAN3DMODELVIEWER_MESH_DATA_HPP
@@ -13,8 +13,6 @@ static constexpr uint32_t importFlags {
     aiProcess_GenNormals |
     aiProcess_FlipUVs |
     aiProcess_OptimizeMeshes |
-    aiProcess_OptimizeGraph |
-    aiProcess_PreTransformVertices |
     aiProcess_RemoveRedundantMaterials |
     aiProcess_SortByPType
 };
@@ -31,23 +29,241 @@ static constexpr int removePrimitives {
     aiPrimitiveType_LINE
 };
 
-void createModel(Model& model, VulkanRenderDevice& renderDevice, const std::string& filename)
+std::vector<ModelLoadStats> createModel(Model& model,
+                                        VulkanRenderDevice& renderDevice,
+                                        JobSystem& jobSystem,
+                                        FileReader& fileReader,
+                                        const std::vector<ModelPlacement>& placements)
 {
+    std::vector<ModelLoadStats> loadStats;
+    std::vector<std::string> filenames;
+
+    for (const ModelPlacement& placement : placements)
+        if (!model.loadedPrototypeCache.contains(placement.filename) &&
+            std::find(filenames.begin(), filenames.end(), placement.filename) == filenames.end())
+            filenames.push_back(placement.filename);
+
+    // all model files are read in one batch, the files they reference are read by assimp
+    std::vector<FileData> files(filenames.size());
+    jobSystem.wait(fileReader.readFiles(filenames, [&files] (uint32_t fileIndex, FileData& file) {
+        files.at(fileIndex) = std::move(file);
+    }));
+
+    for (size_t i = 0; i < filenames.size(); ++i)
+    {
+        ModelLoadStats stats {.filename = filenames.at(i)};
+        uint32_t prototypeIndex = loadModelFile(model, renderDevice, jobSystem, fileReader, filenames.at(i), files.at(i), stats);
+
+        model.loadedPrototypeCache.emplace(filenames.at(i), prototypeIndex);
+        loadStats.push_back(stats);
+        files.at(i) = {};
+    }
+
+    for (const ModelPlacement& placement : placements)
+        placeModel(model, model.loadedPrototypeCache.at(placement.filename), placement.transform);
+
+    createMaterialBuffer(model, renderDevice);
+    createInstanceBuffer(model, renderDevice);
+
+    return loadStats;
+}
+
+uint32_t loadModelFile(Model& model,
+                       VulkanRenderDevice& renderDevice,
+                       JobSystem& jobSystem,
+                       FileReader& fileReader,
+                       const std::string& filename,
+                       const FileData& file,
+                       ModelLoadStats& stats)
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    auto loadStart = Clock::now();
+
     model.directory = filename.substr(0, filename.find_last_of('/') + 1);
 
+    MappedIOSystem* ioSystem = new MappedIOSystem();
+    if (file.read)
+        ioSystem->addFile(filename, file.data, file.size);
+
+    // the importer owns the IO system and deletes it
     Assimp::Importer importer;
+    importer.SetIOHandler(ioSystem);
+
+    const aiScene* scene = importModelFile(importer, filename);
+
+    double parseMs = Milliseconds(Clock::now() - loadStart).count();
+    stats.stages.push_back({"parse", parseMs, parseMs, file.size});
+
+    // the file's material indices are offset by the materials loaded before it
+    uint32_t materialOffset = model.materials.size();
+    size_t meshOffset = model.meshes.size();
+    size_t textureOffset = model.textures.size();
+
+    std::vector<std::string> newTextures;
+    loadMaterials(model, *scene, newTextures);
+
+    // texture loading and mesh conversion are independent, both stages run side by side
+    std::vector<ImageData> images(newTextures.size());
+    std::vector<MeshData> meshData(scene->mNumMeshes);
+    LoadStageTime textureStage {.name = "read and decode textures"};
+    LoadStageTime convertStage {.name = "convert meshes"};
+
+    // a few ranges per thread, so uneven meshes still balance out by stealing
+    uint32_t meshGrainSize = std::max(1u, scene->mNumMeshes / ((jobSystem.workerCount() + 1) * 4));
+
+    JobSystem::JobHandle convertJob = scheduleLoadStage(jobSystem, convertStage, scene->mNumMeshes, meshGrainSize,
+        [scene, &meshData] (uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i)
+                meshData.at(i) = convertMesh(*scene->mMeshes[i]);
+        });
+
+    // every texture is decoded on a worker as soon as its read completed
+    auto textureStart = Clock::now();
+    std::atomic<int64_t> decodeTime {};
+    std::atomic<uint64_t> textureBytes {};
+
+    JobSystem::JobHandle readJob = fileReader.readFiles(newTextures, [&images, &decodeTime, &textureBytes] (uint32_t fileIndex, FileData& file) {
+        auto decodeStart = Clock::now();
+
+        if (file.read)
+        {
+            images.at(fileIndex) = decodeImageData(file.data, file.size);
+            textureBytes += file.size;
+        }
+
+        decodeTime += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - decodeStart).count();
+    });
+
+    JobSystem::JobHandle textureJob = jobSystem.schedule([&textureStage, &decodeTime, &textureBytes, textureStart] {
+        textureStage.wallMs = Milliseconds(Clock::now() - textureStart).count();
+        textureStage.cpuMs = static_cast<double>(decodeTime) / 1e6;
+        textureStage.bytes = textureBytes;
+    }, {readJob});
+
+    // both stages write into this frame, a failure in one is rethrown once the other finished too
+    JobSystem::JobHandle loadJob = jobSystem.schedule([] {}, {textureJob, convertJob});
+
+    try
+    {
+        jobSystem.wait(loadJob);
+    }
+    catch (...)
+    {
+        for (ImageData& image : images)
+            freeImageData(image);
+        throw;
+    }
+
+    for (const MeshData& mesh : meshData)
+        convertStage.bytes += getMeshDataSize(mesh);
+
+    stats.stages.push_back(textureStage);
+    stats.stages.push_back(convertStage);
+
+    TextureUploadStats textureUpload {};
+    stats.reducedTextureCount = createTextures(model, renderDevice, newTextures, images, textureUpload);
+    stats.stages.push_back({"upload textures", textureUpload.uploadMs, textureUpload.uploadMs, textureUpload.uploadBytes});
+    stats.stages.push_back({"generate mips", textureUpload.mipGenerationMs, textureUpload.mipGenerationMs, textureUpload.mipBytes});
+
+    auto meshUploadStart = Clock::now();
+
+    // nodes referencing the same mesh become instances of it instead of baked copies
+    std::vector<uint32_t> meshIndices = loadMeshes(model, renderDevice, *scene, meshData, materialOffset);
+    model.meshNodes.resize(model.meshes.size());
+
+    // the first mesh with the same geometry is the one uploaded
+    uint64_t meshUploadBytes = 0;
+    std::unordered_set<uint32_t> uploadedMeshes;
+    for (size_t i = 0; i < meshIndices.size(); ++i)
+        if (uploadedMeshes.insert(meshIndices.at(i)).second)
+            meshUploadBytes += getMeshDataSize(meshData.at(i));
+
+    double meshUploadMs = Milliseconds(Clock::now() - meshUploadStart).count();
+    stats.stages.push_back({"upload meshes", meshUploadMs, meshUploadMs, meshUploadBytes});
+
+    auto nodeStart = Clock::now();
+
+    ModelPrototype prototype {.filename = filename};
+    processNode(prototype, *scene->mRootNode, {}, meshIndices);
+
+    BoundingBox bounds = getPrototypeBounds(model, prototype);
+    glm::vec3 halfExtent = (bounds.max - bounds.min) * 0.5f;
+    float scale = 1.f / std::max({halfExtent.x, halfExtent.y, halfExtent.z, FLT_MIN});
+
+    prototype.normalization = glm::scale(glm::mat4(1.f), glm::vec3(scale)) *
+                              glm::translate(glm::mat4(1.f), -(bounds.min + halfExtent));
+
+    double nodeMs = Milliseconds(Clock::now() - nodeStart).count();
+    stats.stages.push_back({"process nodes", nodeMs, nodeMs, 0});
+
+    model.prototypes.push_back(std::move(prototype));
+
+    stats.loadTimeMs = Milliseconds(Clock::now() - loadStart).count();
+    stats.meshCount = scene->mNumMeshes;
+    stats.uniqueMeshCount = model.meshes.size() - meshOffset;
+    stats.materialCount = scene->mNumMaterials;
+    stats.newTextureCount = model.textures.size() - textureOffset;
+
+    return model.prototypes.size() - 1;
+}
+
+const aiScene* importModelFile(Assimp::Importer& importer, const std::string& filename)
+{
     importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, removeComponents);
     importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, removePrimitives);
-    importer.SetPropertyBool(AI_CONFIG_PP_PTV_NORMALIZE, true);
 
     const aiScene* scene = importer.ReadFile(filename, importFlags);
 
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
         vulkanCheck(static_cast<VkResult>(~VK_SUCCESS), "Failed to load model.");
 
-    loadMaterials(model, renderDevice, *scene);
-    createMaterialBuffer(model, renderDevice);
-    processNode(model, renderDevice, *scene, *scene->mRootNode);
+    return scene;
+}
+
+JobSystem::JobHandle scheduleLoadStage(JobSystem& jobSystem,
+                                       LoadStageTime& stage,
+                                       uint32_t count,
+                                       uint32_t grainSize,
+                                       JobSystem::RangeWork work)
+{
+    using Clock = std::chrono::steady_clock;
+
+    auto stageStart = Clock::now();
+    auto cpuTime = std::make_shared<std::atomic<int64_t>>(0);
+
+    JobSystem::JobHandle ranges = jobSystem.parallelFor(count, grainSize, [work = std::move(work), cpuTime] (uint32_t begin, uint32_t end) {
+        auto rangeStart = Clock::now();
+        work(begin, end);
+        *cpuTime += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - rangeStart).count();
+    });
+
+    // finishes with the last range, so the wall time doesn't include waiting for other stages
+    return jobSystem.schedule([&stage, stageStart, cpuTime] {
+        stage.wallMs = std::chrono::duration<double, std::milli>(Clock::now() - stageStart).count();
+        stage.cpuMs = static_cast<double>(cpuTime->load()) / 1e6;
+    }, {ranges});
+}
+
+void placeModel(Model& model, uint32_t prototypeIndex, const glm::mat4& transform)
+{
+    const ModelPrototype& prototype = model.prototypes.at(prototypeIndex);
+    const SceneGraph& hierarchy = prototype.hierarchy;
+
+    uint32_t placementNode = model.sceneGraph.addNode(prototype.filename, {}, transform * prototype.normalization);
+    uint32_t firstNode = model.sceneGraph.nodeCount();
+
+    // the hierarchy already has parents first, so parent indices just shift
+    for (uint32_t node = 0; node < hierarchy.nodeCount(); ++node)
+    {
+        uint32_t parent = hierarchy.parent(node);
+        uint32_t sceneParent = parent == SceneGraph::NO_PARENT? placementNode : firstNode + parent;
+        uint32_t sceneNode = model.sceneGraph.addNode(hierarchy.name(node), sceneParent, hierarchy.localTransform(node));
+
+        for (uint32_t meshIndex : prototype.nodeMeshes.at(node))
+            model.meshNodes.at(meshIndex).push_back(sceneNode);
+    }
 }
 
 void destroyModel(Model& model, VulkanRenderDevice& renderDevice)
@@ -57,33 +273,28 @@ void destroyModel(Model& model, VulkanRenderDevice& renderDevice)
 
     destroyBuffer(renderDevice, model.materialBuffer);
 
-    for (Mesh& mesh : model.meshes)
-        destroyMesh(mesh, renderDevice);
-}
-
-void renderModel(Model& model,
-                 VulkanRenderDevice& renderDevice,
-                 VkPipelineLayout pipelineLayout,
-                 VkCommandBuffer commandBuffer)
-{
-    for (Mesh& mesh : model.meshes)
+    if (model.instanceCount > 0)
     {
-        renderMesh(mesh, commandBuffer, pipelineLayout);
+        vkUnmapMemory(renderDevice.device, model.instanceBuffer.memory);
+        destroyBuffer(renderDevice, model.instanceBuffer);
     }
+
+    for (Mesh& mesh : model.meshes)
+        destroyMesh(mesh, renderDevice);
 }
 
-void loadMaterials(Model& model, VulkanRenderDevice& renderDevice, const aiScene& scene)
+void loadMaterials(Model& model, const aiScene& scene, std::vector<std::string>& newTextures)
 {
-    model.materials.reserve(scene.mNumMaterials);
+    model.materials.reserve(model.materials.size() + scene.mNumMaterials);
 
     for (uint32_t i = 0; i < scene.mNumMaterials; ++i)
     {
         aiMaterial& aiMaterial = *scene.mMaterials[i];
         Material material {};
 
-        std::optional<size_t> diffuseMapIndex = loadTexture(model, renderDevice, aiMaterial, aiTextureType_DIFFUSE);
-        std::optional<size_t> specularMapIndex = loadTexture(model, renderDevice, aiMaterial, aiTextureType_SPECULAR);
-        std::optional<size_t> normalMapIndex = loadTexture(model, renderDevice, aiMaterial, aiTextureType_HEIGHT);
+        std::optional<size_t> diffuseMapIndex = loadTexture(model, aiMaterial, aiTextureType_DIFFUSE, newTextures);
+        std::optional<size_t> specularMapIndex = loadTexture(model, aiMaterial, aiTextureType_SPECULAR, newTextures);
+        std::optional<size_t> normalMapIndex = loadTexture(model, aiMaterial, aiTextureType_HEIGHT, newTextures);
 
         if (diffuseMapIndex.has_value())
         {
@@ -107,7 +318,7 @@ void loadMaterials(Model& model, VulkanRenderDevice& renderDevice, const aiScene
     }
 }
 
-std::optional<size_t> loadTexture(Model& model, VulkanRenderDevice& renderDevice, const aiMaterial& material, aiTextureType textureType)
+std::optional<size_t> loadTexture(Model& model, const aiMaterial& material, aiTextureType textureType, std::vector<std::string>& newTextures)
 {
     if (!material.GetTextureCount(textureType))
         return {};
@@ -121,15 +332,49 @@ std::optional<size_t> loadTexture(Model& model, VulkanRenderDevice& renderDevice
     if (model.loadedTextureCache.contains(path))
         return model.loadedTextureCache.at(path);
 
-    model.textures.push_back(createTextureWithMips(renderDevice, path));
-
-    size_t textureIndex = model.textures.size() - 1;
+    // the texture is created once all new textures of the file are decoded
+    size_t textureIndex = model.textures.size() + newTextures.size();
 
+    newTextures.push_back(path);
     model.loadedTextureCache.emplace(path, textureIndex);
 
     return textureIndex;
 }
 
+uint32_t createTextures(Model& model,
+                        VulkanRenderDevice& renderDevice,
+                        const std::vector<std::string>& paths,
+                        std::vector<ImageData>& images,
+                        TextureUploadStats& uploadStats)
+{
+    model.textures.reserve(model.textures.size() + images.size());
+    uint32_t reducedCount = 0;
+
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        if (!images.at(i).pixels)
+        {
+            for (ImageData& image : images)
+                freeImageData(image);
+
+            vulkanCheck(static_cast<VkResult>(~VK_SUCCESS), ("Failed to load image data: " + paths.at(i)).c_str());
+        }
+
+        // close to the memory budget a blurrier texture beats a failed load
+        uint32_t droppedMipLevels = getTextureMipLevelsToDrop(renderDevice, images.at(i).width, images.at(i).height);
+        if (droppedMipLevels > 0)
+        {
+            downsampleImageData(images.at(i), droppedMipLevels);
+            ++reducedCount;
+        }
+
+        model.textures.push_back(createTextureWithMips(renderDevice, images.at(i), uploadStats));
+        freeImageData(images.at(i));
+    }
+
+    return reducedCount;
+}
+
 void createMaterialBuffer(Model& model, VulkanRenderDevice& renderDevice)
 {
     VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
@@ -143,78 +388,190 @@ void createMaterialBuffer(Model& model, VulkanRenderDevice& renderDevice)
                                         model.materials.size() * sizeof(Material),
                                         usage,
                                         memoryProperties,
+                                        MemoryCategory::Uniform,
                                         model.materials.data());
 }
 
-void processNode(Model& model, VulkanRenderDevice& renderDevice, const aiScene& scene, aiNode& node)
+std::vector<uint32_t> loadMeshes(Model& model,
+                                 VulkanRenderDevice& renderDevice,
+                                 const aiScene& scene,
+                                 const std::vector<MeshData>& meshData,
+                                 uint32_t materialOffset)
 {
-    for (uint32_t i = 0; i < node.mNumMeshes; ++i)
+    std::vector<uint32_t> meshIndices(scene.mNumMeshes);
+    // hash to the index of the aiMesh that got loaded, the model's mesh index is in meshIndices
+    std::unordered_multimap<uint64_t, uint32_t> geometryCache;
+
+    for (uint32_t i = 0; i < scene.mNumMeshes; ++i)
     {
-        uint32_t meshIndex = node.mMeshes[i];
-        aiMesh& mesh = *scene.mMeshes[meshIndex];
+        const aiMesh& mesh = *scene.mMeshes[i];
+        uint64_t hash = meshData.at(i).hash;
+
+        // the hash only picks candidates, the content is compared before sharing
+        std::optional<uint32_t> duplicate;
+        auto [first, last] = geometryCache.equal_range(hash);
+        for (auto it = first; it != last && !duplicate.has_value(); ++it)
+            if (isSameGeometry(mesh, *scene.mMeshes[it->second]))
+                duplicate = meshIndices.at(it->second);
+
+        if (duplicate.has_value())
+        {
+            meshIndices.at(i) = duplicate.value();
+            continue;
+        }
+
+        processMesh(model, renderDevice, scene, mesh, meshData.at(i), materialOffset);
 
-        processMesh(model, renderDevice, scene, mesh);
+        meshIndices.at(i) = model.meshes.size() - 1;
+        geometryCache.emplace(hash, i);
     }
 
-    for (uint32_t i = 0; i < node.mNumChildren; ++i)
-        processNode(model, renderDevice, scene, *node.mChildren[i]);
+    return meshIndices;
 }
 
-void processMesh(Model& model, VulkanRenderDevice& renderDevice, const aiScene& scene, aiMesh& mesh)
+void processMesh(Model& model,
+                 VulkanRenderDevice& renderDevice,
+                 const aiScene& scene,
+                 const aiMesh& mesh,
+                 const MeshData& meshData,
+                 uint32_t materialOffset)
 {
-    std::vector<Vertex> vertices = getVertices(mesh);
-    std::vector<uint32_t> indices = getIndices(mesh);
+    const std::vector<Vertex>& vertices = meshData.vertices;
+    const std::vector<uint32_t>& indices = meshData.indices;
 
     VulkanBuffer vertexBuffer = createVertexBuffer(renderDevice, vertices.size() * sizeof(Vertex), vertices.data());
     IndexBuffer indexBuffer = createIndexBuffer(renderDevice, indices.size() * sizeof(uint32_t), indices.data());
-    uint32_t materialIndex = mesh.mMaterialIndex;
-
-    model.meshes.emplace_back(vertexBuffer, indexBuffer, materialIndex);
+    uint32_t materialIndex = materialOffset + mesh.mMaterialIndex;
+
+    float opacity = 1.f;
+    scene.mMaterials[mesh.mMaterialIndex]->Get(AI_MATKEY_OPACITY, opacity);
+
+    model.meshes.push_back({
+        .vertexBuffer = vertexBuffer,
+        .indexBuffer = indexBuffer,
+        .materialIndex = materialIndex,
+        .bounds = meshData.bounds,
+        .blended = opacity < 1.f
+    });
 }
 
-std::vector<Vertex> getVertices(aiMesh& mesh)
+void processNode(ModelPrototype& prototype,
+                 const aiNode& node,
+                 std::optional<uint32_t> parentNode,
+                 const std::vector<uint32_t>& meshIndices)
 {
-    size_t vertexCount = mesh.mNumVertices;
+    // assimp matrices are row major
+    glm::mat4 localTransform = glm::transpose(*reinterpret_cast<const glm::mat4*>(&node.mTransformation));
+    uint32_t prototypeNode = prototype.hierarchy.addNode(node.mName.C_Str(), parentNode, localTransform);
+
+    prototype.nodeMeshes.emplace_back();
+    for (uint32_t i = 0; i < node.mNumMeshes; ++i)
+        prototype.nodeMeshes.back().push_back(meshIndices.at(node.mMeshes[i]));
 
-    std::vector<Vertex> vertices;
-    vertices.reserve(vertexCount);
+    for (uint32_t i = 0; i < node.mNumChildren; ++i)
+        processNode(prototype, *node.mChildren[i], prototypeNode, meshIndices);
+}
 
-    for (size_t i = 0; i < vertexCount; ++i)
-    {
-        Vertex vertex {};
+BoundingBox getPrototypeBounds(const Model& model, ModelPrototype& prototype)
+{
+    BoundingBox bounds {glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX)};
 
-         vertex.position = *reinterpret_cast<glm::vec3*>(&mesh.mVertices[i]);
-         vertex.normal = *reinterpret_cast<glm::vec3*>(&mesh.mNormals[i]);
+    prototype.hierarchy.update();
 
-        if (mesh.HasTextureCoords(0))
+    for (uint32_t node = 0; node < prototype.hierarchy.nodeCount(); ++node)
+    {
+        for (uint32_t meshIndex : prototype.nodeMeshes.at(node))
         {
-            vertex.tangent = *reinterpret_cast<glm::vec3*>(&mesh.mTangents[i]);
-            vertex.bitangent = *reinterpret_cast<glm::vec3*>(&mesh.mBitangents[i]);
-            vertex.texCoords = *reinterpret_cast<glm::vec2*>(&mesh.mTextureCoords[0][i]);
+            const glm::mat4& transform = prototype.hierarchy.worldTransform(node);
+            expandBoundingBox(bounds, transformBoundingBox(model.meshes.at(meshIndex).bounds, transform));
         }
+    }
+
+    return bounds;
+}
+
+void createInstanceBuffer(Model& model, VulkanRenderDevice& renderDevice)
+{
+    for (size_t i = 0; i < model.meshes.size(); ++i)
+    {
+        Mesh& mesh = model.meshes.at(i);
+        const std::vector<uint32_t>& nodes = model.meshNodes.at(i);
+
+        mesh.firstInstance = model.instanceNodes.size();
+        mesh.instanceCount = nodes.size();
+        model.instanceNodes.insert(model.instanceNodes.end(), nodes.begin(), nodes.end());
+    }
+
+    model.instanceCount = model.instanceNodes.size();
+    model.instanceVersions = {};
+    model.transformVersion = 0;
 
-        vertices.push_back(vertex);
+    // a scene without mesh nodes draws nothing, and Vulkan has no empty buffers
+    if (model.instanceCount == 0)
+    {
+        model.instanceBuffer = VulkanBuffer();
+        model.instanceData = nullptr;
+        return;
     }
 
-    return vertices;
+    VkMemoryPropertyFlags memoryProperties {
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    };
+
+    model.instanceBuffer = createBuffer(renderDevice,
+                                        model.instanceCount * sizeof(InstanceTransform) * FRAMES_IN_FLIGHT,
+                                        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                        memoryProperties,
+                                        MemoryCategory::Mesh);
+
+    void* dataPtr;
+    VkResult result = vkMapMemory(renderDevice.device, model.instanceBuffer.memory, 0, VK_WHOLE_SIZE, 0, &dataPtr);
+    vulkanCheck(result, "Failed to map instance buffer.");
+
+    model.instanceData = static_cast<InstanceTransform*>(dataPtr);
 }
 
-std::vector<uint32_t> getIndices(aiMesh& mesh)
+void updateModelTransforms(Model& model, uint32_t frameIndex)
 {
-    uint32_t faceCount = mesh.mNumFaces;
-    size_t indexCount = faceCount * 3;
+    if (model.sceneGraph.update())
+    {
+        ++model.transformVersion;
+        updateMeshCenters(model);
+    }
+
+    // the frame's region is no longer read by the GPU once its ticket retired
+    if (model.instanceVersions.at(frameIndex) == model.transformVersion)
+        return;
 
-    std::vector<uint32_t> indices;
-    indices.reserve(indexCount);
+    InstanceTransform* instances = model.instanceData + frameIndex * model.instanceCount;
 
-    for (uint32_t i = 0; i < faceCount; ++i)
+    for (uint32_t i = 0; i < model.instanceCount; ++i)
     {
-        aiFace& face = mesh.mFaces[i];
+        const glm::mat4& transform = model.sceneGraph.worldTransform(model.instanceNodes[i]);
+        instances[i] = {transform, glm::transpose(glm::inverse(glm::mat3(transform)))};
+    }
+
+    model.instanceVersions.at(frameIndex) = model.transformVersion;
+}
 
-        indices.push_back(face.mIndices[0]);
-        indices.push_back(face.mIndices[1]);
-        indices.push_back(face.mIndices[2]);
+void updateMeshCenters(Model& model)
+{
+    for (Mesh& mesh : model.meshes)
+    {
+        BoundingBox instanceBounds {glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX)};
+
+        for (uint32_t i = mesh.firstInstance; i < mesh.firstInstance + mesh.instanceCount; ++i)
+        {
+            const glm::mat4& transform = model.sceneGraph.worldTransform(model.instanceNodes.at(i));
+            expandBoundingBox(instanceBounds, transformBoundingBox(mesh.bounds, transform));
+        }
+
+        mesh.center = (instanceBounds.min + instanceBounds.max) * 0.5f;
     }
+}
 
-    return indices;
+VkDeviceSize getInstanceBufferOffset(const Model& model, uint32_t frameIndex)
+{
+    return static_cast<VkDeviceSize>(frameIndex) * model.instanceCount * sizeof(InstanceTransform);
 }
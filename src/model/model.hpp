@@ -7,44 +7,147 @@
 
 #include <vector>
 #include <string>
+#include <chrono>
+#include <cstring>
 #include <unordered_map>
+#include <unordered_set>
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include "mesh.hpp"
 #include "material.hpp"
 #include "vertex.hpp"
+#include "mesh_data.hpp"
+#include "mapped_io_system.hpp"
+#include "../scene/scene_graph.hpp"
+#include "../scene/scene_description.hpp"
+#include "../utils/job_system.hpp"
+#include "../utils/file_reader.hpp"
 
 
+// node hierarchy of a loaded file, copied into the model's scene graph for every placement
+struct ModelPrototype
+{
+    std::string filename;
+    SceneGraph hierarchy;
+    std::vector<std::vector<uint32_t>> nodeMeshes;
+
+    // fits the file into [-1, 1], the scale pre-transformed vertices used to be normalized to
+    glm::mat4 normalization;
+};
+
+// wall time from scheduling a stage until its last job finished, and the time its jobs ran summed up
+struct LoadStageTime
+{
+    std::string name;
+    double wallMs;
+    double cpuMs;
+    uint64_t bytes;
+};
+
+struct ModelLoadStats
+{
+    std::string filename;
+    double loadTimeMs;
+    uint32_t meshCount;
+    uint32_t uniqueMeshCount;
+    uint32_t materialCount;
+    uint32_t newTextureCount;
+    uint32_t reducedTextureCount;
+    std::vector<LoadStageTime> stages;
+};
+
+// Every file loaded into a model shares its geometry, material and texture pools, so the
+// whole scene draws from one material buffer, one texture table and one instance buffer.
 struct Model
 {
     std::vector<Mesh> meshes;
     std::vector<Material> materials;
     std::vector<VulkanTexture> textures;
     VulkanBuffer materialBuffer;
+
+    std::vector<ModelPrototype> prototypes;
+    std::unordered_map<std::string, uint32_t> loadedPrototypeCache;
+
+    // meshes are instanced once per scene graph node referencing them
+    SceneGraph sceneGraph;
+    std::vector<std::vector<uint32_t>> meshNodes;
+    std::vector<uint32_t> instanceNodes;
+    uint64_t transformVersion;
+
+    // world transforms of all instances, bound as a second vertex buffer. The buffer stays
+    // mapped and has one region per frame in flight, rewritten when the transforms changed.
+    VulkanBuffer instanceBuffer;
+    InstanceTransform* instanceData;
+    uint32_t instanceCount;
+    std::array<uint64_t, FRAMES_IN_FLIGHT> instanceVersions;
+
     std::unordered_map<std::string, size_t> loadedTextureCache;
     std::string directory;
 };
 
-void createModel(Model& model, VulkanRenderDevice& renderDevice, const std::string& filename);
+// loads every file once, places it at each of its transforms and uploads the shared pools
+std::vector<ModelLoadStats> createModel(Model& model,
+                                        VulkanRenderDevice& renderDevice,
+                                        JobSystem& jobSystem,
+                                        FileReader& fileReader,
+                                        const std::vector<ModelPlacement>& placements);
+// textures are decoded and meshes converted on the job system, Vulkan objects are created on the calling thread
+uint32_t loadModelFile(Model& model,
+                       VulkanRenderDevice& renderDevice,
+                       JobSystem& jobSystem,
+                       FileReader& fileReader,
+                       const std::string& filename,
+                       const FileData& file,
+                       ModelLoadStats& stats);
+// reads and post-processes the file with whichever IO system the importer has
+const aiScene* importModelFile(Assimp::Importer& importer, const std::string& filename);
+JobSystem::JobHandle scheduleLoadStage(JobSystem& jobSystem,
+                                       LoadStageTime& stage,
+                                       uint32_t count,
+                                       uint32_t grainSize,
+                                       JobSystem::RangeWork work);
+void placeModel(Model& model, uint32_t prototypeIndex, const glm::mat4& transform);
 void destroyModel(Model& model, VulkanRenderDevice& renderDevice);
 
-void renderModel(Model& model,
-                 VulkanRenderDevice& renderDevice,
-                 VkPipelineLayout pipelineLayout,
-                 VkCommandBuffer commandBuffer);
-
-void loadMaterials(Model& model, VulkanRenderDevice& renderDevice, const aiScene& scene);
-std::optional<size_t> loadTexture(Model& model, VulkanRenderDevice& renderDevice, const aiMaterial& material, aiTextureType textureType);
+// textures not loaded yet get the next free indices and their paths are appended to newTextures
+void loadMaterials(Model& model, const aiScene& scene, std::vector<std::string>& newTextures);
+std::optional<size_t> loadTexture(Model& model, const aiMaterial& material, aiTextureType textureType, std::vector<std::string>& newTextures);
+// returns how many textures lost mip levels to stay within the memory budget
+uint32_t createTextures(Model& model,
+                        VulkanRenderDevice& renderDevice,
+                        const std::vector<std::string>& paths,
+                        std::vector<ImageData>& images,
+                        TextureUploadStats& uploadStats);
 
 void createMaterialBuffer(Model& model, VulkanRenderDevice& renderDevice);
 
-void processNode(Model& model, VulkanRenderDevice& renderDevice, const aiScene& scene, aiNode& node);
-void processMesh(Model& model, VulkanRenderDevice& renderDevice, const aiScene& scene, aiMesh& mesh);
+// returns the model mesh each assimp mesh maps to, identical geometry is loaded once
+std::vector<uint32_t> loadMeshes(Model& model,
+                                 VulkanRenderDevice& renderDevice,
+                                 const aiScene& scene,
+                                 const std::vector<MeshData>& meshData,
+                                 uint32_t materialOffset);
+void processMesh(Model& model,
+                 VulkanRenderDevice& renderDevice,
+                 const aiScene& scene,
+                 const aiMesh& mesh,
+                 const MeshData& meshData,
+                 uint32_t materialOffset);
+
+void processNode(ModelPrototype& prototype,
+                 const aiNode& node,
+                 std::optional<uint32_t> parentNode,
+                 const std::vector<uint32_t>& meshIndices);
+BoundingBox getPrototypeBounds(const Model& model, ModelPrototype& prototype);
+void createInstanceBuffer(Model& model, VulkanRenderDevice& renderDevice);
 
-std::vector<Vertex> getVertices(aiMesh& mesh);
-std::vector<uint32_t> getIndices(aiMesh& mesh);
+// propagates changed node transforms and copies them into the frame's instance region
+void updateModelTransforms(Model& model, uint32_t frameIndex);
+void updateMeshCenters(Model& model);
+VkDeviceSize getInstanceBufferOffset(const Model& model, uint32_t frameIndex);
 
 VulkanTexture getTexture(Model& model,
                          VulkanRenderDevice& renderDevice,
@@ -15,51 +15,15 @@ struct Vertex
     glm::vec3 tangent;
     glm::vec3 bitangent;
     glm::vec2 texCoords;
+};
 
-    static VkVertexInputBindingDescription bindingDescription()
-    {
-        return {
-                .binding = 0,
-                .stride = sizeof(Vertex),
-                .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
-        };
-    }
-
-    static std::vector<VkVertexInputAttributeDescription> attributeDescription()
-    {
-        return {
-            {
-                .location = 0,
-                .binding = 0,
-                .format = VK_FORMAT_R32G32B32_SFLOAT,
-                .offset = offsetof(Vertex, position)
-            },
-            {
-                .location = 1,
-                .binding = 0,
-                .format = VK_FORMAT_R32G32B32_SFLOAT,
-                .offset = offsetof(Vertex, normal)
-            },
-            {
-                .location = 2,
-                .binding = 0,
-                .format = VK_FORMAT_R32G32B32_SFLOAT,
-                .offset = offsetof(Vertex, tangent)
-            },
-            {
-                .location = 3,
-                .binding = 0,
-                .format = VK_FORMAT_R32G32B32_SFLOAT,
-                .offset = offsetof(Vertex, bitangent)
-            },
-            {
-                .location = 4,
-                .binding = 0,
-                .format = VK_FORMAT_R32G32_SFLOAT,
-                .offset = offsetof(Vertex, texCoords)
-            }
-        };
-    }
+// Per-instance model transform, the mat4 attribute takes up locations 5 to 8. The inverse
+// transpose for normals is computed once per instance here instead of per vertex, it takes
+// up locations 9 to 11.
+struct InstanceTransform
+{
+    glm::mat4 transform;
+    glm::mat3 normalTransform;
 };
 
 
@@ -0,0 +1,97 @@
+//
+// Created by Gianni on 19/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_VERTEX_INPUT_HPP
+#define VULKAN3DMODELVIEWER_VERTEX_INPUT_HPP
+
+#include <vector>
+#include <cstddef>
+#include <vulkan/vulkan.h>
+#include "vertex.hpp"
+
+
+// vertex layouts as the pipelines fetch them, kept apart from the structs so the CPU side
+// builds without Vulkan
+inline VkVertexInputBindingDescription getVertexBindingDescription()
+{
+    return {
+            .binding = 0,
+            .stride = sizeof(Vertex),
+            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
+    };
+}
+
+inline std::vector<VkVertexInputAttributeDescription> getVertexAttributeDescriptions()
+{
+    return {
+        {
+            .location = 0,
+            .binding = 0,
+            .format = VK_FORMAT_R32G32B32_SFLOAT,
+            .offset = offsetof(Vertex, position)
+        },
+        {
+            .location = 1,
+            .binding = 0,
+            .format = VK_FORMAT_R32G32B32_SFLOAT,
+            .offset = offsetof(Vertex, normal)
+        },
+        {
+            .location = 2,
+            .binding = 0,
+            .format = VK_FORMAT_R32G32B32_SFLOAT,
+            .offset = offsetof(Vertex, tangent)
+        },
+        {
+            .location = 3,
+            .binding = 0,
+            .format = VK_FORMAT_R32G32B32_SFLOAT,
+            .offset = offsetof(Vertex, bitangent)
+        },
+        {
+            .location = 4,
+            .binding = 0,
+            .format = VK_FORMAT_R32G32_SFLOAT,
+            .offset = offsetof(Vertex, texCoords)
+        }
+    };
+}
+
+inline VkVertexInputBindingDescription getInstanceBindingDescription()
+{
+    return {
+            .binding = 1,
+            .stride = sizeof(InstanceTransform),
+            .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE
+    };
+}
+
+inline std::vector<VkVertexInputAttributeDescription> getInstanceAttributeDescriptions()
+{
+    std::vector<VkVertexInputAttributeDescription> attributes;
+
+    for (uint32_t column = 0; column < 4; ++column)
+    {
+        attributes.push_back({
+            .location = 5 + column,
+            .binding = 1,
+            .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+            .offset = static_cast<uint32_t>(offsetof(InstanceTransform, transform) + column * sizeof(glm::vec4))
+        });
+    }
+
+    for (uint32_t column = 0; column < 3; ++column)
+    {
+        attributes.push_back({
+            .location = 9 + column,
+            .binding = 1,
+            .format = VK_FORMAT_R32G32B32_SFLOAT,
+            .offset = static_cast<uint32_t>(offsetof(InstanceTransform, normalTransform) + column * sizeof(glm::vec3))
+        });
+    }
+
+    return attributes;
+}
+
+#endif //VULKAN3DMODELVIEWER_VERTEX_INPUT_HPP
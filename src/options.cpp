@@ -0,0 +1,135 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#include "options.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+
+static constexpr const char* DEFAULT_MODEL = "../assets/sponza/sponza.obj";
+
+static PresentPolicy parsePresentPolicy(const std::string& value)
+{
+    if (value == "vsync") return PresentPolicy::VSync;
+    if (value == "adaptive") return PresentPolicy::AdaptiveVSync;
+    if (value == "low-latency") return PresentPolicy::LowLatency;
+    if (value == "uncapped") return PresentPolicy::Uncapped;
+
+    throw std::runtime_error("Unknown present policy: " + value);
+}
+
+static AntiAliasing parseAntiAliasing(const std::string& value)
+{
+    if (value == "off") return AntiAliasing::Off;
+    if (value == "msaa2") return AntiAliasing::MSAA2;
+    if (value == "msaa4") return AntiAliasing::MSAA4;
+    if (value == "msaa8") return AntiAliasing::MSAA8;
+    if (value == "fxaa") return AntiAliasing::FXAA;
+
+    throw std::runtime_error("Unknown anti-aliasing mode: " + value);
+}
+
+Options parseOptions(int argc, char** argv)
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        auto nextValue = [&] () -> std::string {
+            if (i + 1 >= argc)
+                throw std::runtime_error("Missing value for option: " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "--continuous")
+            options.renderMode = RenderMode::Continuous;
+        else if (arg == "--on-demand")
+            options.renderMode = RenderMode::OnDemand;
+        else if (arg == "--aa")
+            options.antiAliasing = parseAntiAliasing(nextValue());
+        else if (arg == "--depth-prepass")
+            options.depthPrepass = true;
+        else if (arg == "--present")
+            options.presentPolicy = parsePresentPolicy(nextValue());
+        else if (arg == "--swapchain-images")
+            options.swapchainImageCount = std::stoul(nextValue());
+        else if (arg == "--fps")
+            options.targetFps = std::stod(nextValue());
+        else if (arg == "--frame-stats")
+            options.printFrameStats = true;
+        else if (arg == "--record-threads")
+            options.recordThreadCount = std::stoul(nextValue());
+        else if (arg == "--load-threads")
+            options.loadThreadCount = std::stoul(nextValue());
+        else if (arg == "--no-io-uring")
+            options.ioUring = false;
+        else if (arg == "--scene")
+            options.scenePath = nextValue();
+        else if (arg == "--io-benchmark")
+            options.ioBenchmark = true;
+        else if (arg == "--memory-report")
+            options.memoryReportPath = nextValue();
+        else if (arg == "--startup-report")
+            options.startupReportPath = nextValue();
+        else if (arg == "--record-input")
+            options.recordInputPath = nextValue();
+        else if (arg == "--replay")
+            options.replayPath = nextValue();
+        else if (arg == "--replay-timestep")
+            options.replayTimestepMs = std::stod(nextValue());
+        else if (arg == "--replay-report")
+            options.replayReportPath = nextValue();
+        else if (arg == "--headless")
+            options.headless = true;
+        else if (!arg.starts_with("--"))
+            options.modelPaths.push_back(arg);
+        else
+            throw std::runtime_error("Unknown option: " + arg);
+    }
+
+    if (options.headless && options.replayPath.empty())
+        throw std::runtime_error("--headless needs a recording to --replay");
+
+    if (!options.replayPath.empty() && !options.recordInputPath.empty())
+        throw std::runtime_error("--record-input and --replay can't be combined");
+
+    if (options.replayTimestepMs <= 0.0)
+        throw std::runtime_error("--replay-timestep has to be positive");
+
+    return options;
+}
+
+std::vector<ModelPlacement> getModelPlacements(const Options& options)
+{
+    std::vector<ModelPlacement> placements;
+
+    if (!options.scenePath.empty())
+        placements = loadSceneDescription(options.scenePath);
+
+    for (size_t i = 0; i < options.modelPaths.size(); ++i)
+    {
+        glm::vec3 offset {2.5f * static_cast<float>(i), 0.f, 0.f};
+        placements.push_back({options.modelPaths.at(i), glm::translate(glm::mat4(1.f), offset)});
+    }
+
+    if (placements.empty())
+        placements.push_back({DEFAULT_MODEL, glm::mat4(1.f)});
+
+    return placements;
+}
+
+const char* getAntiAliasingName(AntiAliasing antiAliasing)
+{
+    switch (antiAliasing)
+    {
+        case AntiAliasing::Off: return "off";
+        case AntiAliasing::MSAA2: return "MSAA 2x";
+        case AntiAliasing::MSAA4: return "MSAA 4x";
+        case AntiAliasing::MSAA8: return "MSAA 8x";
+        case AntiAliasing::FXAA: return "FXAA";
+        default: return "unknown";
+    }
+}
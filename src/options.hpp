@@ -0,0 +1,61 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_OPTIONS_HPP
+#define VULKAN3DMODELVIEWER_OPTIONS_HPP
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "vk/vulkan_types.hpp"
+#include "scene/scene_description.hpp"
+
+
+enum class RenderMode
+{
+    Continuous,
+    OnDemand
+};
+
+enum class AntiAliasing
+{
+    Off,
+    MSAA2,
+    MSAA4,
+    MSAA8,
+    FXAA
+};
+
+struct Options
+{
+    RenderMode renderMode = RenderMode::OnDemand;
+    AntiAliasing antiAliasing = AntiAliasing::MSAA4;
+    bool depthPrepass = false;
+    PresentPolicy presentPolicy = PresentPolicy::VSync;
+    uint32_t swapchainImageCount = 3;
+    double targetFps = 0.0;
+    bool printFrameStats = false;
+    uint32_t recordThreadCount = 0; // 0 picks one per hardware thread
+    uint32_t loadThreadCount = 0; // including the main thread, 0 picks one per hardware thread
+    bool ioUring = true; // batch asset reads through io_uring where the kernel allows it
+    std::string scenePath;
+    std::vector<std::string> modelPaths;
+    bool ioBenchmark = false; // compare file reading strategies on the scene's files and exit
+    std::string memoryReportPath; // JSON dump of the memory accounting, written after loading and on exit
+    std::string startupReportPath; // JSON timings of the startup phases, written after the first frame
+    std::string recordInputPath; // window input and the view it started from, written on exit
+    std::string replayPath; // replays a recording at a fixed timestep instead of taking input, then exits
+    double replayTimestepMs = 1000.0 / 60.0;
+    std::string replayReportPath; // per-frame times of the replay, CSV or JSON by extension
+    bool headless = false; // replay without a window, into offscreen images
+};
+
+Options parseOptions(int argc, char** argv);
+
+// scene file models first, models given on the command line are lined up along x
+std::vector<ModelPlacement> getModelPlacements(const Options& options);
+
+const char* getAntiAliasingName(AntiAliasing antiAliasing);
+
+#endif //VULKAN3DMODELVIEWER_OPTIONS_HPP
@@ -0,0 +1,105 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#include "draw_list.hpp"
+
+#include <bit>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+
+static constexpr uint32_t INDEX_BITS = 20;
+static constexpr uint64_t INDEX_MASK = (1ull << INDEX_BITS) - 1;
+static constexpr uint64_t DEPTH_MASK = 0xfffff;
+static constexpr uint64_t MATERIAL_MASK = 0xffff;
+
+void DrawList::clear()
+{
+    mCommands.clear();
+    mKeys.clear();
+}
+
+void DrawList::add(const DrawCommand& command, float viewDepth)
+{
+    if (mCommands.size() == MAX_DRAWS)
+        throw std::runtime_error("Draw list is full.");
+
+    mKeys.push_back(makeKey(command, viewDepth, mCommands.size()));
+    mCommands.push_back(command);
+}
+
+void DrawList::sort()
+{
+    // 44 key bits above the index, 11 bits per pass
+    static constexpr uint32_t PASS_COUNT = (64 - INDEX_BITS) / RADIX_BITS;
+
+    size_t count = mKeys.size();
+    if (count < 2)
+        return;
+
+    mScratchKeys.resize(count);
+
+    // digit counts don't change between passes, so one sweep builds all histograms
+    mHistograms.assign(PASS_COUNT, {});
+
+    for (uint64_t key : mKeys)
+        for (uint32_t pass = 0; pass < PASS_COUNT; ++pass)
+            ++mHistograms[pass][(key >> (INDEX_BITS + pass * RADIX_BITS)) & (RADIX_SIZE - 1)];
+
+    for (uint32_t pass = 0; pass < PASS_COUNT; ++pass)
+    {
+        uint32_t shift = INDEX_BITS + pass * RADIX_BITS;
+        std::array<uint32_t, RADIX_SIZE>& histogram = mHistograms[pass];
+
+        // every key has the same digit, e.g. a single pass or pipeline
+        if (histogram[(mKeys[0] >> shift) & (RADIX_SIZE - 1)] == count)
+            continue;
+
+        uint32_t offset = 0;
+        for (uint32_t& bucket : histogram)
+            offset += std::exchange(bucket, offset);
+
+        for (uint64_t key : mKeys)
+            mScratchKeys[histogram[(key >> shift) & (RADIX_SIZE - 1)]++] = key;
+
+        std::swap(mKeys, mScratchKeys);
+    }
+}
+
+size_t DrawList::size() const
+{
+    return mCommands.size();
+}
+
+const DrawCommand& DrawList::at(size_t index) const
+{
+    return mCommands[mKeys[index] & INDEX_MASK];
+}
+
+uint64_t DrawList::makeKey(const DrawCommand& command, float viewDepth, uint32_t drawIndex)
+{
+    // the bit pattern of a non-negative float grows with its value, dropping the sign
+    // leaves 8 bits of exponent and 12 bits of mantissa
+    uint64_t depth = std::bit_cast<uint32_t>(std::max(viewDepth, 0.f)) >> 11 & DEPTH_MASK;
+    uint64_t material = command.materialIndex & MATERIAL_MASK;
+
+    uint64_t key = static_cast<uint64_t>(command.pass) << 62;
+    key |= static_cast<uint64_t>(command.pipelineIndex & 0x3f) << 56;
+
+    switch (command.pass)
+    {
+        case DrawPass::DepthPrepass:
+            key |= depth << 20;
+            break;
+        case DrawPass::Opaque:
+            key |= material << 40 | depth << 20;
+            break;
+        case DrawPass::Blended:
+            key |= (~depth & DEPTH_MASK) << 36 | material << 20;
+            break;
+    }
+
+    return key | drawIndex;
+}
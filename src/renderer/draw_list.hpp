@@ -0,0 +1,66 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_DRAW_LIST_HPP
+#define VULKAN3DMODELVIEWER_DRAW_LIST_HPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+// passes are recorded in this order
+enum class DrawPass : uint32_t
+{
+    DepthPrepass,
+    Opaque,
+    Blended
+};
+
+struct DrawCommand
+{
+    DrawPass pass;
+    uint32_t pipelineIndex;
+    uint32_t materialIndex;
+    uint32_t meshIndex;
+};
+
+// Collects the draws of one frame and orders them by a 64-bit key:
+//   [63:62] pass, [61:56] pipeline, then
+//   opaque and pre-pass: [55:40] material, [39:20] view depth, front to back
+//   blended:             [55:36] view depth, back to front, [35:20] material
+//   [19:0] index of the draw, carried along so the sort only moves keys
+// Draws with equal state end up next to each other so redundant binds can be skipped,
+// opaque draws of one material still go front to back to help early depth rejection.
+// Depth-only pre-pass draws ignore the material and are sorted by depth alone.
+class DrawList
+{
+public:
+    static constexpr size_t MAX_DRAWS = 1 << 20;
+
+    void clear();
+    void add(const DrawCommand& command, float viewDepth);
+
+    // stable LSD radix sort over the key bits above the draw index
+    void sort();
+
+    size_t size() const;
+
+    // i-th draw in sorted order
+    const DrawCommand& at(size_t index) const;
+
+private:
+    static constexpr uint32_t RADIX_BITS = 11;
+    static constexpr uint32_t RADIX_SIZE = 1 << RADIX_BITS;
+
+    static uint64_t makeKey(const DrawCommand& command, float viewDepth, uint32_t drawIndex);
+
+    std::vector<DrawCommand> mCommands;
+    std::vector<uint64_t> mKeys;
+    std::vector<uint64_t> mScratchKeys;
+    std::vector<std::array<uint32_t, RADIX_SIZE>> mHistograms;
+};
+
+#endif //VULKAN3DMODELVIEWER_DRAW_LIST_HPP
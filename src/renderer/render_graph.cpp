@@ -0,0 +1,815 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#include "render_graph.hpp"
+
+static bool hasStencil(VkFormat format)
+{
+    return format == VK_FORMAT_D16_UNORM_S8_UINT ||
+           format == VK_FORMAT_D24_UNORM_S8_UINT ||
+           format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+}
+
+static bool isDepthFormat(VkFormat format)
+{
+    return format == VK_FORMAT_D16_UNORM ||
+           format == VK_FORMAT_X8_D24_UNORM_PACK32 ||
+           format == VK_FORMAT_D32_SFLOAT ||
+           hasStencil(format);
+}
+
+static VkImageAspectFlags getBarrierAspectMask(VkFormat format)
+{
+    if (hasStencil(format))
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+
+    return isDepthFormat(format)? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+}
+
+// only used for the bandwidth estimates
+static VkDeviceSize getTexelSize(VkFormat format)
+{
+    switch (format)
+    {
+        case VK_FORMAT_D16_UNORM: return 2;
+        case VK_FORMAT_R16G16B16A16_SFLOAT: return 8;
+        case VK_FORMAT_D32_SFLOAT_S8_UINT: return 8;
+        case VK_FORMAT_R32G32B32A32_SFLOAT: return 16;
+        default: return 4;
+    }
+}
+
+static VkDeviceSize getImageBytes(const RenderImageDesc& desc)
+{
+    return static_cast<VkDeviceSize>(desc.extent.width) * desc.extent.height * desc.samples * getTexelSize(desc.format);
+}
+
+static bool hasWriteAccess(VkAccessFlags2 access)
+{
+    static constexpr VkAccessFlags2 writeAccess {
+        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+        VK_ACCESS_2_SHADER_WRITE_BIT |
+        VK_ACCESS_2_TRANSFER_WRITE_BIT
+    };
+
+    return access & writeAccess;
+}
+
+RenderGraph::RenderGraph()
+    : mStats()
+{
+}
+
+RenderResource RenderGraph::createImage(const RenderImageDesc& desc)
+{
+    GraphImage image {};
+    image.desc = desc;
+    image.imported = false;
+    image.finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    mImages.push_back(image);
+    return mImages.size() - 1;
+}
+
+RenderResource RenderGraph::importImage(const RenderImageDesc& desc, VkImageLayout finalLayout)
+{
+    GraphImage image {};
+    image.desc = desc;
+    image.imported = true;
+    image.finalLayout = finalLayout;
+
+    mImages.push_back(image);
+    return mImages.size() - 1;
+}
+
+void RenderGraph::setImportedImage(RenderResource resource, VkImage image, VkImageView imageView)
+{
+    mImages.at(resource).image.image = image;
+    mImages.at(resource).image.imageView = imageView;
+}
+
+uint32_t RenderGraph::addPass(const std::string& name,
+                              std::function<void(VkCommandBuffer)> record,
+                              PassContents contents)
+{
+    GraphPass pass {};
+    pass.name = name;
+    pass.record = std::move(record);
+    pass.contents = contents;
+
+    mPasses.push_back(std::move(pass));
+    return mPasses.size() - 1;
+}
+
+void RenderGraph::setPassScope(uint32_t pass,
+                               std::function<void(VkCommandBuffer)> begin,
+                               std::function<void(VkCommandBuffer)> end)
+{
+    mPasses.at(pass).beginScope = std::move(begin);
+    mPasses.at(pass).endScope = std::move(end);
+}
+
+void RenderGraph::writeColor(uint32_t pass,
+                             RenderResource resource,
+                             std::optional<VkClearColorValue> clearValue,
+                             std::optional<RenderResource> resolveTarget)
+{
+    mPasses.at(pass).colorAttachments.push_back({
+        .resource = resource,
+        .clearValue = clearValue,
+        .resolveTarget = resolveTarget
+    });
+}
+
+void RenderGraph::writeDepth(uint32_t pass, RenderResource resource, std::optional<VkClearDepthStencilValue> clearValue)
+{
+    mPasses.at(pass).depthAttachment = DepthAttachment {
+        .resource = resource,
+        .clearValue = clearValue
+    };
+}
+
+void RenderGraph::readSampled(uint32_t pass, RenderResource resource)
+{
+    mPasses.at(pass).sampledImages.push_back(resource);
+}
+
+void RenderGraph::compile(VulkanRenderDevice& renderDevice)
+{
+    cullPasses();
+    computeLifetimes();
+    chooseAttachmentOps();
+    createImages(renderDevice);
+    aliasMemory(renderDevice);
+    buildBarriers();
+    computeStats(renderDevice);
+}
+
+// Walks the passes backwards starting from the imported images. A pass is kept if it
+// writes something a later kept pass or an imported image still needs.
+void RenderGraph::cullPasses()
+{
+    std::vector<bool> needed(mImages.size());
+    for (size_t i = 0; i < mImages.size(); ++i)
+        needed.at(i) = mImages.at(i).imported;
+
+    for (auto pass = mPasses.rbegin(); pass != mPasses.rend(); ++pass)
+    {
+        bool writesNeeded = false;
+
+        for (const ColorAttachment& attachment : pass->colorAttachments)
+        {
+            writesNeeded |= needed.at(attachment.resource);
+
+            if (attachment.resolveTarget.has_value())
+                writesNeeded |= needed.at(*attachment.resolveTarget);
+        }
+
+        if (pass->depthAttachment.has_value())
+            writesNeeded |= needed.at(pass->depthAttachment->resource);
+
+        pass->culled = !writesNeeded;
+        if (pass->culled)
+            continue;
+
+        // resolve targets and cleared attachments are overwritten, anything else builds
+        // on what earlier passes wrote
+        for (const ColorAttachment& attachment : pass->colorAttachments)
+        {
+            if (attachment.resolveTarget.has_value())
+                needed.at(*attachment.resolveTarget) = false;
+
+            needed.at(attachment.resource) = !attachment.clearValue.has_value();
+        }
+
+        if (pass->depthAttachment.has_value())
+            needed.at(pass->depthAttachment->resource) = !pass->depthAttachment->clearValue.has_value();
+
+        for (RenderResource resource : pass->sampledImages)
+            needed.at(resource) = true;
+    }
+}
+
+void RenderGraph::computeLifetimes()
+{
+    for (uint32_t i = 0; i < mPasses.size(); ++i)
+    {
+        GraphPass& pass = mPasses.at(i);
+        if (pass.culled)
+            continue;
+
+        auto use = [this, i] (RenderResource resource, VkImageUsageFlags usage) {
+            GraphImage& image = mImages.at(resource);
+
+            if (!image.firstPass.has_value())
+                image.firstPass = i;
+
+            image.lastPass = i;
+            image.usage |= usage;
+        };
+
+        for (const ColorAttachment& attachment : pass.colorAttachments)
+        {
+            use(attachment.resource, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+
+            if (attachment.resolveTarget.has_value())
+                use(*attachment.resolveTarget, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+        }
+
+        if (pass.depthAttachment.has_value())
+            use(pass.depthAttachment->resource, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+
+        for (RenderResource resource : pass.sampledImages)
+            use(resource, VK_IMAGE_USAGE_SAMPLED_BIT);
+    }
+}
+
+// whether a kept pass after the given one reads the contents the given pass leaves behind
+bool RenderGraph::isReadAfter(RenderResource resource, uint32_t pass) const
+{
+    for (uint32_t i = pass + 1; i < mPasses.size(); ++i)
+    {
+        const GraphPass& laterPass = mPasses.at(i);
+        if (laterPass.culled)
+            continue;
+
+        if (std::find(laterPass.sampledImages.begin(), laterPass.sampledImages.end(), resource) != laterPass.sampledImages.end())
+            return true;
+
+        for (const ColorAttachment& attachment : laterPass.colorAttachments)
+        {
+            if (attachment.resource == resource)
+                return !attachment.clearValue.has_value();
+
+            if (attachment.resolveTarget == resource)
+                return false;
+        }
+
+        if (laterPass.depthAttachment.has_value() && laterPass.depthAttachment->resource == resource)
+            return !laterPass.depthAttachment->clearValue.has_value();
+    }
+
+    return false;
+}
+
+void RenderGraph::chooseAttachmentOps()
+{
+    std::vector<bool> written(mImages.size());
+
+    for (GraphImage& image : mImages)
+        image.transient = !image.imported && !(image.usage & VK_IMAGE_USAGE_SAMPLED_BIT);
+
+    for (uint32_t i = 0; i < mPasses.size(); ++i)
+    {
+        GraphPass& pass = mPasses.at(i);
+        if (pass.culled)
+            continue;
+
+        for (ColorAttachment& attachment : pass.colorAttachments)
+        {
+            GraphImage& image = mImages.at(attachment.resource);
+
+            if (attachment.clearValue.has_value())
+                attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+            else
+                attachment.loadOp = written.at(attachment.resource)? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+
+            bool stored = image.imported || isReadAfter(attachment.resource, i);
+            attachment.storeOp = stored? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+            image.transient &= !stored;
+            written.at(attachment.resource) = true;
+
+            // resolved data always ends up in memory
+            if (attachment.resolveTarget.has_value())
+            {
+                mImages.at(*attachment.resolveTarget).transient = false;
+                written.at(*attachment.resolveTarget) = true;
+            }
+        }
+
+        if (pass.depthAttachment.has_value())
+        {
+            DepthAttachment& attachment = *pass.depthAttachment;
+            GraphImage& image = mImages.at(attachment.resource);
+
+            if (attachment.clearValue.has_value())
+                attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+            else
+                attachment.loadOp = written.at(attachment.resource)? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+
+            bool stored = image.imported || isReadAfter(attachment.resource, i);
+            attachment.storeOp = stored? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+            image.transient &= !stored;
+            written.at(attachment.resource) = true;
+        }
+    }
+}
+
+void RenderGraph::createImages(VulkanRenderDevice& renderDevice)
+{
+    for (GraphImage& image : mImages)
+    {
+        if (image.imported || !image.firstPass.has_value())
+            continue;
+
+        if (image.transient)
+            image.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+
+        VkImageCreateInfo imageCreateInfo {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .imageType = VK_IMAGE_TYPE_2D,
+            .format = image.desc.format,
+            .extent = {.width = image.desc.extent.width, .height = image.desc.extent.height, .depth = 1},
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = image.desc.samples,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .usage = image.usage,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+        };
+
+        VkResult result = vkCreateImage(renderDevice.device, &imageCreateInfo, nullptr, &image.image.image);
+        vulkanCheck(result, "Failed to create render graph image.");
+
+        vkGetImageMemoryRequirements(renderDevice.device, image.image.image, &image.memoryRequirements);
+    }
+}
+
+// First fit over the images in order of first use. An image can move into a slot once
+// the slot's current occupant is no longer used, transient images prefer lazily
+// allocated memory so they stay in tile memory on tilers.
+void RenderGraph::aliasMemory(VulkanRenderDevice& renderDevice)
+{
+    std::vector<RenderResource> order;
+    for (RenderResource i = 0; i < mImages.size(); ++i)
+    {
+        if (!mImages.at(i).imported && mImages.at(i).firstPass.has_value())
+            order.push_back(i);
+    }
+
+    std::stable_sort(order.begin(), order.end(), [this] (RenderResource a, RenderResource b) {
+        return *mImages.at(a).firstPass < *mImages.at(b).firstPass;
+    });
+
+    for (RenderResource resource : order)
+    {
+        GraphImage& image = mImages.at(resource);
+
+        auto slot = std::find_if(mMemorySlots.begin(), mMemorySlots.end(), [this, &image] (const MemorySlot& slot) {
+            return slot.transient == image.transient &&
+                   (slot.memoryTypeBits & image.memoryRequirements.memoryTypeBits) &&
+                   mImages.at(slot.images.back()).lastPass < *image.firstPass;
+        });
+
+        if (slot == mMemorySlots.end())
+        {
+            mMemorySlots.push_back({
+                .images = {resource},
+                .memoryTypeBits = image.memoryRequirements.memoryTypeBits,
+                .size = image.memoryRequirements.size,
+                .transient = image.transient
+            });
+
+            image.memorySlot = mMemorySlots.size() - 1;
+            continue;
+        }
+
+        slot->images.push_back(resource);
+        slot->memoryTypeBits &= image.memoryRequirements.memoryTypeBits;
+        slot->size = std::max(slot->size, image.memoryRequirements.size);
+        image.memorySlot = static_cast<uint32_t>(std::distance(mMemorySlots.begin(), slot));
+    }
+
+    for (MemorySlot& slot : mMemorySlots)
+    {
+        std::optional<uint32_t> memoryTypeIndex;
+
+        if (slot.transient)
+        {
+            memoryTypeIndex = findSuitableMemoryType(renderDevice,
+                                                     slot.memoryTypeBits,
+                                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+            slot.lazilyAllocated = memoryTypeIndex.has_value();
+        }
+
+        if (!memoryTypeIndex.has_value())
+            memoryTypeIndex = findSuitableMemoryType(renderDevice, slot.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        VkMemoryAllocateInfo memoryAllocateInfo {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .allocationSize = slot.size,
+            .memoryTypeIndex = memoryTypeIndex.value()
+        };
+
+        slot.memory = allocateMemory(renderDevice, memoryAllocateInfo, MemoryCategory::Attachment);
+
+        for (RenderResource resource : slot.images)
+        {
+            GraphImage& image = mImages.at(resource);
+
+            vkBindImageMemory(renderDevice.device, image.image.image, slot.memory, 0);
+
+            VkImageAspectFlags aspectMask = isDepthFormat(image.desc.format)? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+            image.image.imageView = createImageView(renderDevice, image.image.image, image.desc.format, aspectMask, 1);
+            image.image.memory = slot.memory;
+            image.image.lazilyAllocated = slot.lazilyAllocated;
+        }
+    }
+}
+
+// Simulates a frame and records a transition wherever an image changes layout or a
+// write is involved. Consecutive reads in the same layout share one transition.
+void RenderGraph::buildBarriers()
+{
+    struct Access
+    {
+        RenderResource resource;
+        ImageState state;
+    };
+
+    struct FirstUse
+    {
+        uint32_t pass;
+        size_t barrier;
+        RenderResource resource;
+    };
+
+    std::vector<std::optional<ImageState>> current(mImages.size());
+    std::vector<FirstUse> firstUses;
+
+    for (uint32_t i = 0; i < mPasses.size(); ++i)
+    {
+        GraphPass& pass = mPasses.at(i);
+        pass.barriers.clear();
+        pass.barrierImages.clear();
+
+        if (pass.culled)
+            continue;
+
+        std::vector<Access> accesses;
+
+        for (const ColorAttachment& attachment : pass.colorAttachments)
+        {
+            VkAccessFlags2 access = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+            if (attachment.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD)
+                access |= VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT;
+
+            accesses.push_back({attachment.resource, {
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                access
+            }});
+
+            // resolves happen in the color attachment output stage
+            if (attachment.resolveTarget.has_value())
+            {
+                accesses.push_back({*attachment.resolveTarget, {
+                    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                    VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                    VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT
+                }});
+            }
+        }
+
+        if (pass.depthAttachment.has_value())
+        {
+            accesses.push_back({pass.depthAttachment->resource, {
+                VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+            }});
+        }
+
+        for (RenderResource resource : pass.sampledImages)
+        {
+            accesses.push_back({resource, {
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                VK_ACCESS_2_SHADER_SAMPLED_READ_BIT
+            }});
+        }
+
+        for (const Access& access : accesses)
+        {
+            std::optional<ImageState>& state = current.at(access.resource);
+
+            bool readAfterRead {
+                state.has_value() &&
+                state->layout == access.state.layout &&
+                !hasWriteAccess(state->access) &&
+                !hasWriteAccess(access.state.access)
+            };
+
+            // later writers have to wait for every reader
+            if (readAfterRead)
+            {
+                state->stages |= access.state.stages;
+                state->access |= access.state.access;
+                continue;
+            }
+
+            if (!state.has_value())
+                firstUses.push_back({i, pass.barriers.size(), access.resource});
+
+            pass.barriers.push_back({
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+                .srcStageMask = state.has_value()? state->stages : VK_PIPELINE_STAGE_2_NONE,
+                .srcAccessMask = state.has_value()? state->access : VK_ACCESS_2_NONE,
+                .dstStageMask = access.state.stages,
+                .dstAccessMask = access.state.access,
+                .oldLayout = state.has_value()? state->layout : VK_IMAGE_LAYOUT_UNDEFINED,
+                .newLayout = access.state.layout,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .subresourceRange {
+                    .aspectMask = getBarrierAspectMask(mImages.at(access.resource).desc.format),
+                    .baseMipLevel = 0,
+                    .levelCount = 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1
+                }
+            });
+
+            pass.barrierImages.push_back(access.resource);
+            state = access.state;
+        }
+    }
+
+    for (RenderResource i = 0; i < mImages.size(); ++i)
+    {
+        if (current.at(i).has_value())
+            mImages.at(i).lastState = *current.at(i);
+    }
+
+    // Each frame starts by discarding the contents of its images. The previous frame's
+    // last use of the same memory has to finish first, which for aliased images is the
+    // last use of the slot's previous occupant. Imported images become available where
+    // the frame waits for the acquire semaphore.
+    for (const FirstUse& firstUse : firstUses)
+    {
+        VkImageMemoryBarrier2& barrier = mPasses.at(firstUse.pass).barriers.at(firstUse.barrier);
+        const GraphImage& image = mImages.at(firstUse.resource);
+
+        if (image.imported)
+        {
+            barrier.srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+            barrier.srcAccessMask = VK_ACCESS_2_NONE;
+            continue;
+        }
+
+        const std::vector<RenderResource>& slotImages = mMemorySlots.at(*image.memorySlot).images;
+        size_t slotIndex = std::distance(slotImages.begin(), std::find(slotImages.begin(), slotImages.end(), firstUse.resource));
+        const GraphImage& previous = mImages.at(slotImages.at((slotIndex + slotImages.size() - 1) % slotImages.size()));
+
+        barrier.srcStageMask = previous.lastState.stages;
+        barrier.srcAccessMask = previous.lastState.access;
+    }
+
+    mFinalBarriers.clear();
+    mFinalBarrierImages.clear();
+
+    for (RenderResource i = 0; i < mImages.size(); ++i)
+    {
+        const GraphImage& image = mImages.at(i);
+        if (!image.imported || !current.at(i).has_value() || image.finalLayout == current.at(i)->layout)
+            continue;
+
+        mFinalBarriers.push_back({
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .srcStageMask = current.at(i)->stages,
+            .srcAccessMask = current.at(i)->access,
+            .dstStageMask = VK_PIPELINE_STAGE_2_NONE,
+            .dstAccessMask = VK_ACCESS_2_NONE,
+            .oldLayout = current.at(i)->layout,
+            .newLayout = image.finalLayout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .subresourceRange {
+                .aspectMask = getBarrierAspectMask(image.desc.format),
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            }
+        });
+
+        mFinalBarrierImages.push_back(i);
+    }
+}
+
+void RenderGraph::computeStats(VulkanRenderDevice& renderDevice)
+{
+    mStats = {};
+    mStats.passCount = mPasses.size();
+
+    for (const GraphPass& pass : mPasses)
+    {
+        if (pass.culled)
+        {
+            ++mStats.culledPassCount;
+            continue;
+        }
+
+        if (!pass.barriers.empty())
+            ++mStats.barrierBatchCount;
+
+        mStats.imageBarrierCount += pass.barriers.size();
+
+        for (const ColorAttachment& attachment : pass.colorAttachments)
+        {
+            VkDeviceSize bytes = getImageBytes(mImages.at(attachment.resource).desc);
+
+            mStats.writtenBytesPerFrame += bytes;
+            if (attachment.storeOp == VK_ATTACHMENT_STORE_OP_STORE)
+                mStats.storedBytesPerFrame += bytes;
+
+            if (attachment.resolveTarget.has_value())
+            {
+                VkDeviceSize resolveBytes = getImageBytes(mImages.at(*attachment.resolveTarget).desc);
+                mStats.writtenBytesPerFrame += resolveBytes;
+                mStats.storedBytesPerFrame += resolveBytes;
+            }
+        }
+
+        if (pass.depthAttachment.has_value())
+        {
+            VkDeviceSize bytes = getImageBytes(mImages.at(pass.depthAttachment->resource).desc);
+
+            mStats.writtenBytesPerFrame += bytes;
+            if (pass.depthAttachment->storeOp == VK_ATTACHMENT_STORE_OP_STORE)
+                mStats.storedBytesPerFrame += bytes;
+        }
+    }
+
+    if (!mFinalBarriers.empty())
+        ++mStats.barrierBatchCount;
+
+    mStats.imageBarrierCount += mFinalBarriers.size();
+
+    for (const GraphImage& image : mImages)
+    {
+        if (image.memorySlot.has_value())
+            mStats.imageBytes += image.memoryRequirements.size;
+    }
+
+    for (const MemorySlot& slot : mMemorySlots)
+    {
+        mStats.allocatedBytes += slot.size;
+
+        if (slot.lazilyAllocated)
+        {
+            VkDeviceSize committedSize;
+            vkGetDeviceMemoryCommitment(renderDevice.device, slot.memory, &committedSize);
+            mStats.committedBytes += committedSize;
+        }
+        else
+        {
+            mStats.committedBytes += slot.size;
+        }
+    }
+}
+
+void RenderGraph::recordBarriers(VkCommandBuffer commandBuffer,
+                                 std::vector<VkImageMemoryBarrier2>& barriers,
+                                 const std::vector<RenderResource>& barrierImages)
+{
+    if (barriers.empty())
+        return;
+
+    for (size_t i = 0; i < barriers.size(); ++i)
+        barriers.at(i).image = mImages.at(barrierImages.at(i)).image.image;
+
+    VkDependencyInfo dependencyInfo {
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size()),
+        .pImageMemoryBarriers = barriers.data()
+    };
+
+    vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer)
+{
+    std::vector<VkRenderingAttachmentInfo> colorAttachments;
+
+    for (GraphPass& pass : mPasses)
+    {
+        if (pass.culled)
+            continue;
+
+        recordBarriers(commandBuffer, pass.barriers, pass.barrierImages);
+
+        if (pass.beginScope)
+            pass.beginScope(commandBuffer);
+
+        if (pass.colorAttachments.empty() && !pass.depthAttachment.has_value())
+        {
+            pass.record(commandBuffer);
+
+            if (pass.endScope)
+                pass.endScope(commandBuffer);
+            continue;
+        }
+
+        VkExtent2D extent {};
+        colorAttachments.clear();
+
+        for (const ColorAttachment& attachment : pass.colorAttachments)
+        {
+            const GraphImage& image = mImages.at(attachment.resource);
+            bool resolved = attachment.resolveTarget.has_value();
+
+            colorAttachments.push_back({
+                .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+                .imageView = image.image.imageView,
+                .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                .resolveMode = resolved? VK_RESOLVE_MODE_AVERAGE_BIT : VK_RESOLVE_MODE_NONE,
+                .resolveImageView = resolved? mImages.at(*attachment.resolveTarget).image.imageView : VK_NULL_HANDLE,
+                .resolveImageLayout = resolved? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED,
+                .loadOp = attachment.loadOp,
+                .storeOp = attachment.storeOp,
+                .clearValue = {.color = attachment.clearValue.value_or(VkClearColorValue {})}
+            });
+
+            extent = image.desc.extent;
+        }
+
+        VkRenderingAttachmentInfo depthAttachment {};
+
+        if (pass.depthAttachment.has_value())
+        {
+            const GraphImage& image = mImages.at(pass.depthAttachment->resource);
+
+            depthAttachment = {
+                .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+                .imageView = image.image.imageView,
+                .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                .resolveMode = VK_RESOLVE_MODE_NONE,
+                .loadOp = pass.depthAttachment->loadOp,
+                .storeOp = pass.depthAttachment->storeOp,
+                .clearValue = {.depthStencil = pass.depthAttachment->clearValue.value_or(VkClearDepthStencilValue {})}
+            };
+
+            extent = image.desc.extent;
+        }
+
+        VkRenderingInfo renderingInfo {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+            .flags = pass.contents == PassContents::SecondaryCommandBuffers?
+                static_cast<VkRenderingFlags>(VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT) : 0u,
+            .renderArea {
+                .offset = {0, 0},
+                .extent = extent
+            },
+            .layerCount = 1,
+            .colorAttachmentCount = static_cast<uint32_t>(colorAttachments.size()),
+            .pColorAttachments = colorAttachments.data(),
+            .pDepthAttachment = pass.depthAttachment.has_value()? &depthAttachment : nullptr
+        };
+
+        vkCmdBeginRendering(commandBuffer, &renderingInfo);
+        pass.record(commandBuffer);
+        vkCmdEndRendering(commandBuffer);
+
+        if (pass.endScope)
+            pass.endScope(commandBuffer);
+    }
+
+    recordBarriers(commandBuffer, mFinalBarriers, mFinalBarrierImages);
+}
+
+void RenderGraph::destroy(VulkanRenderDevice& renderDevice)
+{
+    for (GraphImage& image : mImages)
+    {
+        if (image.imported)
+            continue;
+
+        vkDestroyImageView(renderDevice.device, image.image.imageView, nullptr);
+        vkDestroyImage(renderDevice.device, image.image.image, nullptr);
+    }
+
+    for (MemorySlot& slot : mMemorySlots)
+        freeMemory(renderDevice, slot.memory);
+
+    mImages.clear();
+    mPasses.clear();
+    mMemorySlots.clear();
+    mFinalBarriers.clear();
+    mFinalBarrierImages.clear();
+}
+
+VkImageView RenderGraph::imageView(RenderResource resource) const
+{
+    return mImages.at(resource).image.imageView;
+}
+
+const RenderGraphStats& RenderGraph::stats() const
+{
+    return mStats;
+}
@@ -0,0 +1,178 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_RENDER_GRAPH_HPP
+#define VULKAN3DMODELVIEWER_RENDER_GRAPH_HPP
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <functional>
+#include <vulkan/vulkan.h>
+#include "../vk/vulkan_types.hpp"
+#include "../vk/vulkan_functions.hpp"
+
+
+using RenderResource = uint32_t;
+
+struct RenderImageDesc
+{
+    std::string name;
+    VkFormat format;
+    VkExtent2D extent;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+};
+
+// how a pass with attachments records its rendering scope. Secondary passes may only
+// execute secondary command buffers that inherit the pass's attachment formats.
+enum class PassContents
+{
+    Inline,
+    SecondaryCommandBuffers
+};
+
+struct RenderGraphStats
+{
+    uint32_t passCount;
+    uint32_t culledPassCount;
+    uint32_t barrierBatchCount;
+    uint32_t imageBarrierCount;
+    VkDeviceSize imageBytes;
+    VkDeviceSize allocatedBytes;
+    VkDeviceSize committedBytes;
+    VkDeviceSize writtenBytesPerFrame;
+    VkDeviceSize storedBytesPerFrame;
+};
+
+// Describes one frame as a list of passes and the images they read and write.
+// compile() culls passes whose results never reach an imported image, derives
+// attachment load/store ops and layout transitions from the declared accesses,
+// and lets transient images with disjoint lifetimes share memory. execute()
+// then records the passes with one barrier batch in front of each of them.
+class RenderGraph
+{
+public:
+    RenderGraph();
+
+    RenderResource createImage(const RenderImageDesc& desc);
+
+    // images owned elsewhere, e.g. the swapchain. They are left in finalLayout.
+    RenderResource importImage(const RenderImageDesc& desc, VkImageLayout finalLayout);
+    void setImportedImage(RenderResource resource, VkImage image, VkImageView imageView);
+
+    // passes with attachments are recorded inside a dynamic rendering scope
+    uint32_t addPass(const std::string& name,
+                     std::function<void(VkCommandBuffer)> record,
+                     PassContents contents = PassContents::Inline);
+    // recorded right before and after the rendering scope, e.g. for queries spanning the pass
+    void setPassScope(uint32_t pass,
+                      std::function<void(VkCommandBuffer)> begin,
+                      std::function<void(VkCommandBuffer)> end);
+    void writeColor(uint32_t pass,
+                    RenderResource resource,
+                    std::optional<VkClearColorValue> clearValue = {},
+                    std::optional<RenderResource> resolveTarget = {});
+    void writeDepth(uint32_t pass,
+                    RenderResource resource,
+                    std::optional<VkClearDepthStencilValue> clearValue = {});
+    void readSampled(uint32_t pass, RenderResource resource);
+
+    void compile(VulkanRenderDevice& renderDevice);
+    void execute(VkCommandBuffer commandBuffer);
+    void destroy(VulkanRenderDevice& renderDevice);
+
+    VkImageView imageView(RenderResource resource) const;
+    const RenderGraphStats& stats() const;
+
+private:
+    struct ImageState
+    {
+        VkImageLayout layout;
+        VkPipelineStageFlags2 stages;
+        VkAccessFlags2 access;
+    };
+
+    struct GraphImage
+    {
+        RenderImageDesc desc;
+        bool imported;
+        VkImageLayout finalLayout;
+        VkImageUsageFlags usage;
+        bool transient;
+        VulkanImage image;
+        VkMemoryRequirements memoryRequirements;
+        std::optional<uint32_t> firstPass;
+        uint32_t lastPass;
+        std::optional<uint32_t> memorySlot;
+        ImageState lastState;
+    };
+
+    struct ColorAttachment
+    {
+        RenderResource resource;
+        std::optional<VkClearColorValue> clearValue;
+        std::optional<RenderResource> resolveTarget;
+        VkAttachmentLoadOp loadOp;
+        VkAttachmentStoreOp storeOp;
+    };
+
+    struct DepthAttachment
+    {
+        RenderResource resource;
+        std::optional<VkClearDepthStencilValue> clearValue;
+        VkAttachmentLoadOp loadOp;
+        VkAttachmentStoreOp storeOp;
+    };
+
+    struct GraphPass
+    {
+        std::string name;
+        std::function<void(VkCommandBuffer)> record;
+        std::function<void(VkCommandBuffer)> beginScope;
+        std::function<void(VkCommandBuffer)> endScope;
+        PassContents contents;
+        std::vector<ColorAttachment> colorAttachments;
+        std::optional<DepthAttachment> depthAttachment;
+        std::vector<RenderResource> sampledImages;
+        bool culled;
+
+        // the image handles are filled in when recording, imported images change every frame
+        std::vector<VkImageMemoryBarrier2> barriers;
+        std::vector<RenderResource> barrierImages;
+    };
+
+    // images sharing one allocation, in the order they are used within the frame
+    struct MemorySlot
+    {
+        std::vector<RenderResource> images;
+        uint32_t memoryTypeBits;
+        VkDeviceSize size;
+        bool transient;
+        bool lazilyAllocated;
+        VkDeviceMemory memory;
+    };
+
+    void cullPasses();
+    void computeLifetimes();
+    void chooseAttachmentOps();
+    void createImages(VulkanRenderDevice& renderDevice);
+    void aliasMemory(VulkanRenderDevice& renderDevice);
+    void buildBarriers();
+    void computeStats(VulkanRenderDevice& renderDevice);
+    void recordBarriers(VkCommandBuffer commandBuffer,
+                        std::vector<VkImageMemoryBarrier2>& barriers,
+                        const std::vector<RenderResource>& barrierImages);
+
+    bool isReadAfter(RenderResource resource, uint32_t pass) const;
+
+    std::vector<GraphImage> mImages;
+    std::vector<GraphPass> mPasses;
+    std::vector<MemorySlot> mMemorySlots;
+    std::vector<VkImageMemoryBarrier2> mFinalBarriers;
+    std::vector<RenderResource> mFinalBarrierImages;
+    RenderGraphStats mStats;
+};
+
+#endif //VULKAN3DMODELVIEWER_RENDER_GRAPH_HPP
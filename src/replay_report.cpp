@@ -0,0 +1,190 @@
+//
+// Created by Gianni on 19/10/2026.
+//
+
+#include "replay_report.hpp"
+
+#include <cmath>
+#include <utility>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include "utils/json.hpp"
+
+
+static FrameTimeSummary getSummary(const std::vector<std::pair<double, uint32_t>>& samples)
+{
+    FrameTimeSummary summary {};
+
+    if (samples.empty())
+        return summary;
+
+    std::vector<double> times;
+    times.reserve(samples.size());
+
+    for (const auto& [timeMs, frame] : samples)
+    {
+        times.push_back(timeMs);
+        summary.meanMs += timeMs;
+
+        if (timeMs >= summary.worstMs)
+        {
+            summary.worstMs = timeMs;
+            summary.worstFrame = frame;
+        }
+    }
+
+    std::sort(times.begin(), times.end());
+
+    auto percentile = [&times] (double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(times.size())));
+        return times.at(std::clamp<size_t>(rank, 1, times.size()) - 1);
+    };
+
+    summary.sampleCount = static_cast<uint32_t>(times.size());
+    summary.meanMs /= static_cast<double>(times.size());
+    summary.p50Ms = percentile(50.0);
+    summary.p95Ms = percentile(95.0);
+    summary.p99Ms = percentile(99.0);
+
+    return summary;
+}
+
+static void printSummary(const char* name, const FrameTimeSummary& summary)
+{
+    std::cout << "    " << name << ": ";
+
+    if (summary.sampleCount == 0)
+    {
+        std::cout << "no samples\n";
+        return;
+    }
+
+    std::cout << "mean " << summary.meanMs << " ms, p50 " << summary.p50Ms << " ms, p95 " << summary.p95Ms
+              << " ms, p99 " << summary.p99Ms << " ms, worst " << summary.worstMs << " ms in frame "
+              << summary.worstFrame << " (" << summary.sampleCount << " frames)\n";
+}
+
+static void writeSummary(std::ofstream& file, const char* name, const FrameTimeSummary& summary)
+{
+    file << "  \"" << name << "\": {\"frames\": " << summary.sampleCount
+         << ", \"meanMs\": " << summary.meanMs
+         << ", \"p50Ms\": " << summary.p50Ms
+         << ", \"p95Ms\": " << summary.p95Ms
+         << ", \"p99Ms\": " << summary.p99Ms
+         << ", \"worstMs\": " << summary.worstMs
+         << ", \"worstFrame\": " << summary.worstFrame << "},\n";
+}
+
+ReplayReport::ReplayReport(std::string recordingName, double timestepMs)
+    : mRecordingName(std::move(recordingName))
+    , mTimestepMs(timestepMs)
+    , mFinalView()
+{
+}
+
+uint32_t ReplayReport::addFrame(double cpuMs)
+{
+    mFrames.push_back({cpuMs, {}});
+    return static_cast<uint32_t>(mFrames.size() - 1);
+}
+
+void ReplayReport::setGpuTime(uint32_t frame, double gpuMs)
+{
+    mFrames.at(frame).gpuMs = gpuMs;
+}
+
+void ReplayReport::setFinalView(const ViewState& view)
+{
+    mFinalView = view;
+}
+
+FrameTimeSummary ReplayReport::cpuSummary() const
+{
+    std::vector<std::pair<double, uint32_t>> samples;
+    samples.reserve(mFrames.size());
+
+    for (uint32_t i = 0; i < mFrames.size(); ++i)
+        samples.emplace_back(mFrames.at(i).cpuMs, i);
+
+    return getSummary(samples);
+}
+
+FrameTimeSummary ReplayReport::gpuSummary() const
+{
+    std::vector<std::pair<double, uint32_t>> samples;
+    samples.reserve(mFrames.size());
+
+    for (uint32_t i = 0; i < mFrames.size(); ++i)
+        if (mFrames.at(i).gpuMs)
+            samples.emplace_back(*mFrames.at(i).gpuMs, i);
+
+    return getSummary(samples);
+}
+
+void ReplayReport::print() const
+{
+    std::cout << "Replay of " << mRecordingName << ": " << mFrames.size() << " frames at a "
+              << mTimestepMs << " ms timestep, final view " << mFinalView.rotationX << ' '
+              << mFinalView.rotationY << ' ' << mFinalView.scale << '\n';
+
+    printSummary("CPU", cpuSummary());
+    printSummary("GPU", gpuSummary());
+}
+
+void ReplayReport::write(const std::string& filename) const
+{
+    std::ofstream file(filename);
+    if (!file.is_open())
+        throw std::runtime_error("Failed to write replay report: " + filename);
+
+    if (filename.ends_with(".csv"))
+        writeCsv(file);
+    else
+        writeJson(file);
+}
+
+void ReplayReport::writeCsv(std::ofstream& file) const
+{
+    file << "frame,cpu_ms,gpu_ms\n";
+
+    for (uint32_t i = 0; i < mFrames.size(); ++i)
+    {
+        const ReplayFrameTime& frame = mFrames.at(i);
+
+        file << i << ',' << frame.cpuMs << ',';
+        if (frame.gpuMs)
+            file << *frame.gpuMs;
+        file << '\n';
+    }
+}
+
+void ReplayReport::writeJson(std::ofstream& file) const
+{
+    file << "{\n  ";
+    writeBuildInfoJson(file);
+    file << ",\n  \"recording\": \"" << escapeJson(mRecordingName) << "\",\n"
+         << "  \"timestepMs\": " << mTimestepMs << ",\n"
+         << "  \"finalView\": {\"rotationX\": " << mFinalView.rotationX
+         << ", \"rotationY\": " << mFinalView.rotationY
+         << ", \"scale\": " << mFinalView.scale << "},\n";
+
+    writeSummary(file, "cpu", cpuSummary());
+    writeSummary(file, "gpu", gpuSummary());
+
+    file << "  \"frames\": [";
+
+    for (uint32_t i = 0; i < mFrames.size(); ++i)
+    {
+        const ReplayFrameTime& frame = mFrames.at(i);
+
+        file << (i > 0? "," : "") << "\n    {\"cpuMs\": " << frame.cpuMs << ", \"gpuMs\": ";
+        if (frame.gpuMs)
+            file << *frame.gpuMs;
+        else
+            file << "null";
+        file << "}";
+    }
+
+    file << "\n  ]\n}\n";
+}
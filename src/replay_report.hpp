@@ -0,0 +1,64 @@
+//
+// Created by Gianni on 19/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_REPLAY_REPORT_HPP
+#define VULKAN3DMODELVIEWER_REPLAY_REPORT_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include "input_recording.hpp"
+
+
+struct ReplayFrameTime
+{
+    double cpuMs;
+    std::optional<double> gpuMs;
+};
+
+// nearest rank percentiles over the frames that have a sample
+struct FrameTimeSummary
+{
+    uint32_t sampleCount;
+    double meanMs;
+    double p50Ms;
+    double p95Ms;
+    double p99Ms;
+    double worstMs;
+    uint32_t worstFrame;
+};
+
+// Frame times of one replay. CPU time is the host time of renderFrame, including the wait
+// for the frame in flight to retire. GPU time arrives frames later, once the frame's
+// timestamps can be read.
+class ReplayReport
+{
+public:
+    ReplayReport(std::string recordingName, double timestepMs);
+
+    uint32_t addFrame(double cpuMs);
+    void setGpuTime(uint32_t frame, double gpuMs);
+    void setFinalView(const ViewState& view);
+
+    FrameTimeSummary cpuSummary() const;
+    FrameTimeSummary gpuSummary() const;
+
+    void print() const;
+
+    // CSV with one row per frame, or JSON with the summaries and the frames otherwise
+    void write(const std::string& filename) const;
+
+private:
+    void writeCsv(std::ofstream& file) const;
+    void writeJson(std::ofstream& file) const;
+
+    std::string mRecordingName;
+    double mTimestepMs;
+    std::vector<ReplayFrameTime> mFrames;
+    ViewState mFinalView;
+};
+
+#endif //VULKAN3DMODELVIEWER_REPLAY_REPORT_HPP
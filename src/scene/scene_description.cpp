@@ -0,0 +1,94 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#include "scene_description.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <glm/gtc/matrix_transform.hpp>
+
+
+static glm::mat4 parseInstanceTransform(std::istringstream& line)
+{
+    glm::vec3 translation {};
+    glm::vec3 rotation {};
+    float scale = 1.f;
+
+    if (!(line >> translation.x >> translation.y >> translation.z))
+        throw std::runtime_error("Instance is missing its position.");
+
+    // rotation and scale are optional, a partially given rotation is an error
+    if (line >> rotation.x && !(line >> rotation.y >> rotation.z))
+        throw std::runtime_error("Instance rotation needs three angles.");
+
+    line >> scale;
+
+    glm::mat4 transform = glm::translate(glm::mat4(1.f), translation);
+    transform = glm::rotate(transform, glm::radians(rotation.z), glm::vec3(0.f, 0.f, 1.f));
+    transform = glm::rotate(transform, glm::radians(rotation.y), glm::vec3(0.f, 1.f, 0.f));
+    transform = glm::rotate(transform, glm::radians(rotation.x), glm::vec3(1.f, 0.f, 0.f));
+
+    return glm::scale(transform, glm::vec3(scale));
+}
+
+std::vector<ModelPlacement> loadSceneDescription(const std::string& filename)
+{
+    std::ifstream file(filename);
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open scene file: " + filename);
+
+    std::string directory = filename.substr(0, filename.find_last_of('/') + 1);
+
+    std::vector<ModelPlacement> placements;
+    std::string currentModel;
+    bool currentModelPlaced = true;
+
+    std::string text;
+    for (uint32_t lineNumber = 1; std::getline(file, text); ++lineNumber)
+    {
+        std::istringstream line(text.substr(0, text.find('#')));
+
+        std::string statement;
+        if (!(line >> statement))
+            continue;
+
+        try
+        {
+            if (statement == "model")
+            {
+                if (!currentModelPlaced)
+                    placements.push_back({currentModel, glm::mat4(1.f)});
+
+                std::string path;
+                if (!(line >> path))
+                    throw std::runtime_error("Model is missing its path.");
+
+                currentModel = path.starts_with('/')? path : directory + path;
+                currentModelPlaced = false;
+            }
+            else if (statement == "instance")
+            {
+                if (currentModel.empty())
+                    throw std::runtime_error("Instance before any model.");
+
+                placements.push_back({currentModel, parseInstanceTransform(line)});
+                currentModelPlaced = true;
+            }
+            else
+            {
+                throw std::runtime_error("Unknown statement: " + statement);
+            }
+        }
+        catch (const std::runtime_error& error)
+        {
+            throw std::runtime_error(filename + ":" + std::to_string(lineNumber) + ": " + error.what());
+        }
+    }
+
+    if (!currentModelPlaced)
+        placements.push_back({currentModel, glm::mat4(1.f)});
+
+    return placements;
+}
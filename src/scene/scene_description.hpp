@@ -0,0 +1,27 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_SCENE_DESCRIPTION_HPP
+#define VULKAN3DMODELVIEWER_SCENE_DESCRIPTION_HPP
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+
+struct ModelPlacement
+{
+    std::string filename;
+    glm::mat4 transform;
+};
+
+// Text file listing models and where to place them, one statement per line:
+//   model <path>
+//   instance <x> <y> <z> [<rotation x> <rotation y> <rotation z> [<scale>]]
+// Instances place the preceding model, rotations are in degrees. A model without
+// instance lines is placed once at the origin. Paths are relative to the scene
+// file and '#' starts a comment.
+std::vector<ModelPlacement> loadSceneDescription(const std::string& filename);
+
+#endif //VULKAN3DMODELVIEWER_SCENE_DESCRIPTION_HPP
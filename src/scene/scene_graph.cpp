@@ -0,0 +1,131 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#include "scene_graph.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define SCENE_GRAPH_SSE
+#endif
+
+
+// result = a * b for column major matrices. Each result column is a's columns
+// weighted by the matching column of b, four lanes at a time.
+static void multiplyMatrices(const glm::mat4& a, const glm::mat4& b, glm::mat4& result)
+{
+#ifdef SCENE_GRAPH_SSE
+    __m128 a0 = _mm_loadu_ps(&a[0][0]);
+    __m128 a1 = _mm_loadu_ps(&a[1][0]);
+    __m128 a2 = _mm_loadu_ps(&a[2][0]);
+    __m128 a3 = _mm_loadu_ps(&a[3][0]);
+
+    for (int column = 0; column < 4; ++column)
+    {
+        __m128 b0 = _mm_set1_ps(b[column][0]);
+        __m128 b1 = _mm_set1_ps(b[column][1]);
+        __m128 b2 = _mm_set1_ps(b[column][2]);
+        __m128 b3 = _mm_set1_ps(b[column][3]);
+
+        __m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, b0), _mm_mul_ps(a1, b1)),
+                                _mm_add_ps(_mm_mul_ps(a2, b2), _mm_mul_ps(a3, b3)));
+
+        _mm_storeu_ps(&result[column][0], sum);
+    }
+#else
+    result = a * b;
+#endif
+}
+
+SceneGraph::SceneGraph()
+    : mAnyDirty()
+    , mLastUpdateCount()
+{
+}
+
+uint32_t SceneGraph::addNode(const std::string& name, std::optional<uint32_t> parent, const glm::mat4& localTransform)
+{
+    if (parent.has_value() && parent.value() >= mParents.size())
+        throw std::runtime_error("Scene graph parent has to be added before its children.");
+
+    mNames.push_back(name);
+    mParents.push_back(parent.value_or(NO_PARENT));
+    mLocalTransforms.push_back(localTransform);
+    mWorldTransforms.push_back(glm::mat4(1.f));
+    mDirty.push_back(1);
+    mAnyDirty = true;
+
+    return mParents.size() - 1;
+}
+
+void SceneGraph::setLocalTransform(uint32_t node, const glm::mat4& localTransform)
+{
+    mLocalTransforms.at(node) = localTransform;
+    mDirty.at(node) = 1;
+    mAnyDirty = true;
+}
+
+bool SceneGraph::update()
+{
+    mLastUpdateCount = 0;
+
+    if (!mAnyDirty)
+        return false;
+
+    for (uint32_t node = 0; node < mParents.size(); ++node)
+    {
+        uint32_t parent = mParents[node];
+
+        // parents are updated first, so a changed parent's flag is already set here
+        if (parent != NO_PARENT)
+            mDirty[node] |= mDirty[parent];
+
+        if (!mDirty[node])
+            continue;
+
+        if (parent == NO_PARENT)
+            mWorldTransforms[node] = mLocalTransforms[node];
+        else
+            multiplyMatrices(mWorldTransforms[parent], mLocalTransforms[node], mWorldTransforms[node]);
+
+        ++mLastUpdateCount;
+    }
+
+    std::fill(mDirty.begin(), mDirty.end(), 0);
+    mAnyDirty = false;
+
+    return true;
+}
+
+uint32_t SceneGraph::nodeCount() const
+{
+    return mParents.size();
+}
+
+uint32_t SceneGraph::parent(uint32_t node) const
+{
+    return mParents.at(node);
+}
+
+const std::string& SceneGraph::name(uint32_t node) const
+{
+    return mNames.at(node);
+}
+
+const glm::mat4& SceneGraph::localTransform(uint32_t node) const
+{
+    return mLocalTransforms.at(node);
+}
+
+const glm::mat4& SceneGraph::worldTransform(uint32_t node) const
+{
+    return mWorldTransforms.at(node);
+}
+
+uint32_t SceneGraph::lastUpdateCount() const
+{
+    return mLastUpdateCount;
+}
@@ -0,0 +1,53 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_SCENE_GRAPH_HPP
+#define VULKAN3DMODELVIEWER_SCENE_GRAPH_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <optional>
+#include <glm/glm.hpp>
+
+
+// Transform hierarchy with one array per node attribute. Nodes are stored so every
+// parent comes before its children (e.g. in depth-first order), which lets update()
+// recompute world transforms in a single forward pass: a node is recomputed when it
+// or its parent changed, so only dirty subtrees are touched.
+class SceneGraph
+{
+public:
+    static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+    SceneGraph();
+
+    // the parent has to be added before its children
+    uint32_t addNode(const std::string& name, std::optional<uint32_t> parent, const glm::mat4& localTransform);
+
+    void setLocalTransform(uint32_t node, const glm::mat4& localTransform);
+
+    // returns whether any world transform changed
+    bool update();
+
+    uint32_t nodeCount() const;
+    uint32_t parent(uint32_t node) const;
+    const std::string& name(uint32_t node) const;
+    const glm::mat4& localTransform(uint32_t node) const;
+    const glm::mat4& worldTransform(uint32_t node) const;
+
+    // world transforms recomputed by the last update
+    uint32_t lastUpdateCount() const;
+
+private:
+    std::vector<std::string> mNames;
+    std::vector<uint32_t> mParents;
+    std::vector<glm::mat4> mLocalTransforms;
+    std::vector<glm::mat4> mWorldTransforms;
+    std::vector<uint8_t> mDirty;
+    bool mAnyDirty;
+    uint32_t mLastUpdateCount;
+};
+
+#endif //VULKAN3DMODELVIEWER_SCENE_GRAPH_HPP
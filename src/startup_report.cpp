@@ -0,0 +1,98 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#include "startup_report.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include "utils/json.hpp"
+
+
+static constexpr double MB = 1024.0 * 1024.0;
+
+// bytes per millisecond to megabytes per second
+static double getThroughput(uint64_t bytes, double wallMs)
+{
+    if (bytes == 0 || wallMs <= 0.0)
+        return 0.0;
+
+    return static_cast<double>(bytes) / MB / (wallMs / 1000.0);
+}
+
+StartupReport::StartupReport()
+    : mStart(Clock::now())
+    , mDepth()
+{
+}
+
+void StartupReport::measure(const std::string& name, const std::function<void()>& work)
+{
+    // the slot is taken up front, so phases added by the work end up behind it
+    size_t index = mPhases.size();
+    mPhases.push_back({name, mDepth, 0.0, 0.0, 0});
+
+    auto phaseStart = Clock::now();
+
+    ++mDepth;
+    work();
+    --mDepth;
+
+    double wallMs = std::chrono::duration<double, std::milli>(Clock::now() - phaseStart).count();
+    mPhases.at(index).wallMs = wallMs;
+    mPhases.at(index).cpuMs = wallMs;
+}
+
+void StartupReport::addPhase(const std::string& name, double wallMs, double cpuMs, uint64_t bytes, uint32_t nesting)
+{
+    mPhases.push_back({name, mDepth + nesting, wallMs, cpuMs, bytes});
+}
+
+double StartupReport::elapsedMs() const
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - mStart).count();
+}
+
+void StartupReport::print() const
+{
+    std::cout << "Startup: " << elapsedMs() << " ms\n";
+
+    for (const StartupPhase& phase : mPhases)
+    {
+        std::cout << std::string(4 + phase.depth * 4, ' ') << phase.name << ": " << phase.wallMs << " ms";
+
+        if (phase.cpuMs != phase.wallMs)
+            std::cout << " wall, " << phase.cpuMs << " ms cpu";
+
+        if (phase.bytes > 0)
+            std::cout << ", " << phase.bytes / MB << " MB at " << getThroughput(phase.bytes, phase.wallMs) << " MB/s";
+
+        std::cout << '\n';
+    }
+}
+
+void StartupReport::writeJson(const std::string& filename) const
+{
+    std::ofstream file(filename);
+    if (!file.is_open())
+        throw std::runtime_error("Failed to write startup report: " + filename);
+
+    file << "{\n  ";
+    writeBuildInfoJson(file);
+    file << ",\n  \"totalMs\": " << elapsedMs() << ",\n  \"phases\": [";
+
+    for (size_t i = 0; i < mPhases.size(); ++i)
+    {
+        const StartupPhase& phase = mPhases.at(i);
+
+        file << (i > 0? "," : "") << "\n    {\"name\": \"" << escapeJson(phase.name)
+             << "\", \"depth\": " << phase.depth
+             << ", \"wallMs\": " << phase.wallMs
+             << ", \"cpuMs\": " << phase.cpuMs
+             << ", \"bytes\": " << phase.bytes
+             << ", \"mbPerSecond\": " << getThroughput(phase.bytes, phase.wallMs) << "}";
+    }
+
+    file << "\n  ]\n}\n";
+}
@@ -0,0 +1,53 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_STARTUP_REPORT_HPP
+#define VULKAN3DMODELVIEWER_STARTUP_REPORT_HPP
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+
+struct StartupPhase
+{
+    std::string name;
+    uint32_t depth;
+    double wallMs;
+    // summed over the threads working on the phase, equal to the wall time on the main thread
+    double cpuMs;
+    uint64_t bytes;
+};
+
+// Timings of the startup phases with the bytes each one processed. Phases measured
+// while another one runs are nested below it, phases keep the order they started in.
+class StartupReport
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    StartupReport();
+
+    void measure(const std::string& name, const std::function<void()>& work);
+
+    // a phase timed elsewhere, nested below the running phase plus nesting levels
+    void addPhase(const std::string& name, double wallMs, double cpuMs, uint64_t bytes, uint32_t nesting = 0);
+
+    // time since the report was created
+    double elapsedMs() const;
+
+    void print() const;
+
+    // one object per phase, e.g. to compare startups across model versions and builds
+    void writeJson(const std::string& filename) const;
+
+private:
+    Clock::time_point mStart;
+    std::vector<StartupPhase> mPhases;
+    uint32_t mDepth;
+};
+
+#endif //VULKAN3DMODELVIEWER_STARTUP_REPORT_HPP
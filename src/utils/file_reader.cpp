@@ -0,0 +1,457 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#include "file_reader.hpp"
+
+#include <new>
+#include <atomic>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+
+static constexpr uint32_t QUEUE_DEPTH = 64;
+static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+// O_DIRECT skips the page cache copy but also the cache itself, so reloading a file
+// always goes to storage. Only files large enough for the copy to matter bypass it.
+static constexpr size_t DIRECT_IO_MIN_SIZE = 4 * 1024 * 1024;
+
+static size_t alignUp(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+// padded to the alignment, O_DIRECT reads whole blocks even at the end of the file
+static std::shared_ptr<uint8_t> allocateReadBuffer(size_t size)
+{
+    size_t bufferSize = alignUp(std::max<size_t>(size, 1), DIRECT_IO_ALIGNMENT);
+    void* buffer = ::operator new(bufferSize, std::align_val_t(DIRECT_IO_ALIGNMENT));
+
+    return std::shared_ptr<uint8_t>(static_cast<uint8_t*>(buffer), [] (uint8_t* buffer) {
+        ::operator delete(buffer, std::align_val_t(DIRECT_IO_ALIGNMENT));
+    });
+}
+
+#ifdef __linux__
+
+// the submission and completion rings shared with the kernel, set up with the raw syscalls
+struct FileReader::IoUring
+{
+    int fd = -1;
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    size_t sqRingSize = 0;
+    size_t cqRingSize = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqesSize = 0;
+
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqMask = 0;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    bool setup(uint32_t entries);
+    ~IoUring();
+
+    void queueRead(int file, const iovec* buffer, size_t offset, uint64_t userData);
+    int submit(uint32_t submitCount, uint32_t waitCount);
+};
+
+bool FileReader::IoUring::setup(uint32_t entries)
+{
+    io_uring_params params {};
+
+    fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0)
+        return false;
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    bool singleMapping = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMapping)
+        sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+    sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED)
+        return false;
+
+    if (!singleMapping)
+    {
+        cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED)
+            return false;
+    }
+
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+    if (sqes == MAP_FAILED)
+        return false;
+
+    uint8_t* sq = static_cast<uint8_t*>(sqRing);
+    uint8_t* cq = static_cast<uint8_t*>(singleMapping? sqRing : cqRing);
+
+    sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    return true;
+}
+
+FileReader::IoUring::~IoUring()
+{
+    if (sqes != MAP_FAILED)
+        munmap(sqes, sqesSize);
+    if (cqRing != MAP_FAILED)
+        munmap(cqRing, cqRingSize);
+    if (sqRing != MAP_FAILED)
+        munmap(sqRing, sqRingSize);
+    if (fd >= 0)
+        close(fd);
+}
+
+// IORING_OP_READ would need 5.6, vectored reads work since 5.1
+void FileReader::IoUring::queueRead(int file, const iovec* buffer, size_t offset, uint64_t userData)
+{
+    unsigned tail = *sqTail;
+    unsigned index = tail & sqMask;
+
+    io_uring_sqe& sqe = sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_READV;
+    sqe.fd = file;
+    sqe.off = offset;
+    sqe.addr = reinterpret_cast<uint64_t>(buffer);
+    sqe.len = 1;
+    sqe.user_data = userData;
+
+    sqArray[index] = index;
+    std::atomic_ref<unsigned>(*sqTail).store(tail + 1, std::memory_order_release);
+}
+
+int FileReader::IoUring::submit(uint32_t submitCount, uint32_t waitCount)
+{
+    int result;
+
+    do
+    {
+        result = static_cast<int>(syscall(__NR_io_uring_enter, fd, submitCount, waitCount, IORING_ENTER_GETEVENTS, nullptr, 0));
+    }
+    while (result < 0 && errno == EINTR);
+
+    if (result < 0 && errno != EAGAIN && errno != EBUSY)
+        throw std::runtime_error("io_uring_enter failed: " + std::string(std::strerror(errno)));
+
+    return std::max(result, 0);
+}
+
+#else
+
+struct FileReader::IoUring
+{
+};
+
+#endif
+
+FileReader::FileReader(JobSystem& jobSystem, bool allowIoUring)
+    : mJobSystem(jobSystem)
+{
+#ifdef __linux__
+    // unavailable on old kernels and often blocked in containers
+    auto ioUring = std::make_unique<IoUring>();
+
+    if (allowIoUring && ioUring->setup(QUEUE_DEPTH))
+        mIoUring = std::move(ioUring);
+#endif
+}
+
+FileReader::~FileReader() = default;
+
+bool FileReader::usesIoUring() const
+{
+    return mIoUring != nullptr;
+}
+
+JobSystem::JobHandle FileReader::readFiles(const std::vector<std::string>& paths, ProcessFile process)
+{
+    if (mIoUring)
+        return readFilesIoUring(paths, std::move(process));
+
+    return readFilesMapped(paths, std::move(process));
+}
+
+JobSystem::JobHandle FileReader::readFilesMapped(const std::vector<std::string>& paths, ProcessFile process)
+{
+    return mJobSystem.parallelFor(paths.size(), 1, [paths, process = std::move(process)] (uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            FileData file;
+            file.mapping = MappedFile(paths.at(i));
+            file.data = file.mapping.data();
+            file.size = file.mapping.size();
+            file.read = file.mapping.isOpen();
+
+            process(i, file);
+        }
+    });
+}
+
+#ifdef __linux__
+
+JobSystem::JobHandle FileReader::readFilesIoUring(const std::vector<std::string>& paths, ProcessFile process)
+{
+    struct PendingRead
+    {
+        uint32_t fileIndex;
+        int fd;
+        bool direct;
+        size_t offset;
+        std::shared_ptr<FileData> file;
+
+        // read by the kernel when the entry is submitted
+        iovec buffer;
+    };
+
+    auto sharedProcess = std::make_shared<ProcessFile>(std::move(process));
+    std::vector<JobSystem::JobHandle> processJobs;
+
+    auto finish = [&] (uint32_t fileIndex, std::shared_ptr<FileData> file) {
+        processJobs.push_back(mJobSystem.schedule([sharedProcess, fileIndex, file] {
+            (*sharedProcess)(fileIndex, *file);
+        }));
+    };
+
+    auto queueRead = [this] (PendingRead& read, uint32_t slot) {
+        size_t remaining = read.file->size - read.offset;
+
+        read.buffer.iov_base = read.file->buffer.get() + read.offset;
+        read.buffer.iov_len = read.direct? alignUp(remaining, DIRECT_IO_ALIGNMENT) : remaining;
+
+        mIoUring->queueRead(read.fd, &read.buffer, read.offset, slot);
+    };
+
+    std::vector<PendingRead> slots(QUEUE_DEPTH);
+    std::vector<uint32_t> freeSlots;
+    for (uint32_t slot = 0; slot < QUEUE_DEPTH; ++slot)
+        freeSlots.push_back(QUEUE_DEPTH - 1 - slot);
+
+    uint32_t nextFile = 0;
+    uint32_t inFlight = 0;
+    uint32_t queued = 0;
+
+    // files that still have to be read if the ring fails
+    std::vector<std::string> remainingPaths;
+    std::vector<uint32_t> remainingIndices;
+
+    // The kernel writes into the buffers of submitted reads until they complete, so they're
+    // reaped before the slots can be freed. If even that fails, the ring and the slots are
+    // leaked rather than handing the kernel freed memory. Submitted reads hold their own
+    // reference to the file, the descriptors can be closed right away.
+    auto abandonIoUring = [&] {
+        uint32_t submitted = inFlight - queued;
+
+        for (PendingRead& read : slots)
+            if (read.file && read.fd >= 0)
+                close(read.fd);
+
+        try
+        {
+            while (submitted > 0)
+            {
+                mIoUring->submit(0, 1);
+
+                unsigned head = *mIoUring->cqHead;
+                unsigned tail = std::atomic_ref<unsigned>(*mIoUring->cqTail).load(std::memory_order_acquire);
+                submitted -= tail - head;
+
+                std::atomic_ref<unsigned>(*mIoUring->cqHead).store(tail, std::memory_order_release);
+            }
+        }
+        catch (const std::runtime_error&)
+        {
+            static_cast<void>(mIoUring.release());
+            static_cast<void>(new std::vector<PendingRead>(std::move(slots)));
+            return;
+        }
+
+        mIoUring.reset();
+    };
+
+    while (nextFile < paths.size() || inFlight > 0)
+    {
+        // opening stays synchronous, reads of the open files overlap while the next ones open
+        while (nextFile < paths.size() && !freeSlots.empty())
+        {
+            uint32_t fileIndex = nextFile++;
+            auto file = std::make_shared<FileData>();
+
+            bool direct = false;
+            int fd = open(paths.at(fileIndex).c_str(), O_RDONLY);
+
+            struct stat fileStat {};
+            if (fd >= 0 && (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode)))
+            {
+                close(fd);
+                fd = -1;
+            }
+
+            // file systems without O_DIRECT support fail the open or the first read
+            if (fd >= 0 && static_cast<size_t>(fileStat.st_size) >= DIRECT_IO_MIN_SIZE)
+            {
+                int directFd = open(paths.at(fileIndex).c_str(), O_RDONLY | O_DIRECT);
+
+                if (directFd >= 0)
+                {
+                    close(fd);
+                    fd = directFd;
+                    direct = true;
+                }
+            }
+
+            if (fd < 0)
+            {
+                finish(fileIndex, file);
+                continue;
+            }
+
+            file->size = fileStat.st_size;
+            file->buffer = allocateReadBuffer(file->size);
+            file->data = file->buffer.get();
+
+            if (file->size == 0)
+            {
+                close(fd);
+                file->read = true;
+                finish(fileIndex, file);
+                continue;
+            }
+
+            uint32_t slot = freeSlots.back();
+            freeSlots.pop_back();
+
+            slots.at(slot) = {fileIndex, fd, direct, 0, file, {}};
+            queueRead(slots.at(slot), slot);
+            ++queued;
+            ++inFlight;
+        }
+
+        try
+        {
+            queued -= mIoUring->submit(queued, inFlight > 0? 1 : 0);
+        }
+        catch (const std::runtime_error&)
+        {
+            for (const PendingRead& read : slots)
+            {
+                if (read.file)
+                {
+                    remainingPaths.push_back(paths.at(read.fileIndex));
+                    remainingIndices.push_back(read.fileIndex);
+                }
+            }
+
+            abandonIoUring();
+            break;
+        }
+
+        unsigned head = *mIoUring->cqHead;
+        unsigned tail = std::atomic_ref<unsigned>(*mIoUring->cqTail).load(std::memory_order_acquire);
+
+        for (; head != tail; ++head)
+        {
+            const io_uring_cqe& cqe = mIoUring->cqes[head & mIoUring->cqMask];
+            uint32_t slot = static_cast<uint32_t>(cqe.user_data);
+            PendingRead& read = slots.at(slot);
+
+            bool retry = false;
+            bool failed = false;
+
+            if (cqe.res == -EINVAL && read.direct)
+            {
+                close(read.fd);
+                read.fd = open(paths.at(read.fileIndex).c_str(), O_RDONLY);
+                read.direct = false;
+                retry = read.fd >= 0;
+                failed = read.fd < 0;
+            }
+            else if (cqe.res == -EAGAIN || cqe.res == -EINTR)
+            {
+                retry = true;
+            }
+            else if (cqe.res < 0)
+            {
+                failed = true;
+            }
+            else
+            {
+                // short reads continue where they stopped, a file that shrank ends early
+                read.offset += cqe.res;
+                retry = cqe.res > 0 && read.offset < read.file->size;
+            }
+
+            if (retry)
+            {
+                queueRead(read, slot);
+                ++queued;
+                continue;
+            }
+
+            if (read.fd >= 0)
+                close(read.fd);
+
+            read.file->size = failed? 0 : std::min(read.file->size, read.offset);
+            read.file->read = !failed;
+
+            finish(read.fileIndex, std::move(read.file));
+            freeSlots.push_back(slot);
+            --inFlight;
+        }
+
+        std::atomic_ref<unsigned>(*mIoUring->cqHead).store(head, std::memory_order_release);
+    }
+
+    // without a working ring, the files still in flight and those not opened yet are mapped
+    if (!mIoUring)
+    {
+        for (uint32_t fileIndex = nextFile; fileIndex < paths.size(); ++fileIndex)
+        {
+            remainingPaths.push_back(paths.at(fileIndex));
+            remainingIndices.push_back(fileIndex);
+        }
+
+        processJobs.push_back(readFilesMapped(remainingPaths, [sharedProcess, remainingIndices] (uint32_t i, FileData& file) {
+            (*sharedProcess)(remainingIndices.at(i), file);
+        }));
+    }
+
+    return mJobSystem.schedule([] {}, processJobs);
+}
+
+#else
+
+JobSystem::JobHandle FileReader::readFilesIoUring(const std::vector<std::string>& paths, ProcessFile process)
+{
+    return readFilesMapped(paths, std::move(process));
+}
+
+#endif
@@ -0,0 +1,57 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_FILE_READER_HPP
+#define VULKAN3DMODELVIEWER_FILE_READER_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include "job_system.hpp"
+#include "mapped_file.hpp"
+
+
+// contents of a file read by the FileReader, held in an aligned buffer or a mapping
+struct FileData
+{
+    std::shared_ptr<uint8_t> buffer;
+    MappedFile mapping;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    bool read = false;
+};
+
+// Reads batches of whole files and hands each one to a job as soon as it arrived.
+// On Linux all reads of a batch are queued to an io_uring at once, into buffers aligned
+// for O_DIRECT, so the storage sees many requests in flight instead of one blocking
+// read after another. Without io_uring the files are mapped on the job system's workers.
+class FileReader
+{
+public:
+    using ProcessFile = std::function<void(uint32_t fileIndex, FileData& file)>;
+
+    FileReader(JobSystem& jobSystem, bool allowIoUring);
+    ~FileReader();
+
+    FileReader(const FileReader&) = delete;
+    FileReader& operator=(const FileReader&) = delete;
+
+    bool usesIoUring() const;
+
+    // the returned job finishes once every file was processed. Files that can't be read
+    // are processed too, with read set to false.
+    JobSystem::JobHandle readFiles(const std::vector<std::string>& paths, ProcessFile process);
+
+private:
+    struct IoUring;
+
+    JobSystem::JobHandle readFilesMapped(const std::vector<std::string>& paths, ProcessFile process);
+    JobSystem::JobHandle readFilesIoUring(const std::vector<std::string>& paths, ProcessFile process);
+
+    JobSystem& mJobSystem;
+    std::unique_ptr<IoUring> mIoUring;
+};
+
+#endif //VULKAN3DMODELVIEWER_FILE_READER_HPP
@@ -0,0 +1,82 @@
+//
+// Created by Gianni on 19/10/2026.
+//
+
+#include "image_data.hpp"
+
+#include <climits>
+#include <algorithm>
+#include <stb/stb_image.h>
+#include "mapped_file.hpp"
+
+
+ImageData loadImageData(const std::string& filename)
+{
+    // decoded straight from the mapped pages, without reading the file into a buffer first
+    MappedFile file(filename);
+
+    if (!file.isOpen())
+        return {};
+
+    return decodeImageData(file.data(), file.size());
+}
+
+ImageData decodeImageData(const uint8_t* data, size_t size)
+{
+    ImageData imageData {};
+
+    if (data && size <= INT_MAX)
+    {
+        imageData.pixels = stbi_load_from_memory(data,
+                                                 static_cast<int>(size),
+                                                 &imageData.width,
+                                                 &imageData.height,
+                                                 nullptr,
+                                                 STBI_rgb_alpha);
+    }
+
+    return imageData;
+}
+
+void freeImageData(ImageData& imageData)
+{
+    stbi_image_free(imageData.pixels);
+    imageData.pixels = nullptr;
+}
+
+void downsampleImageData(ImageData& imageData, uint32_t levels)
+{
+    for (uint32_t level = 0; level < levels && (imageData.width > 1 || imageData.height > 1); ++level)
+    {
+        int width = std::max(imageData.width / 2, 1);
+        int height = std::max(imageData.height / 2, 1);
+
+        // allocated like stb's pixels, so freeImageData releases either
+        auto pixels = static_cast<uint8_t*>(STBI_MALLOC(static_cast<size_t>(width) * height * 4));
+
+        for (int y = 0; y < height; ++y)
+        {
+            int y0 = std::min(y * 2, imageData.height - 1);
+            int y1 = std::min(y * 2 + 1, imageData.height - 1);
+
+            for (int x = 0; x < width; ++x)
+            {
+                int x0 = std::min(x * 2, imageData.width - 1);
+                int x1 = std::min(x * 2 + 1, imageData.width - 1);
+
+                for (int c = 0; c < 4; ++c)
+                {
+                    uint32_t sum = imageData.pixels[(y0 * imageData.width + x0) * 4 + c] +
+                                   imageData.pixels[(y0 * imageData.width + x1) * 4 + c] +
+                                   imageData.pixels[(y1 * imageData.width + x0) * 4 + c] +
+                                   imageData.pixels[(y1 * imageData.width + x1) * 4 + c];
+
+                    pixels[(y * width + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+
+        stbi_image_free(imageData.pixels);
+        imageData = {pixels, width, height};
+    }
+}
@@ -0,0 +1,28 @@
+//
+// Created by Gianni on 19/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_IMAGE_DATA_HPP
+#define VULKAN3DMODELVIEWER_IMAGE_DATA_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+
+// decoded RGBA8 pixels
+struct ImageData
+{
+    uint8_t* pixels;
+    int width;
+    int height;
+};
+
+// decoding touches no Vulkan state and may run on any thread, failed loads have no pixels
+ImageData loadImageData(const std::string& filename);
+ImageData decodeImageData(const uint8_t* data, size_t size);
+void freeImageData(ImageData& imageData);
+// halves width and height once per level with a box filter, leaving out the largest mip levels
+void downsampleImageData(ImageData& imageData, uint32_t levels);
+
+#endif //VULKAN3DMODELVIEWER_IMAGE_DATA_HPP
@@ -0,0 +1,264 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#include "job_system.hpp"
+
+#include <chrono>
+#include <algorithm>
+
+
+static constexpr uint32_t NOT_A_WORKER = UINT32_MAX;
+static thread_local uint32_t tWorkerIndex = NOT_A_WORKER;
+static thread_local const JobSystem* tJobSystem = nullptr;
+
+JobSystem::JobSystem(uint32_t workerCount)
+    : mQueuedJobs()
+    , mStopping()
+{
+    for (uint32_t i = 0; i < workerCount + 1; ++i)
+        mQueues.push_back(std::make_unique<WorkQueue>());
+
+    mWorkers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; ++i)
+        mWorkers.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mStopping = true;
+    }
+
+    mWorkAvailable.notify_all();
+
+    for (std::thread& worker : mWorkers)
+        worker.join();
+}
+
+uint32_t JobSystem::workerCount() const
+{
+    return mWorkers.size();
+}
+
+JobSystem::JobHandle JobSystem::schedule(std::function<void()> work, const std::vector<JobHandle>& dependencies)
+{
+    JobHandle job = std::make_shared<Job>();
+    job->work = std::move(work);
+    job->pendingDependencies = dependencies.size() + 1;
+    job->finished = false;
+
+    for (const JobHandle& dependency : dependencies)
+    {
+        std::lock_guard<std::mutex> lock(dependency->mutex);
+
+        if (dependency->finished)
+        {
+            if (dependency->exception)
+                fail(*job, dependency->exception);
+
+            --job->pendingDependencies;
+        }
+        else
+        {
+            dependency->continuations.push_back(job);
+        }
+    }
+
+    // dependencies may have finished meanwhile, whoever drops the count to zero queues the job
+    if (--job->pendingDependencies == 0)
+        enqueue(job);
+
+    return job;
+}
+
+JobSystem::JobHandle JobSystem::parallelFor(uint32_t count,
+                                            uint32_t grainSize,
+                                            RangeWork work,
+                                            const std::vector<JobHandle>& dependencies)
+{
+    grainSize = std::max(grainSize, 1u);
+
+    // the ranges share one copy of the work
+    auto sharedWork = std::make_shared<RangeWork>(std::move(work));
+
+    std::vector<JobHandle> ranges;
+    ranges.reserve((count + grainSize - 1) / grainSize);
+
+    for (uint32_t begin = 0; begin < count; begin += grainSize)
+    {
+        uint32_t end = std::min(begin + grainSize, count);
+        ranges.push_back(schedule([sharedWork, begin, end] { (*sharedWork)(begin, end); }, dependencies));
+    }
+
+    if (ranges.empty())
+        ranges = dependencies;
+
+    return schedule([] {}, ranges);
+}
+
+void JobSystem::wait(const JobHandle& job)
+{
+    uint32_t queueIndex = queueIndexOfCurrentThread();
+
+    while (!job->finished)
+    {
+        if (JobHandle next = findJob(queueIndex))
+        {
+            execute(next);
+            continue;
+        }
+
+        // nothing to help with, the job runs elsewhere or waits on one that does
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mJobFinished.wait_for(lock, std::chrono::milliseconds(1), [this, &job] {
+            return job->finished || mQueuedJobs > 0;
+        });
+    }
+
+    if (job->exception)
+        std::rethrow_exception(job->exception);
+}
+
+bool JobSystem::runPendingJob()
+{
+    JobHandle job = findJob(queueIndexOfCurrentThread());
+
+    if (!job)
+        return false;
+
+    execute(job);
+    return true;
+}
+
+void JobSystem::workerLoop(uint32_t workerIndex)
+{
+    tWorkerIndex = workerIndex;
+    tJobSystem = this;
+
+    while (true)
+    {
+        if (JobHandle job = findJob(workerIndex))
+        {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mWorkAvailable.wait(lock, [this] { return mStopping || mQueuedJobs > 0; });
+
+        if (mStopping)
+            return;
+    }
+}
+
+void JobSystem::enqueue(JobHandle job)
+{
+    WorkQueue& queue = *mQueues.at(queueIndexOfCurrentThread());
+
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        ++mQueuedJobs;
+    }
+
+    mWorkAvailable.notify_one();
+    mJobFinished.notify_all();
+}
+
+JobSystem::JobHandle JobSystem::findJob(uint32_t queueIndex)
+{
+    // own jobs newest first, they are the most likely to still be in cache
+    {
+        WorkQueue& queue = *mQueues.at(queueIndex);
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (!queue.jobs.empty())
+        {
+            JobHandle job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            --mQueuedJobs;
+            return job;
+        }
+    }
+
+    // steal the oldest job of another queue, usually the largest piece of remaining work
+    for (uint32_t offset = 1; offset < mQueues.size(); ++offset)
+    {
+        WorkQueue& queue = *mQueues.at((queueIndex + offset) % mQueues.size());
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (!queue.jobs.empty())
+        {
+            JobHandle job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            --mQueuedJobs;
+            return job;
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::execute(const JobHandle& job)
+{
+    // all dependencies finished, nothing else writes the exception anymore
+    if (!job->exception)
+    {
+        // an exception leaving a worker would terminate, it goes to whoever waits instead
+        try
+        {
+            job->work();
+        }
+        catch (...)
+        {
+            fail(*job, std::current_exception());
+        }
+    }
+
+    job->work = nullptr;
+
+    std::vector<JobHandle> continuations;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->finished = true;
+        continuations.swap(job->continuations);
+    }
+
+    for (JobHandle& continuation : continuations)
+    {
+        if (job->exception)
+            fail(*continuation, job->exception);
+
+        if (--continuation->pendingDependencies == 0)
+            enqueue(std::move(continuation));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+    }
+
+    mJobFinished.notify_all();
+}
+
+void JobSystem::fail(Job& job, std::exception_ptr exception)
+{
+    std::lock_guard<std::mutex> lock(job.mutex);
+
+    // the first failure wins, the others are dropped
+    if (!job.exception)
+        job.exception = std::move(exception);
+}
+
+uint32_t JobSystem::queueIndexOfCurrentThread() const
+{
+    if (tJobSystem == this && tWorkerIndex != NOT_A_WORKER)
+        return tWorkerIndex;
+
+    return mQueues.size() - 1;
+}
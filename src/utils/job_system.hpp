@@ -0,0 +1,97 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_JOB_SYSTEM_HPP
+#define VULKAN3DMODELVIEWER_JOB_SYSTEM_HPP
+
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+
+// Work-stealing scheduler. Every worker owns a deque: it pushes and pops its own jobs
+// at the back and steals from the front of other deques when it runs dry. Threads
+// outside the pool submit into a shared deque and help executing jobs while waiting.
+// A job becomes runnable once all of its dependencies finished. An exception thrown by a
+// job is stored in it and passed on to the jobs depending on it, which finish without
+// running their work. Waiting for a failed job rethrows the exception.
+class JobSystem
+{
+public:
+    struct Job;
+    using JobHandle = std::shared_ptr<Job>;
+    using RangeWork = std::function<void(uint32_t begin, uint32_t end)>;
+
+    explicit JobSystem(uint32_t workerCount);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    uint32_t workerCount() const;
+
+    JobHandle schedule(std::function<void()> work, const std::vector<JobHandle>& dependencies = {});
+
+    // splits [0, count) into ranges of at most grainSize, the handle finishes after all of them
+    JobHandle parallelFor(uint32_t count,
+                          uint32_t grainSize,
+                          RangeWork work,
+                          const std::vector<JobHandle>& dependencies = {});
+
+    // runs other jobs until the job finished, then rethrows the exception it failed with
+    void wait(const JobHandle& job);
+
+    // runs one queued job on the calling thread, false if there was none. Lets a thread
+    // that never waits drive background jobs when there are no workers.
+    bool runPendingJob();
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<JobHandle> jobs;
+    };
+
+    void workerLoop(uint32_t workerIndex);
+    void enqueue(JobHandle job);
+    JobHandle findJob(uint32_t queueIndex);
+    void execute(const JobHandle& job);
+    static void fail(Job& job, std::exception_ptr exception);
+
+    uint32_t queueIndexOfCurrentThread() const;
+
+    std::vector<std::thread> mWorkers;
+
+    // one queue per worker plus a shared one for outside threads, at the end
+    std::vector<std::unique_ptr<WorkQueue>> mQueues;
+
+    std::mutex mSleepMutex;
+    std::condition_variable mWorkAvailable;
+    std::condition_variable mJobFinished;
+    std::atomic<uint32_t> mQueuedJobs;
+    bool mStopping;
+};
+
+struct JobSystem::Job
+{
+    std::function<void()> work;
+
+    // dependencies still running, plus one while the job is being scheduled
+    std::atomic<uint32_t> pendingDependencies;
+
+    std::mutex mutex;
+    std::vector<JobHandle> continuations;
+    std::atomic<bool> finished;
+
+    // set under the mutex before the job finished, by the job itself or a failed dependency
+    std::exception_ptr exception;
+};
+
+#endif //VULKAN3DMODELVIEWER_JOB_SYSTEM_HPP
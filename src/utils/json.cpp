@@ -0,0 +1,55 @@
+//
+// Created by Gianni on 19/10/2026.
+//
+
+#include "json.hpp"
+
+#include <cstdio>
+#include "build_info.hpp"
+
+
+std::string escapeJson(const std::string& string)
+{
+    std::string escaped;
+    escaped.reserve(string.size());
+
+    for (char c : string)
+    {
+        switch (c)
+        {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\b': escaped += "\\b"; break;
+            case '\f': escaped += "\\f"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char code[7];
+                    std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(c));
+                    escaped += code;
+                }
+                else
+                {
+                    escaped += c;
+                }
+        }
+    }
+
+    return escaped;
+}
+
+void writeBuildInfoJson(std::ostream& stream)
+{
+#ifdef DEBUG_MODE
+    static constexpr const char* buildType = "debug";
+#else
+    static constexpr const char* buildType = "release";
+#endif
+
+    stream << "\"build\": {\"type\": \"" << buildType
+           << "\", \"commit\": \"" << VMV_BUILD_COMMIT
+           << "\", \"date\": \"" << VMV_BUILD_DATE << "\"}";
+}
@@ -0,0 +1,19 @@
+//
+// Created by Gianni on 19/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_JSON_HPP
+#define VULKAN3DMODELVIEWER_JSON_HPP
+
+#include <string>
+#include <ostream>
+
+
+// the contents of a JSON string literal, without the quotes
+std::string escapeJson(const std::string& string);
+
+// "build": {"type": ..., "commit": ..., "date": ...} member of the reports, so results can be matched
+// to the build. The commit is suffixed with -dirty for uncommitted changes, the date is the commit's.
+void writeBuildInfoJson(std::ostream& stream);
+
+#endif //VULKAN3DMODELVIEWER_JSON_HPP
@@ -0,0 +1,194 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+MappedFile::MappedFile()
+    : mData()
+    , mSize()
+    , mOpen()
+#ifdef _WIN32
+    , mFile(INVALID_HANDLE_VALUE)
+    , mMapping()
+#endif
+{
+}
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filename)
+    : MappedFile()
+{
+    mFile = CreateFileA(filename.c_str(),
+                        GENERIC_READ,
+                        FILE_SHARE_READ,
+                        nullptr,
+                        OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                        nullptr);
+
+    LARGE_INTEGER fileSize;
+    if (mFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(mFile, &fileSize))
+    {
+        close();
+        return;
+    }
+
+    mSize = static_cast<size_t>(fileSize.QuadPart);
+    mOpen = true;
+
+    // empty files can't be mapped but are still valid
+    if (mSize == 0)
+        return;
+
+    mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    mData = mMapping? static_cast<const uint8_t*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+
+    if (!mData)
+        close();
+}
+
+void MappedFile::close()
+{
+    if (mData)
+        UnmapViewOfFile(mData);
+    if (mMapping)
+        CloseHandle(mMapping);
+    if (mFile != INVALID_HANDLE_VALUE)
+        CloseHandle(mFile);
+
+    mData = nullptr;
+    mSize = 0;
+    mOpen = false;
+    mFile = INVALID_HANDLE_VALUE;
+    mMapping = nullptr;
+}
+
+bool MappedFile::evictFromPageCache(const std::string&)
+{
+    return false;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filename)
+    : MappedFile()
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat fileStat {};
+    if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
+    {
+        ::close(fd);
+        return;
+    }
+
+    mSize = static_cast<size_t>(fileStat.st_size);
+    mOpen = true;
+
+    if (mSize > 0)
+    {
+        void* mapping = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapping != MAP_FAILED)
+        {
+            // the callers read front to back once, so read ahead aggressively
+            madvise(mapping, mSize, MADV_SEQUENTIAL);
+            madvise(mapping, mSize, MADV_WILLNEED);
+            mData = static_cast<const uint8_t*>(mapping);
+        }
+        else
+        {
+            mSize = 0;
+            mOpen = false;
+        }
+    }
+
+    // the mapping keeps the file referenced
+    ::close(fd);
+}
+
+void MappedFile::close()
+{
+    if (mData)
+        munmap(const_cast<uint8_t*>(mData), mSize);
+
+    mData = nullptr;
+    mSize = 0;
+    mOpen = false;
+}
+
+bool MappedFile::evictFromPageCache(const std::string& filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    bool evicted = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    ::close(fd);
+
+    return evicted;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : MappedFile()
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+
+        std::swap(mData, other.mData);
+        std::swap(mSize, other.mSize);
+        std::swap(mOpen, other.mOpen);
+#ifdef _WIN32
+        std::swap(mFile, other.mFile);
+        std::swap(mMapping, other.mMapping);
+#endif
+    }
+
+    return *this;
+}
+
+bool MappedFile::isOpen() const
+{
+    return mOpen;
+}
+
+const uint8_t* MappedFile::data() const
+{
+    return mData;
+}
+
+size_t MappedFile::size() const
+{
+    return mSize;
+}
@@ -0,0 +1,52 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_MAPPED_FILE_HPP
+#define VULKAN3DMODELVIEWER_MAPPED_FILE_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+
+// Read-only view of a whole file in the address space. Pages are read in by the
+// page fault that first touches them, straight from the page cache without a copy
+// into a user buffer. The mapping is hinted for sequential reads, so the kernel
+// reads ahead. Failing to map leaves the file closed instead of throwing, so files
+// can be mapped on worker threads.
+class MappedFile
+{
+public:
+    MappedFile();
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const;
+    const uint8_t* data() const;
+    size_t size() const;
+
+    // drops the file's cached pages, so the next read comes from storage. Returns false
+    // where the platform can't do it.
+    static bool evictFromPageCache(const std::string& filename);
+
+private:
+    void close();
+
+    const uint8_t* mData;
+    size_t mSize;
+    bool mOpen;
+
+#ifdef _WIN32
+    void* mFile;
+    void* mMapping;
+#endif
+};
+
+#endif //VULKAN3DMODELVIEWER_MAPPED_FILE_HPP
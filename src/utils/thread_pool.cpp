@@ -0,0 +1,84 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#include "thread_pool.hpp"
+
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+    : mGeneration()
+    , mActiveWorkers()
+    , mStopping()
+    , mTask()
+    , mTaskCount()
+    , mNextTask()
+{
+    mThreads.reserve(threadCount);
+
+    for (uint32_t i = 0; i < threadCount; ++i)
+        mThreads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+
+    mWorkAvailable.notify_all();
+
+    for (std::thread& thread : mThreads)
+        thread.join();
+}
+
+uint32_t ThreadPool::threadCount() const
+{
+    return mThreads.size();
+}
+
+void ThreadPool::run(uint32_t taskCount, const Task& task)
+{
+    if (taskCount == 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTask = &task;
+        mTaskCount = taskCount;
+        mNextTask = 0;
+        mActiveWorkers = mThreads.size();
+        ++mGeneration;
+    }
+
+    mWorkAvailable.notify_all();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mWorkFinished.wait(lock, [this] { return mActiveWorkers == 0; });
+}
+
+void ThreadPool::workerLoop(uint32_t threadIndex)
+{
+    uint64_t seenGeneration = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWorkAvailable.wait(lock, [this, seenGeneration] { return mStopping || mGeneration != seenGeneration; });
+
+            if (mStopping)
+                return;
+
+            seenGeneration = mGeneration;
+        }
+
+        // tasks are handed out one at a time, so uneven tasks still balance out
+        for (uint32_t taskIndex = mNextTask++; taskIndex < mTaskCount; taskIndex = mNextTask++)
+            (*mTask)(taskIndex, threadIndex);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (--mActiveWorkers == 0)
+            mWorkFinished.notify_one();
+    }
+}
@@ -0,0 +1,51 @@
+//
+// Created by Gianni on 18/10/2026.
+//
+
+#ifndef VULKAN3DMODELVIEWER_THREAD_POOL_HPP
+#define VULKAN3DMODELVIEWER_THREAD_POOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+
+// Persistent worker threads that split a batch of indexed tasks between them. Every
+// worker has a fixed index, so callers can keep per-thread state such as command pools.
+class ThreadPool
+{
+public:
+    using Task = std::function<void(uint32_t taskIndex, uint32_t threadIndex)>;
+
+    explicit ThreadPool(uint32_t threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    uint32_t threadCount() const;
+
+    // runs the task for every index in [0, taskCount) and returns once all of them finished
+    void run(uint32_t taskCount, const Task& task);
+
+private:
+    void workerLoop(uint32_t threadIndex);
+
+    std::vector<std::thread> mThreads;
+
+    std::mutex mMutex;
+    std::condition_variable mWorkAvailable;
+    std::condition_variable mWorkFinished;
+    uint64_t mGeneration;
+    uint32_t mActiveWorkers;
+    bool mStopping;
+
+    const Task* mTask;
+    uint32_t mTaskCount;
+    std::atomic<uint32_t> mNextTask;
+};
+
+#endif //VULKAN3DMODELVIEWER_THREAD_POOL_HPP
@@ -2,20 +2,21 @@
 // Created by Gianni on 17/11/2024.
 //
 
-#include <stb/stb_image.h>
+#include <chrono>
+#include <cstring>
 #include "vulkan_functions.hpp"
 
 
-void createInstance(VulkanInstance& instance)
+void createInstance(VulkanInstance& instance, bool headless)
 {
-    std::vector<const char*> extensions = getInstanceExtensions();
+    std::vector<const char*> extensions = getInstanceExtensions(headless);
 
     VkApplicationInfo applicationInfo {
         .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
         .pApplicationName = "Vulkan3DModelViewer",
         .applicationVersion = VK_MAKE_API_VERSION(0, 1, 0, 0),
         .pEngineName = nullptr,
-        .apiVersion = VK_API_VERSION_1_1
+        .apiVersion = VK_API_VERSION_1_3
     };
 
     VkInstanceCreateInfo instanceCreateInfo {
@@ -75,7 +76,8 @@ void destroyInstance(VulkanInstance& instance)
     auto vkDestroyDebugUtilsMessengerEXT = reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(funcPtr);
     vkDestroyDebugUtilsMessengerEXT(instance.instance, instance.debugMessenger, nullptr);
 #endif
-    vkDestroySurfaceKHR(instance.instance, instance.surface, nullptr);
+    if (instance.surface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(instance.instance, instance.surface, nullptr);
     vkDestroyInstance(instance.instance, nullptr);
 }
 
@@ -88,35 +90,69 @@ void createSurface(VulkanInstance& instance, GLFWwindow* window)
 void createRenderingDevice(VulkanInstance& instance, VulkanRenderDevice& renderDevice)
 {
     pickPhysicalDevice(instance, renderDevice);
+    renderDevice.headless = false;
     createDevice(renderDevice);
     createSwapchain(instance, renderDevice);
     createSwapchainImages(renderDevice);
     createCommandPool(renderDevice);
-    createCommandBuffer(renderDevice);
-    renderDevice.imageReadySemaphore = createSemaphore(renderDevice);
-    renderDevice.renderFinishedSemaphore = createSemaphore(renderDevice);
+    createFrames(renderDevice);
+    renderDevice.timelineSemaphore = createTimelineSemaphore(renderDevice);
+    renderDevice.lastSubmittedTicket = 0;
+}
+
+void createHeadlessRenderingDevice(VulkanInstance& instance, VulkanRenderDevice& renderDevice, VkExtent2D extent)
+{
+    pickPhysicalDevice(instance, renderDevice);
+    renderDevice.headless = true;
+    createDevice(renderDevice);
+    createHeadlessImages(renderDevice, extent);
+    createCommandPool(renderDevice);
+    createFrames(renderDevice);
+    renderDevice.timelineSemaphore = createTimelineSemaphore(renderDevice);
+    renderDevice.lastSubmittedTicket = 0;
 }
 
 void destroyRenderingDevice(VulkanRenderDevice& renderDevice)
 {
-    for (VkImageView imageView : renderDevice.swapchainImageViews)
+    flushDeletionQueue(renderDevice, true);
+
+    // the headless images own their views
+    for (VulkanImage& image : renderDevice.headlessImages)
     {
-        vkDestroyImageView(renderDevice.device, imageView, nullptr);
+        destroyImage(renderDevice, image);
     }
 
-    vkDestroySemaphore(renderDevice.device, renderDevice.imageReadySemaphore, nullptr);
-    vkDestroySemaphore(renderDevice.device, renderDevice.renderFinishedSemaphore, nullptr);
+    if (!renderDevice.headless)
+    {
+        for (VkImageView imageView : renderDevice.swapchainImageViews)
+        {
+            vkDestroyImageView(renderDevice.device, imageView, nullptr);
+        }
+    }
+
+    for (VulkanFrame& frame : renderDevice.frames)
+    {
+        vkDestroySemaphore(renderDevice.device, frame.imageReadySemaphore, nullptr);
+        vkDestroySemaphore(renderDevice.device, frame.renderFinishedSemaphore, nullptr);
+    }
+
+    vkDestroySemaphore(renderDevice.device, renderDevice.timelineSemaphore, nullptr);
     vkDestroyCommandPool(renderDevice.device, renderDevice.commandPool, nullptr);
-    vkDestroySwapchainKHR(renderDevice.device, renderDevice.swapchain, nullptr);
+    if (!renderDevice.headless)
+        vkDestroySwapchainKHR(renderDevice.device, renderDevice.swapchain, nullptr);
     vkDestroyDevice(renderDevice.device, nullptr);
 }
 
-std::vector<const char*> getInstanceExtensions()
+// headless replays never present, they run without the surface and swapchain extensions
+std::vector<const char*> getInstanceExtensions(bool headless)
 {
-    std::vector<const char*> extensions {
-        "VK_KHR_surface",
-        "VK_KHR_win32_surface"
-    };
+    std::vector<const char*> extensions;
+
+    if (!headless)
+    {
+        extensions.push_back("VK_KHR_surface");
+        extensions.push_back("VK_KHR_win32_surface");
+    }
 
 #ifdef DEBUG_MODE
     extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -125,11 +161,12 @@ std::vector<const char*> getInstanceExtensions()
     return extensions;
 }
 
-std::vector<const char*> getDeviceExtensions()
+std::vector<const char*> getDeviceExtensions(bool headless)
 {
-    std::vector<const char*> extensions {
-        "VK_KHR_swapchain"
-    };
+    std::vector<const char*> extensions;
+
+    if (!headless)
+        extensions.push_back("VK_KHR_swapchain");
 
     return extensions;
 }
@@ -183,15 +220,57 @@ void createDevice(VulkanRenderDevice& renderDevice)
         .pQueuePriorities = &queuePriority
     };
 
-    std::vector<const char*> extensions = getDeviceExtensions();
+    std::vector<const char*> extensions = getDeviceExtensions(renderDevice.headless);
 
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(renderDevice.physicalDevice, &supportedFeatures);
+
+    // queries stay active across secondary command buffers only with inheritedQueries
     VkPhysicalDeviceFeatures physicalDeviceFeatures {
-        .sampleRateShading = VK_TRUE,
+        .pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery,
+        .inheritedQueries = supportedFeatures.inheritedQueries,
         .samplerAnisotropy = VK_TRUE
     };
 
+    // render passes are recorded with dynamic rendering and synchronization2 barriers
+    VkPhysicalDeviceVulkan13Features vulkan13Features {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+        .synchronization2 = VK_TRUE,
+        .dynamicRendering = VK_TRUE
+    };
+
+    // the texture table is a runtime sized array that only holds the loaded textures
+    VkPhysicalDeviceVulkan12Features vulkan12Features {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .pNext = &vulkan13Features,
+        .descriptorBindingPartiallyBound = VK_TRUE,
+        .descriptorBindingVariableDescriptorCount = VK_TRUE,
+        .runtimeDescriptorArray = VK_TRUE,
+        .timelineSemaphore = VK_TRUE
+    };
+
+    // optional, lets pipelines be linked from separately compiled parts
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+        .graphicsPipelineLibrary = VK_TRUE
+    };
+
+    bool graphicsPipelineLibrary = supportsGraphicsPipelineLibrary(renderDevice);
+    if (graphicsPipelineLibrary)
+    {
+        extensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+        extensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+        vulkan13Features.pNext = &graphicsPipelineLibraryFeatures;
+    }
+
+    // per heap budgets and usage for the memory tracker's stats
+    bool memoryBudget = isDeviceExtensionSupported(renderDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (memoryBudget)
+        extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
     VkDeviceCreateInfo deviceCreateInfo {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = &vulkan12Features,
         .queueCreateInfoCount = 1,
         .pQueueCreateInfos = &queueCreateInfo,
         .enabledExtensionCount = static_cast<uint32_t>(extensions.size()),
@@ -205,6 +284,9 @@ void createDevice(VulkanRenderDevice& renderDevice)
 
     vkGetDeviceQueue(renderDevice.device, queueFamilyIndex, 0, &renderDevice.graphicsQueue);
     renderDevice.graphicsQueueFamilyIndex = queueFamilyIndex;
+    renderDevice.enabledFeatures = physicalDeviceFeatures;
+    renderDevice.graphicsPipelineLibrary = graphicsPipelineLibrary;
+    renderDevice.memoryBudget = memoryBudget;
 }
 
 std::optional<uint32_t> findQueueFamilyIndex(VulkanRenderDevice& renderDevice, VkQueueFlags capabilitiesFlags)
@@ -226,18 +308,69 @@ std::optional<uint32_t> findQueueFamilyIndex(VulkanRenderDevice& renderDevice, V
     return {};
 }
 
-void createSwapchain(VulkanInstance& instance, VulkanRenderDevice& renderDevice)
+bool isDeviceExtensionSupported(VulkanRenderDevice& renderDevice, const char* extension)
+{
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(renderDevice.physicalDevice, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(renderDevice.physicalDevice, nullptr, &extensionCount, extensions.data());
+
+    return std::any_of(extensions.begin(), extensions.end(), [extension] (const VkExtensionProperties& properties) {
+        return std::strcmp(properties.extensionName, extension) == 0;
+    });
+}
+
+bool supportsGraphicsPipelineLibrary(VulkanRenderDevice& renderDevice)
+{
+    if (!isDeviceExtensionSupported(renderDevice, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) ||
+        !isDeviceExtensionSupported(renderDevice, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME))
+        return false;
+
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT libraryFeatures {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT
+    };
+
+    VkPhysicalDeviceFeatures2 features {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext = &libraryFeatures
+    };
+
+    VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT libraryProperties {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT
+    };
+
+    VkPhysicalDeviceProperties2 properties {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &libraryProperties
+    };
+
+    vkGetPhysicalDeviceFeatures2(renderDevice.physicalDevice, &features);
+    vkGetPhysicalDeviceProperties2(renderDevice.physicalDevice, &properties);
+
+    // without fast linking, linking at startup may cost as much as compiling the whole pipeline
+    return libraryFeatures.graphicsPipelineLibrary && libraryProperties.graphicsPipelineLibraryFastLinking;
+}
+
+void createSwapchain(VulkanInstance& instance, VulkanRenderDevice& renderDevice, VkSwapchainKHR oldSwapchain)
 {
     VkSurfaceCapabilitiesKHR surfaceCapabilities;
     vkGetPhysicalDeviceSurfaceCapabilitiesKHR(renderDevice.physicalDevice, instance.surface, &surfaceCapabilities);
 
     renderDevice.swapchainFormat = VK_FORMAT_R8G8B8A8_UNORM;
     renderDevice.swapchainExtent = surfaceCapabilities.currentExtent;
+    renderDevice.presentMode = choosePresentMode(instance, renderDevice, renderDevice.presentPolicy);
+
+    // a max image count of 0 means there is no upper limit
+    uint32_t maxImageCount = surfaceCapabilities.maxImageCount? surfaceCapabilities.maxImageCount : UINT32_MAX;
+    uint32_t imageCount = glm::clamp(renderDevice.requestedSwapchainImageCount,
+                                     surfaceCapabilities.minImageCount,
+                                     maxImageCount);
 
     VkSwapchainCreateInfoKHR swapchainCreateInfo {
         .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
         .surface = instance.surface,
-        .minImageCount = 3,
+        .minImageCount = imageCount,
         .imageFormat = renderDevice.swapchainFormat,
         .imageColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR,
         .imageExtent = renderDevice.swapchainExtent,
@@ -246,14 +379,65 @@ void createSwapchain(VulkanInstance& instance, VulkanRenderDevice& renderDevice)
         .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
         .preTransform = surfaceCapabilities.currentTransform,
         .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
-        .presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR,
-        .clipped = VK_TRUE
+        .presentMode = renderDevice.presentMode,
+        .clipped = VK_TRUE,
+        .oldSwapchain = oldSwapchain
     };
 
     VkResult result = vkCreateSwapchainKHR(renderDevice.device, &swapchainCreateInfo, nullptr, &renderDevice.swapchain);
     vulkanCheck(result, "Failed to create swapchain.");
 }
 
+VkPresentModeKHR choosePresentMode(VulkanInstance& instance, VulkanRenderDevice& renderDevice, PresentPolicy policy)
+{
+    uint32_t presentModeCount;
+    vkGetPhysicalDeviceSurfacePresentModesKHR(renderDevice.physicalDevice, instance.surface, &presentModeCount, nullptr);
+
+    std::vector<VkPresentModeKHR> supportedPresentModes(presentModeCount);
+    vkGetPhysicalDeviceSurfacePresentModesKHR(renderDevice.physicalDevice,
+                                              instance.surface,
+                                              &presentModeCount,
+                                              supportedPresentModes.data());
+
+    std::vector<VkPresentModeKHR> preferredPresentModes;
+
+    switch (policy)
+    {
+        case PresentPolicy::VSync:
+            break;
+        case PresentPolicy::AdaptiveVSync:
+            preferredPresentModes = {VK_PRESENT_MODE_FIFO_RELAXED_KHR};
+            break;
+        case PresentPolicy::LowLatency:
+            preferredPresentModes = {VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR};
+            break;
+        case PresentPolicy::Uncapped:
+            preferredPresentModes = {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR};
+            break;
+    }
+
+    for (VkPresentModeKHR presentMode : preferredPresentModes)
+    {
+        if (std::find(supportedPresentModes.begin(), supportedPresentModes.end(), presentMode) != supportedPresentModes.end())
+            return presentMode;
+    }
+
+    // FIFO support is required by the spec
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+const char* getPresentModeName(VkPresentModeKHR presentMode)
+{
+    switch (presentMode)
+    {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR: return "IMMEDIATE";
+        case VK_PRESENT_MODE_MAILBOX_KHR: return "MAILBOX";
+        case VK_PRESENT_MODE_FIFO_KHR: return "FIFO";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "FIFO_RELAXED";
+        default: return "UNKNOWN";
+    }
+}
+
 void createSwapchainImages(VulkanRenderDevice& renderDevice)
 {
     uint32_t imageCount;
@@ -277,6 +461,31 @@ void createSwapchainImages(VulkanRenderDevice& renderDevice)
     }
 }
 
+void createHeadlessImages(VulkanRenderDevice& renderDevice, VkExtent2D extent)
+{
+    renderDevice.swapchain = VK_NULL_HANDLE;
+    renderDevice.swapchainFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    renderDevice.swapchainExtent = extent;
+    renderDevice.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+
+    renderDevice.headlessImages.resize(FRAMES_IN_FLIGHT);
+    renderDevice.swapchainImages.clear();
+    renderDevice.swapchainImageViews.clear();
+
+    for (VulkanImage& image : renderDevice.headlessImages)
+    {
+        image = createImage(renderDevice,
+                            renderDevice.swapchainFormat,
+                            extent.width, extent.height,
+                            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                            VK_IMAGE_ASPECT_COLOR_BIT,
+                            MemoryCategory::Attachment);
+
+        renderDevice.swapchainImages.push_back(image.image);
+        renderDevice.swapchainImageViews.push_back(image.imageView);
+    }
+}
+
 void createCommandPool(VulkanRenderDevice& renderDevice)
 {
     VkCommandPoolCreateInfo commandPoolCreateInfo {
@@ -293,7 +502,7 @@ void createCommandPool(VulkanRenderDevice& renderDevice)
     vulkanCheck(result, "Failed to create command pool.");
 }
 
-void createCommandBuffer(VulkanRenderDevice& renderDevice)
+void createFrames(VulkanRenderDevice& renderDevice)
 {
     VkCommandBufferAllocateInfo commandBufferAllocateInfo {
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
@@ -302,10 +511,71 @@ void createCommandBuffer(VulkanRenderDevice& renderDevice)
         .commandBufferCount = 1
     };
 
-    VkResult result = vkAllocateCommandBuffers(renderDevice.device,
-                                               &commandBufferAllocateInfo,
-                                               &renderDevice.commandBuffer);
-    vulkanCheck(result, "Failed to allocate command buffer.");
+    for (VulkanFrame& frame : renderDevice.frames)
+    {
+        VkResult result = vkAllocateCommandBuffers(renderDevice.device,
+                                                   &commandBufferAllocateInfo,
+                                                   &frame.commandBuffer);
+        vulkanCheck(result, "Failed to allocate command buffer.");
+
+        frame.imageReadySemaphore = createSemaphore(renderDevice);
+        frame.renderFinishedSemaphore = createSemaphore(renderDevice);
+        frame.ticket = 0;
+    }
+
+    renderDevice.frameIndex = 0;
+}
+
+SecondaryCommandPool createSecondaryCommandPool(VulkanRenderDevice& renderDevice)
+{
+    SecondaryCommandPool pool {};
+
+    // buffers are re-recorded every frame and only reset through the pool
+    VkCommandPoolCreateInfo commandPoolCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = renderDevice.graphicsQueueFamilyIndex
+    };
+
+    VkResult result = vkCreateCommandPool(renderDevice.device, &commandPoolCreateInfo, nullptr, &pool.commandPool);
+    vulkanCheck(result, "Failed to create secondary command pool.");
+
+    return pool;
+}
+
+void destroySecondaryCommandPool(VulkanRenderDevice& renderDevice, SecondaryCommandPool& pool)
+{
+    vkDestroyCommandPool(renderDevice.device, pool.commandPool, nullptr);
+    pool.commandBuffers.clear();
+    pool.usedCount = 0;
+}
+
+// the pool's frame has to be retired
+void resetSecondaryCommandPool(VulkanRenderDevice& renderDevice, SecondaryCommandPool& pool)
+{
+    vkResetCommandPool(renderDevice.device, pool.commandPool, 0);
+    pool.usedCount = 0;
+}
+
+VkCommandBuffer allocateSecondaryCommandBuffer(VulkanRenderDevice& renderDevice, SecondaryCommandPool& pool)
+{
+    if (pool.usedCount == pool.commandBuffers.size())
+    {
+        VkCommandBufferAllocateInfo commandBufferAllocateInfo {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = pool.commandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+            .commandBufferCount = 1
+        };
+
+        VkCommandBuffer commandBuffer;
+        VkResult result = vkAllocateCommandBuffers(renderDevice.device, &commandBufferAllocateInfo, &commandBuffer);
+        vulkanCheck(result, "Failed to allocate secondary command buffer.");
+
+        pool.commandBuffers.push_back(commandBuffer);
+    }
+
+    return pool.commandBuffers.at(pool.usedCount++);
 }
 
 VkSemaphore createSemaphore(VulkanRenderDevice& renderDevice)
@@ -325,10 +595,149 @@ VkSemaphore createSemaphore(VulkanRenderDevice& renderDevice)
     return semaphore;
 }
 
+VkSemaphore createTimelineSemaphore(VulkanRenderDevice& renderDevice)
+{
+    VkSemaphore semaphore;
+
+    VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0
+    };
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &semaphoreTypeCreateInfo
+    };
+
+    VkResult result = vkCreateSemaphore(renderDevice.device,
+                                        &semaphoreCreateInfo,
+                                        nullptr,
+                                        &semaphore);
+    vulkanCheck(result, "Failed to create timeline semaphore.");
+
+    return semaphore;
+}
+
+uint64_t submitCommandBuffer(VulkanRenderDevice& renderDevice,
+                             VkCommandBuffer commandBuffer,
+                             VkSemaphore waitSemaphore,
+                             VkPipelineStageFlags waitStage,
+                             VkSemaphore signalSemaphore)
+{
+    uint64_t ticket = renderDevice.lastSubmittedTicket + 1;
+
+    // the timeline semaphore is always signaled, the binary semaphore only when given
+    std::array<VkSemaphore, 2> signalSemaphores {renderDevice.timelineSemaphore, signalSemaphore};
+    std::array<uint64_t, 2> signalValues {ticket, 0};
+    uint32_t signalSemaphoreCount = signalSemaphore == VK_NULL_HANDLE? 1 : 2;
+    uint32_t waitSemaphoreCount = waitSemaphore == VK_NULL_HANDLE? 0 : 1;
+
+    VkTimelineSemaphoreSubmitInfo timelineSubmitInfo {
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .signalSemaphoreValueCount = signalSemaphoreCount,
+        .pSignalSemaphoreValues = signalValues.data()
+    };
+
+    VkSubmitInfo submitInfo {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timelineSubmitInfo,
+        .waitSemaphoreCount = waitSemaphoreCount,
+        .pWaitSemaphores = &waitSemaphore,
+        .pWaitDstStageMask = &waitStage,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &commandBuffer,
+        .signalSemaphoreCount = signalSemaphoreCount,
+        .pSignalSemaphores = signalSemaphores.data()
+    };
+
+    VkResult result = vkQueueSubmit(renderDevice.graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    vulkanCheck(result, "Failed to submit command buffer.");
+
+    renderDevice.lastSubmittedTicket = ticket;
+
+    return ticket;
+}
+
+uint64_t getCompletedTicket(VulkanRenderDevice& renderDevice)
+{
+    uint64_t value;
+    vkGetSemaphoreCounterValue(renderDevice.device, renderDevice.timelineSemaphore, &value);
+    return value;
+}
+
+bool isTicketComplete(VulkanRenderDevice& renderDevice, uint64_t ticket)
+{
+    return getCompletedTicket(renderDevice) >= ticket;
+}
+
+void waitForTicket(VulkanRenderDevice& renderDevice, uint64_t ticket)
+{
+    if (ticket == 0)
+        return;
+
+    VkSemaphoreWaitInfo semaphoreWaitInfo {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &renderDevice.timelineSemaphore,
+        .pValues = &ticket
+    };
+
+    VkResult result = vkWaitSemaphores(renderDevice.device, &semaphoreWaitInfo, UINT64_MAX);
+    vulkanCheck(result, "Failed to wait for timeline semaphore.");
+}
+
+void waitForAllTickets(VulkanRenderDevice& renderDevice)
+{
+    waitForTicket(renderDevice, renderDevice.lastSubmittedTicket);
+}
+
+void deferDestruction(VulkanRenderDevice& renderDevice, uint64_t ticket, std::function<void()> destroy)
+{
+    renderDevice.deletionQueue.pending.emplace_back(ticket, std::move(destroy));
+}
+
+void flushDeletionQueue(VulkanRenderDevice& renderDevice, bool waitForGPU)
+{
+    DeletionQueue& deletionQueue = renderDevice.deletionQueue;
+
+    if (waitForGPU)
+        waitForAllTickets(renderDevice);
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t completedTicket = getCompletedTicket(renderDevice);
+
+    // entries aren't strictly ordered by ticket, retired ones are moved to the back in request order
+    auto retired = std::stable_partition(deletionQueue.pending.begin(),
+                                         deletionQueue.pending.end(),
+                                         [completedTicket] (const PendingDestruction& pending) {
+                                             return pending.ticket > completedTicket;
+                                         });
+
+    // destroy callbacks may queue more work, so move the retired entries out first
+    std::vector<PendingDestruction> destructions(std::make_move_iterator(retired),
+                                                 std::make_move_iterator(deletionQueue.pending.end()));
+    deletionQueue.pending.erase(retired, deletionQueue.pending.end());
+
+    for (PendingDestruction& destruction : destructions)
+        destruction.destroy();
+
+    auto end = std::chrono::steady_clock::now();
+
+    deletionQueue.lastFlush = {
+        .destroyedCount = static_cast<uint32_t>(destructions.size()),
+        .cpuTimeMs = std::chrono::duration<double, std::milli>(end - start).count()
+    };
+
+    if (deletionQueue.lastFlush.cpuTimeMs > deletionQueue.worstFlush.cpuTimeMs)
+        deletionQueue.worstFlush = deletionQueue.lastFlush;
+}
+
 VulkanBuffer createBuffer(VulkanRenderDevice& renderDevice,
                           VkDeviceSize size,
                           VkBufferUsageFlags usage,
-                          VkMemoryPropertyFlags memoryProperties)
+                          VkMemoryPropertyFlags memoryProperties,
+                          MemoryCategory category)
 {
     VkBuffer buffer;
     VkDeviceMemory bufferMemory;
@@ -356,8 +765,7 @@ VulkanBuffer createBuffer(VulkanRenderDevice& renderDevice,
         .memoryTypeIndex = stagingBufferMemoryTypeIndex
     };
 
-    result = vkAllocateMemory(renderDevice.device, &memoryAllocateInfo, nullptr, &bufferMemory);
-    vulkanCheck(result, "Failed to allocate staging buffer memory.");
+    bufferMemory = allocateMemory(renderDevice, memoryAllocateInfo, category);
 
     vkBindBufferMemory(renderDevice.device, buffer, bufferMemory, 0);
 
@@ -369,9 +777,10 @@ VulkanBuffer createBuffer(VulkanRenderDevice& renderDevice,
                           VkDeviceSize size,
                           VkBufferUsageFlags usage,
                           VkMemoryPropertyFlags memoryProperties,
-                          void* bufferData)
+                          MemoryCategory category,
+                          const void* bufferData)
 {
-    VulkanBuffer buffer = createBuffer(renderDevice, size, usage, memoryProperties);
+    VulkanBuffer buffer = createBuffer(renderDevice, size, usage, memoryProperties, category);
 
     void* dataPtr;
     vkMapMemory(renderDevice.device, buffer.memory, 0, size, 0, &dataPtr);
@@ -383,14 +792,53 @@ VulkanBuffer createBuffer(VulkanRenderDevice& renderDevice,
 
 void destroyBuffer(VulkanRenderDevice& renderDevice, VulkanBuffer& buffer)
 {
+    waitForTicket(renderDevice, buffer.lastUse);
     vkDestroyBuffer(renderDevice.device, buffer.buffer, nullptr);
-    vkFreeMemory(renderDevice.device, buffer.memory, nullptr);
+    freeMemory(renderDevice, buffer.memory);
+}
+
+void deferDestroyBuffer(VulkanRenderDevice& renderDevice, VulkanBuffer& buffer)
+{
+    deferDestruction(renderDevice, renderDevice.lastSubmittedTicket, [&renderDevice, buffer] () mutable {
+        destroyBuffer(renderDevice, buffer);
+    });
+
+    buffer = VulkanBuffer();
+}
+
+// the stages and accesses that read a buffer with the given usage, later submissions wait
+// for the upload copy through them
+static std::pair<VkPipelineStageFlags2, VkAccessFlags2> getBufferReadScope(VkBufferUsageFlags usage)
+{
+    VkPipelineStageFlags2 stageMask = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 accessMask = VK_ACCESS_2_NONE;
+
+    if (usage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
+    {
+        stageMask |= VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT;
+        accessMask |= VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT;
+    }
+
+    if (usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
+    {
+        stageMask |= VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT;
+        accessMask |= VK_ACCESS_2_INDEX_READ_BIT;
+    }
+
+    if (usage & (VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT))
+    {
+        stageMask |= VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+        accessMask |= VK_ACCESS_2_SHADER_READ_BIT;
+    }
+
+    return {stageMask, accessMask};
 }
 
 VulkanBuffer createBufferWithStaging(VulkanRenderDevice& renderDevice,
                                      VkDeviceSize size,
                                      VkBufferUsageFlags usage,
-                                     void* bufferData)
+                                     MemoryCategory category,
+                                     const void* bufferData)
 {
     VkBufferUsageFlags stagingBufferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
 
@@ -403,6 +851,7 @@ VulkanBuffer createBufferWithStaging(VulkanRenderDevice& renderDevice,
                                               size,
                                               stagingBufferUsage,
                                               stagingBufferMemoryProperties,
+                                              MemoryCategory::Staging,
                                               bufferData);
 
     VkMemoryPropertyFlags bufferMemoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
@@ -410,30 +859,92 @@ VulkanBuffer createBufferWithStaging(VulkanRenderDevice& renderDevice,
     VulkanBuffer buffer = createBuffer(renderDevice,
                                        size,
                                        usage,
-                                       bufferMemoryProperties);
+                                       bufferMemoryProperties,
+                                       category);
+
+    auto [dstStageMask, dstAccessMask] = getBufferReadScope(usage);
 
-    copyBuffer(renderDevice, stagingBuffer, buffer, size);
+    buffer.lastUse = copyBuffer(renderDevice, stagingBuffer, buffer, size, dstStageMask, dstAccessMask);
 
-    destroyBuffer(renderDevice, stagingBuffer);
+    deferDestroyBuffer(renderDevice, stagingBuffer);
 
     return buffer;
 }
 
-VulkanBuffer createVertexBuffer(VulkanRenderDevice& renderDevice, VkDeviceSize size, void* bufferData)
+UniformRingBuffer createUniformRingBuffer(VulkanRenderDevice& renderDevice, VkDeviceSize frameSize)
+{
+    UniformRingBuffer ringBuffer {};
+
+    VkDeviceSize alignment = getPhysicalDeviceProperties(renderDevice).limits.minUniformBufferOffsetAlignment;
+
+    ringBuffer.alignment = alignment;
+    ringBuffer.frameSize = (frameSize + alignment - 1) / alignment * alignment;
+
+    VkMemoryPropertyFlags memoryProperties {
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    };
+
+    ringBuffer.buffer = createBuffer(renderDevice,
+                                     ringBuffer.frameSize * FRAMES_IN_FLIGHT,
+                                     VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                     memoryProperties,
+                                     MemoryCategory::Uniform);
+
+    // the buffer stays mapped for its whole lifetime
+    void* dataPtr;
+    VkResult result = vkMapMemory(renderDevice.device, ringBuffer.buffer.memory, 0, VK_WHOLE_SIZE, 0, &dataPtr);
+    vulkanCheck(result, "Failed to map uniform ring buffer.");
+
+    ringBuffer.mappedData = static_cast<uint8_t*>(dataPtr);
+
+    return ringBuffer;
+}
+
+void destroyUniformRingBuffer(VulkanRenderDevice& renderDevice, UniformRingBuffer& ringBuffer)
+{
+    vkUnmapMemory(renderDevice.device, ringBuffer.buffer.memory);
+    destroyBuffer(renderDevice, ringBuffer.buffer);
+}
+
+void beginUniformRingFrame(UniformRingBuffer& ringBuffer, uint32_t frameIndex)
+{
+    ringBuffer.frameOffset = ringBuffer.frameSize * frameIndex;
+    ringBuffer.head = 0;
+}
+
+UniformAllocation allocateUniform(UniformRingBuffer& ringBuffer, VkDeviceSize size)
+{
+    VkDeviceSize offset = ringBuffer.frameOffset + ringBuffer.head;
+
+    ringBuffer.head += (size + ringBuffer.alignment - 1) / ringBuffer.alignment * ringBuffer.alignment;
+
+    if (ringBuffer.head > ringBuffer.frameSize)
+        vulkanCheck(static_cast<VkResult>(~VK_SUCCESS), "Uniform ring buffer frame region exhausted.");
+
+    return {
+        .data = ringBuffer.mappedData + offset,
+        .offset = static_cast<uint32_t>(offset)
+    };
+}
+
+VulkanBuffer createVertexBuffer(VulkanRenderDevice& renderDevice, VkDeviceSize size, const void* bufferData)
 {
     return createBufferWithStaging(renderDevice,
                                    size,
                                    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                   MemoryCategory::Mesh,
                                    bufferData);
 }
 
-IndexBuffer createIndexBuffer(VulkanRenderDevice& renderDevice, VkDeviceSize size, void* bufferData)
+IndexBuffer createIndexBuffer(VulkanRenderDevice& renderDevice, VkDeviceSize size, const void* bufferData)
 {
     IndexBuffer indexBuffer;
 
     indexBuffer.buffer = createBufferWithStaging(renderDevice,
                                                  size,
                                                  VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                 MemoryCategory::Mesh,
                                                  bufferData);
     indexBuffer.count = size / sizeof(uint32_t);
 
@@ -446,7 +957,12 @@ void destroyIndexBuffer(VulkanRenderDevice& renderDevice, IndexBuffer& indexBuff
     indexBuffer = IndexBuffer();
 }
 
-void copyBuffer(VulkanRenderDevice& renderDevice, VulkanBuffer& srcBuffer, VulkanBuffer& dstBuffer, VkDeviceSize size)
+uint64_t copyBuffer(VulkanRenderDevice& renderDevice,
+                    VulkanBuffer& srcBuffer,
+                    VulkanBuffer& dstBuffer,
+                    VkDeviceSize size,
+                    VkPipelineStageFlags2 dstStageMask,
+                    VkAccessFlags2 dstAccessMask)
 {
     VkCommandBuffer commandBuffer = beginSingleCommand(renderDevice);
 
@@ -458,7 +974,32 @@ void copyBuffer(VulkanRenderDevice& renderDevice, VulkanBuffer& srcBuffer, Vulka
 
     vkCmdCopyBuffer(commandBuffer, srcBuffer.buffer, dstBuffer.buffer, 1, &copyRegion);
 
-    endSingleCommand(renderDevice, commandBuffer);
+    // the host doesn't wait for the copy, later draws on this queue are ordered after it here
+    VkBufferMemoryBarrier2 barrier {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+        .srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+        .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .dstStageMask = dstStageMask,
+        .dstAccessMask = dstAccessMask,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = dstBuffer.buffer,
+        .offset = 0,
+        .size = size
+    };
+
+    VkDependencyInfo dependencyInfo {
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .bufferMemoryBarrierCount = 1,
+        .pBufferMemoryBarriers = &barrier
+    };
+
+    vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+    uint64_t ticket = endSingleCommand(renderDevice, commandBuffer);
+    srcBuffer.lastUse = ticket;
+
+    return ticket;
 }
 
 std::optional<uint32_t> findSuitableMemoryType(VulkanRenderDevice& renderDevice,
@@ -478,8 +1019,193 @@ std::optional<uint32_t> findSuitableMemoryType(VulkanRenderDevice& renderDevice,
     return {};
 }
 
+VkDeviceMemory allocateMemory(VulkanRenderDevice& renderDevice,
+                              const VkMemoryAllocateInfo& allocateInfo,
+                              MemoryCategory category)
+{
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(renderDevice.physicalDevice, &memoryProperties);
+
+    uint32_t heapIndex = memoryProperties.memoryTypes[allocateInfo.memoryTypeIndex].heapIndex;
+
+    VkDeviceMemory memory;
+    VkResult result = vkAllocateMemory(renderDevice.device, &allocateInfo, nullptr, &memory);
+
+    if (result != VK_SUCCESS)
+    {
+        static constexpr double MB = 1024.0 * 1024.0;
+
+        MemoryHeapStats heap = getMemoryStats(renderDevice).heaps.at(heapIndex);
+
+        std::stringstream msg;
+        msg << "Failed to allocate " << allocateInfo.allocationSize / MB << " MB of "
+            << getMemoryCategoryName(category) << " memory, heap " << heapIndex << " uses "
+            << heap.usage / MB << " MB of its " << heap.budget / MB << " MB budget.";
+
+        vulkanCheck(result, msg.str().c_str());
+    }
+
+    MemoryTracker& tracker = renderDevice.memoryTracker;
+    std::lock_guard<std::mutex> lock(tracker.mutex);
+
+    uint32_t categoryIndex = static_cast<uint32_t>(category);
+
+    tracker.allocations.emplace(memory, TrackedAllocation(allocateInfo.allocationSize, heapIndex, category));
+    tracker.categoryBytes.at(categoryIndex) += allocateInfo.allocationSize;
+    tracker.peakCategoryBytes.at(categoryIndex) = std::max(tracker.peakCategoryBytes.at(categoryIndex),
+                                                           tracker.categoryBytes.at(categoryIndex));
+    ++tracker.categoryAllocationCounts.at(categoryIndex);
+    tracker.heapBytes.at(heapIndex) += allocateInfo.allocationSize;
+
+    return memory;
+}
+
+void freeMemory(VulkanRenderDevice& renderDevice, VkDeviceMemory memory)
+{
+    if (memory == VK_NULL_HANDLE)
+        return;
+
+    vkFreeMemory(renderDevice.device, memory, nullptr);
+
+    MemoryTracker& tracker = renderDevice.memoryTracker;
+    std::lock_guard<std::mutex> lock(tracker.mutex);
+
+    auto it = tracker.allocations.find(memory);
+    if (it == tracker.allocations.end())
+        return;
+
+    const TrackedAllocation& allocation = it->second;
+    uint32_t categoryIndex = static_cast<uint32_t>(allocation.category);
+
+    tracker.categoryBytes.at(categoryIndex) -= allocation.size;
+    --tracker.categoryAllocationCounts.at(categoryIndex);
+    tracker.heapBytes.at(allocation.heapIndex) -= allocation.size;
+    tracker.allocations.erase(it);
+}
+
+MemoryStats getMemoryStats(VulkanRenderDevice& renderDevice)
+{
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT
+    };
+
+    VkPhysicalDeviceMemoryProperties2 memoryProperties {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+        .pNext = renderDevice.memoryBudget? &budgetProperties : nullptr
+    };
+
+    vkGetPhysicalDeviceMemoryProperties2(renderDevice.physicalDevice, &memoryProperties);
+
+    MemoryTracker& tracker = renderDevice.memoryTracker;
+    std::lock_guard<std::mutex> lock(tracker.mutex);
+
+    MemoryStats stats {
+        .categoryBytes = tracker.categoryBytes,
+        .peakCategoryBytes = tracker.peakCategoryBytes,
+        .categoryAllocationCounts = tracker.categoryAllocationCounts,
+        .budgetQueried = renderDevice.memoryBudget
+    };
+
+    for (uint32_t i = 0; i < memoryProperties.memoryProperties.memoryHeapCount; ++i)
+    {
+        const VkMemoryHeap& heap = memoryProperties.memoryProperties.memoryHeaps[i];
+
+        stats.heaps.push_back({
+            .size = heap.size,
+            .budget = renderDevice.memoryBudget? budgetProperties.heapBudget[i] : heap.size,
+            .usage = renderDevice.memoryBudget? budgetProperties.heapUsage[i] : tracker.heapBytes.at(i),
+            .trackedBytes = tracker.heapBytes.at(i),
+            .deviceLocal = (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0
+        });
+    }
+
+    return stats;
+}
+
+const char* getMemoryCategoryName(MemoryCategory category)
+{
+    switch (category)
+    {
+        case MemoryCategory::Mesh: return "mesh";
+        case MemoryCategory::Texture: return "texture";
+        case MemoryCategory::Attachment: return "attachment";
+        case MemoryCategory::Staging: return "staging";
+        case MemoryCategory::Uniform: return "uniform";
+        default: return "unknown";
+    }
+}
+
+void writeMemoryReport(VulkanRenderDevice& renderDevice, const std::string& filename)
+{
+    MemoryStats stats = getMemoryStats(renderDevice);
+
+    std::ofstream file(filename);
+    vulkanCheck(static_cast<VkResult>(file.is_open()? VK_SUCCESS : ~VK_SUCCESS),
+                ("Failed to write memory report: " + filename).c_str());
+
+    file << "{\n  \"budgetQueried\": " << (stats.budgetQueried? "true" : "false") << ",\n  \"heaps\": [";
+
+    for (size_t i = 0; i < stats.heaps.size(); ++i)
+    {
+        const MemoryHeapStats& heap = stats.heaps.at(i);
+
+        file << (i > 0? "," : "") << "\n    {\"index\": " << i
+             << ", \"deviceLocal\": " << (heap.deviceLocal? "true" : "false")
+             << ", \"size\": " << heap.size
+             << ", \"budget\": " << heap.budget
+             << ", \"usage\": " << heap.usage
+             << ", \"tracked\": " << heap.trackedBytes << "}";
+    }
+
+    file << "\n  ],\n  \"categories\": {";
+
+    for (uint32_t i = 0; i < MEMORY_CATEGORY_COUNT; ++i)
+    {
+        file << (i > 0? "," : "") << "\n    \"" << getMemoryCategoryName(static_cast<MemoryCategory>(i))
+             << "\": {\"bytes\": " << stats.categoryBytes.at(i)
+             << ", \"peakBytes\": " << stats.peakCategoryBytes.at(i)
+             << ", \"allocations\": " << stats.categoryAllocationCounts.at(i) << "}";
+    }
+
+    file << "\n  }\n}\n";
+}
+
+uint32_t getTextureMipLevelsToDrop(VulkanRenderDevice& renderDevice, uint32_t width, uint32_t height)
+{
+    // leaves headroom for attachments recreated on resize and for other processes
+    static constexpr double BUDGET_PRESSURE_THRESHOLD = 0.9;
+    static constexpr uint32_t MAX_DROPPED_MIP_LEVELS = 3;
+
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(renderDevice.physicalDevice, &memoryProperties);
+
+    std::optional<uint32_t> memoryTypeIndex = findSuitableMemoryType(renderDevice, ~0u, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (!memoryTypeIndex.has_value())
+        return 0;
+
+    MemoryHeapStats heap = getMemoryStats(renderDevice).heaps.at(memoryProperties.memoryTypes[*memoryTypeIndex].heapIndex);
+    VkDeviceSize limit = static_cast<VkDeviceSize>(static_cast<double>(heap.budget) * BUDGET_PRESSURE_THRESHOLD);
+
+    // the full mip chain takes a third more than the base level
+    uint32_t droppedLevels = 0;
+    while (droppedLevels < MAX_DROPPED_MIP_LEVELS && std::max(width, height) >> droppedLevels > 1)
+    {
+        VkDeviceSize size = static_cast<VkDeviceSize>(width >> droppedLevels) * (height >> droppedLevels) * 4 * 4 / 3;
+
+        if (heap.usage + size <= limit)
+            break;
+
+        ++droppedLevels;
+    }
+
+    return droppedLevels;
+}
+
 VkCommandBuffer beginSingleCommand(VulkanRenderDevice& renderDevice)
 {
+    // keeps staging memory bounded during long upload sequences without any frames
+    flushDeletionQueue(renderDevice);
+
     VkCommandBuffer commandBuffer;
 
     VkCommandBufferAllocateInfo commandBufferAllocateInfo {
@@ -501,20 +1227,18 @@ VkCommandBuffer beginSingleCommand(VulkanRenderDevice& renderDevice)
     return commandBuffer;
 }
 
-void endSingleCommand(VulkanRenderDevice& renderDevice, VkCommandBuffer commandBuffer)
+uint64_t endSingleCommand(VulkanRenderDevice& renderDevice, VkCommandBuffer commandBuffer)
 {
     vkEndCommandBuffer(commandBuffer);
 
-    VkSubmitInfo submitInfo {
-        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-        .commandBufferCount = 1,
-        .pCommandBuffers = &commandBuffer,
-    };
+    // callers that need the result on the host wait for the returned ticket
+    uint64_t ticket = submitCommandBuffer(renderDevice, commandBuffer);
 
-    vkQueueSubmit(renderDevice.graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkDeviceWaitIdle(renderDevice.device);
+    deferDestruction(renderDevice, ticket, [&renderDevice, commandBuffer] () {
+        vkFreeCommandBuffers(renderDevice.device, renderDevice.commandPool, 1, &commandBuffer);
+    });
 
-    vkFreeCommandBuffers(renderDevice.device, renderDevice.commandPool, 1, &commandBuffer);
+    return ticket;
 }
 
 VulkanImage createImage(VulkanRenderDevice& renderDevice,
@@ -522,10 +1246,11 @@ VulkanImage createImage(VulkanRenderDevice& renderDevice,
                         uint32_t width, uint32_t height,
                         VkImageUsageFlags usage,
                         VkImageAspectFlags aspectMask,
+                        MemoryCategory category,
                         VkSampleCountFlagBits samples,
                         uint32_t mipLevels)
 {
-    VulkanImage image;
+    VulkanImage image {};
 
     // create image
     VkImageCreateInfo imageCreateInfo {
@@ -549,20 +1274,32 @@ VulkanImage createImage(VulkanRenderDevice& renderDevice,
     VkMemoryRequirements imageMemoryRequirements;
     vkGetImageMemoryRequirements(renderDevice.device, image.image, &imageMemoryRequirements);
 
-    VkMemoryPropertyFlags memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    // transient attachments never leave tile memory on tilers, so they prefer memory
+    // that is only backed when the implementation actually needs it
+    std::optional<uint32_t> imageMemoryTypeIndex;
+
+    if (usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT)
+    {
+        imageMemoryTypeIndex = findSuitableMemoryType(renderDevice,
+                                                      imageMemoryRequirements.memoryTypeBits,
+                                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+        image.lazilyAllocated = imageMemoryTypeIndex.has_value();
+    }
 
-    uint32_t imageMemoryTypeIndex = findSuitableMemoryType(renderDevice,
-                                                           imageMemoryRequirements.memoryTypeBits,
-                                                           memoryPropertyFlags).value();
+    if (!imageMemoryTypeIndex.has_value())
+    {
+        imageMemoryTypeIndex = findSuitableMemoryType(renderDevice,
+                                                      imageMemoryRequirements.memoryTypeBits,
+                                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
 
     VkMemoryAllocateInfo memoryAllocateInfo {
         .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
         .allocationSize = imageMemoryRequirements.size,
-        .memoryTypeIndex = imageMemoryTypeIndex
+        .memoryTypeIndex = imageMemoryTypeIndex.value()
     };
 
-    result = vkAllocateMemory(renderDevice.device, &memoryAllocateInfo, nullptr, &image.memory);
-    vulkanCheck(result, "Failed to allocate image memory.");
+    image.memory = allocateMemory(renderDevice, memoryAllocateInfo, category);
 
     vkBindImageMemory(renderDevice.device, image.image, image.memory, 0);
 
@@ -574,9 +1311,19 @@ VulkanImage createImage(VulkanRenderDevice& renderDevice,
 
 void destroyImage(VulkanRenderDevice& renderDevice, VulkanImage& image)
 {
+    waitForTicket(renderDevice, image.lastUse);
     vkDestroyImageView(renderDevice.device, image.imageView, nullptr);
     vkDestroyImage(renderDevice.device, image.image, nullptr);
-    vkFreeMemory(renderDevice.device, image.memory, nullptr);
+    freeMemory(renderDevice, image.memory);
+}
+
+void deferDestroyImage(VulkanRenderDevice& renderDevice, VulkanImage& image)
+{
+    deferDestruction(renderDevice, renderDevice.lastSubmittedTicket, [&renderDevice, image] () mutable {
+        destroyImage(renderDevice, image);
+    });
+
+    image = VulkanImage();
 }
 
 VkImageView createImageView(VulkanRenderDevice& renderDevice,
@@ -695,11 +1442,11 @@ VulkanTexture createTexture(VulkanRenderDevice& renderDevice, const std::string&
     VulkanTexture texture;
 
     // load image data
-    int width, height;
-
-    uint8_t* imageData = stbi_load(filename.c_str(), &width, &height, nullptr, STBI_rgb_alpha);
-    vulkanCheck(static_cast<VkResult>(imageData ? VK_SUCCESS : ~VK_SUCCESS), "Failed to load image data.");
+    ImageData imageData = loadImageData(filename);
+    vulkanCheck(static_cast<VkResult>(imageData.pixels ? VK_SUCCESS : ~VK_SUCCESS), "Failed to load image data.");
 
+    int width = imageData.width;
+    int height = imageData.height;
     VkDeviceSize size = width * height * 4;
 
     // create staging buffer
@@ -712,9 +1459,10 @@ VulkanTexture createTexture(VulkanRenderDevice& renderDevice, const std::string&
                                               size,
                                               VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                                               stagingBufferMemoryProperties,
-                                              imageData);
+                                              MemoryCategory::Staging,
+                                              imageData.pixels);
 
-    stbi_image_free(imageData);
+    freeImageData(imageData);
 
     // create image
     VkImageUsageFlags imageUsageFlags {
@@ -726,7 +1474,8 @@ VulkanTexture createTexture(VulkanRenderDevice& renderDevice, const std::string&
                                 VK_FORMAT_R8G8B8A8_UNORM,
                                 width, height,
                                 imageUsageFlags,
-                                VK_IMAGE_ASPECT_COLOR_BIT);
+                                VK_IMAGE_ASPECT_COLOR_BIT,
+                                MemoryCategory::Texture);
 
     // transition image layout for staging memory copy operation
     transitionImageLayout(renderDevice,
@@ -745,8 +1494,8 @@ VulkanTexture createTexture(VulkanRenderDevice& renderDevice, const std::string&
                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                           1);
 
-    // delete staging buffer
-    destroyBuffer(renderDevice, stagingBuffer);
+    // delete staging buffer once the copy retired
+    deferDestroyBuffer(renderDevice, stagingBuffer);
 
     // create sampler
     createSampler(renderDevice, texture, 1);
@@ -756,13 +1505,26 @@ VulkanTexture createTexture(VulkanRenderDevice& renderDevice, const std::string&
 
 VulkanTexture createTextureWithMips(VulkanRenderDevice& renderDevice, const std::string& filename)
 {
-    VulkanTexture texture;
+    ImageData imageData = loadImageData(filename);
+    vulkanCheck(static_cast<VkResult>(imageData.pixels ? VK_SUCCESS : ~VK_SUCCESS), "Failed to load image data.");
 
-    // load image data
-    int width, height;
+    TextureUploadStats stats {};
+    VulkanTexture texture = createTextureWithMips(renderDevice, imageData, stats);
+    freeImageData(imageData);
+
+    return texture;
+}
 
-    uint8_t* imageData = stbi_load(filename.c_str(), &width, &height, nullptr, STBI_rgb_alpha);
-    vulkanCheck(static_cast<VkResult>(imageData ? VK_SUCCESS : ~VK_SUCCESS), "Failed to load image data.");
+VulkanTexture createTextureWithMips(VulkanRenderDevice& renderDevice, const ImageData& imageData, TextureUploadStats& stats)
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    auto uploadStart = Clock::now();
+    VulkanTexture texture;
+
+    int width = imageData.width;
+    int height = imageData.height;
 
     VkDeviceSize size = width * height * 4;
     uint32_t mipLevels = static_cast<uint32_t>(glm::floor(glm::log2(glm::max(width, height)))) + 1;
@@ -777,9 +1539,8 @@ VulkanTexture createTextureWithMips(VulkanRenderDevice& renderDevice, const std:
                                               size,
                                               VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                                               stagingBufferMemoryProperties,
-                                              imageData);
-
-    stbi_image_free(imageData);
+                                              MemoryCategory::Staging,
+                                              imageData.pixels);
 
     // create texture
     VkImageUsageFlags imageUsage {
@@ -793,6 +1554,7 @@ VulkanTexture createTextureWithMips(VulkanRenderDevice& renderDevice, const std:
                                 width, height,
                                 imageUsage,
                                 VK_IMAGE_ASPECT_COLOR_BIT,
+                                MemoryCategory::Texture,
                                 VK_SAMPLE_COUNT_1_BIT,
                                 mipLevels);
 
@@ -806,12 +1568,20 @@ VulkanTexture createTextureWithMips(VulkanRenderDevice& renderDevice, const std:
     // copy buffer to image
     copyBufferToImage(renderDevice, stagingBuffer, texture.image, width, height);
 
-    // destroy staging buffer
-    destroyBuffer(renderDevice, stagingBuffer);
+    // destroy staging buffer once the copy retired
+    deferDestroyBuffer(renderDevice, stagingBuffer);
+
+    auto mipStart = Clock::now();
 
     // generate mips
     generateMipMaps(renderDevice, texture.image, width, height, mipLevels);
 
+    auto mipEnd = Clock::now();
+    stats.uploadMs += Milliseconds(mipStart - uploadStart).count();
+    stats.mipGenerationMs += Milliseconds(mipEnd - mipStart).count();
+    stats.uploadBytes += size;
+    stats.mipBytes += size / 3;
+
     // create sampler
     createSampler(renderDevice, texture, mipLevels);
 
@@ -824,6 +1594,15 @@ void destroyTexture(VulkanRenderDevice& renderDevice, VulkanTexture& texture)
     vkDestroySampler(renderDevice.device, texture.sampler, nullptr);
 }
 
+void deferDestroyTexture(VulkanRenderDevice& renderDevice, VulkanTexture& texture)
+{
+    deferDestruction(renderDevice, renderDevice.lastSubmittedTicket, [&renderDevice, texture] () mutable {
+        destroyTexture(renderDevice, texture);
+    });
+
+    texture = VulkanTexture();
+}
+
 void createSampler(VulkanRenderDevice& renderDevice, VulkanTexture& texture, uint32_t mipLevels)
 {
     VkBool32 anisotropyEnable = VK_FALSE;
@@ -953,6 +1732,180 @@ void generateMipMaps(VulkanRenderDevice& renderDevice,
     endSingleCommand(renderDevice, commandBuffer);
 }
 
+GpuTimer createGpuTimer(VulkanRenderDevice& renderDevice)
+{
+    GpuTimer gpuTimer {};
+
+    uint32_t queueFamilyPropertyCount;
+    vkGetPhysicalDeviceQueueFamilyProperties(renderDevice.physicalDevice, &queueFamilyPropertyCount, nullptr);
+
+    std::vector<VkQueueFamilyProperties> queueFamilyPropertiesVec(queueFamilyPropertyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(renderDevice.physicalDevice,
+                                             &queueFamilyPropertyCount,
+                                             queueFamilyPropertiesVec.data());
+
+    uint32_t timestampValidBits = queueFamilyPropertiesVec.at(renderDevice.graphicsQueueFamilyIndex).timestampValidBits;
+
+    gpuTimer.supported = timestampValidBits > 0;
+    gpuTimer.timestampPeriod = getPhysicalDeviceProperties(renderDevice).limits.timestampPeriod;
+
+    if (!gpuTimer.supported)
+        return gpuTimer;
+
+    VkQueryPoolCreateInfo queryPoolCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = 2 * FRAMES_IN_FLIGHT
+    };
+
+    VkResult result = vkCreateQueryPool(renderDevice.device, &queryPoolCreateInfo, nullptr, &gpuTimer.queryPool);
+    vulkanCheck(result, "Failed to create timestamp query pool.");
+
+    return gpuTimer;
+}
+
+void destroyGpuTimer(VulkanRenderDevice& renderDevice, GpuTimer& gpuTimer)
+{
+    vkDestroyQueryPool(renderDevice.device, gpuTimer.queryPool, nullptr);
+}
+
+void beginGpuTimer(GpuTimer& gpuTimer, VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+    if (!gpuTimer.supported)
+        return;
+
+    vkCmdResetQueryPool(commandBuffer, gpuTimer.queryPool, frameIndex * 2, 2);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, gpuTimer.queryPool, frameIndex * 2);
+}
+
+void endGpuTimer(GpuTimer& gpuTimer, VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+    if (!gpuTimer.supported)
+        return;
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, gpuTimer.queryPool, frameIndex * 2 + 1);
+    gpuTimer.written.at(frameIndex) = true;
+}
+
+// call after the frame's ticket retired
+std::optional<double> readGpuTimer(VulkanRenderDevice& renderDevice, GpuTimer& gpuTimer, uint32_t frameIndex)
+{
+    if (!gpuTimer.supported || !gpuTimer.written.at(frameIndex))
+        return {};
+
+    std::array<uint64_t, 2> timestamps;
+    VkResult result = vkGetQueryPoolResults(renderDevice.device,
+                                            gpuTimer.queryPool,
+                                            frameIndex * 2, 2,
+                                            sizeof(timestamps), timestamps.data(),
+                                            sizeof(uint64_t),
+                                            VK_QUERY_RESULT_64_BIT);
+    gpuTimer.written.at(frameIndex) = false;
+
+    if (result != VK_SUCCESS)
+        return {};
+
+    return static_cast<double>(timestamps.at(1) - timestamps.at(0)) * gpuTimer.timestampPeriod / 1e6;
+}
+
+PipelineStatistics createPipelineStatistics(VulkanRenderDevice& renderDevice)
+{
+    PipelineStatistics pipelineStatistics {};
+    pipelineStatistics.supported = renderDevice.enabledFeatures.pipelineStatisticsQuery &&
+                                   renderDevice.enabledFeatures.inheritedQueries;
+
+    if (!pipelineStatistics.supported)
+        return pipelineStatistics;
+
+    VkQueryPoolCreateInfo queryPoolCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+        .queryCount = FRAMES_IN_FLIGHT,
+        .pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT
+    };
+
+    VkResult result = vkCreateQueryPool(renderDevice.device, &queryPoolCreateInfo, nullptr, &pipelineStatistics.queryPool);
+    vulkanCheck(result, "Failed to create pipeline statistics query pool.");
+
+    return pipelineStatistics;
+}
+
+void destroyPipelineStatistics(VulkanRenderDevice& renderDevice, PipelineStatistics& pipelineStatistics)
+{
+    vkDestroyQueryPool(renderDevice.device, pipelineStatistics.queryPool, nullptr);
+}
+
+// has to be recorded outside of a render pass
+void resetPipelineStatistics(PipelineStatistics& pipelineStatistics, VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+    if (!pipelineStatistics.supported)
+        return;
+
+    vkCmdResetQueryPool(commandBuffer, pipelineStatistics.queryPool, frameIndex, 1);
+}
+
+// begin and end have to be in the same render pass instance when recorded inside one
+void beginPipelineStatistics(PipelineStatistics& pipelineStatistics, VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+    if (!pipelineStatistics.supported)
+        return;
+
+    vkCmdBeginQuery(commandBuffer, pipelineStatistics.queryPool, frameIndex, 0);
+}
+
+void endPipelineStatistics(PipelineStatistics& pipelineStatistics, VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+    if (!pipelineStatistics.supported)
+        return;
+
+    vkCmdEndQuery(commandBuffer, pipelineStatistics.queryPool, frameIndex);
+    pipelineStatistics.written.at(frameIndex) = true;
+}
+
+// call after the frame's ticket retired
+std::optional<uint64_t> readFragmentInvocations(VulkanRenderDevice& renderDevice,
+                                                PipelineStatistics& pipelineStatistics,
+                                                uint32_t frameIndex)
+{
+    if (!pipelineStatistics.supported || !pipelineStatistics.written.at(frameIndex))
+        return {};
+
+    uint64_t fragmentInvocations;
+    VkResult result = vkGetQueryPoolResults(renderDevice.device,
+                                            pipelineStatistics.queryPool,
+                                            frameIndex, 1,
+                                            sizeof(fragmentInvocations), &fragmentInvocations,
+                                            sizeof(uint64_t),
+                                            VK_QUERY_RESULT_64_BIT);
+    pipelineStatistics.written.at(frameIndex) = false;
+
+    if (result != VK_SUCCESS)
+        return {};
+
+    return fragmentInvocations;
+}
+
+VkDeviceSize getImageMemorySize(VulkanRenderDevice& renderDevice, VulkanImage& image)
+{
+    if (image.image == VK_NULL_HANDLE)
+        return 0;
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(renderDevice.device, image.image, &memoryRequirements);
+    return memoryRequirements.size;
+}
+
+// lazily allocated memory is only partially backed, or not at all
+VkDeviceSize getImageMemoryCommitment(VulkanRenderDevice& renderDevice, VulkanImage& image)
+{
+    if (!image.lazilyAllocated)
+        return getImageMemorySize(renderDevice, image);
+
+    VkDeviceSize committedSize;
+    vkGetDeviceMemoryCommitment(renderDevice.device, image.memory, &committedSize);
+    return committedSize;
+}
+
 VkShaderModule createShaderModule(VulkanRenderDevice& renderDevice, const std::string& filename)
 {
     std::ifstream spirv(filename, std::ios::binary | std::ios::ate);
@@ -981,6 +1934,63 @@ VkShaderModule createShaderModule(VulkanRenderDevice& renderDevice, const std::s
     return shaderModule;
 }
 
+VkPipelineCache createPipelineCache(VulkanRenderDevice& renderDevice, const std::string& filename)
+{
+    std::vector<char> cacheData;
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+
+    if (file.is_open())
+    {
+        cacheData.resize(file.tellg());
+        file.seekg(0);
+        file.read(cacheData.data(), cacheData.size());
+    }
+
+    // drivers should reject foreign data themselves, not all of them do
+    VkPhysicalDeviceProperties properties = getPhysicalDeviceProperties(renderDevice);
+    VkPipelineCacheHeaderVersionOne header {};
+
+    if (cacheData.size() >= sizeof(header))
+        memcpy(&header, cacheData.data(), sizeof(header));
+
+    bool compatible = header.headerSize >= sizeof(header) &&
+                      header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                      header.vendorID == properties.vendorID &&
+                      header.deviceID == properties.deviceID &&
+                      memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+
+    if (!compatible)
+        cacheData.clear();
+
+    VkPipelineCacheCreateInfo pipelineCacheCreateInfo {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = cacheData.size(),
+        .pInitialData = cacheData.data()
+    };
+
+    VkPipelineCache pipelineCache;
+    VkResult result = vkCreatePipelineCache(renderDevice.device, &pipelineCacheCreateInfo, nullptr, &pipelineCache);
+    vulkanCheck(result, "Failed to create pipeline cache.");
+
+    return pipelineCache;
+}
+
+bool savePipelineCache(VulkanRenderDevice& renderDevice, VkPipelineCache pipelineCache, const std::string& filename)
+{
+    size_t size;
+    if (vkGetPipelineCacheData(renderDevice.device, pipelineCache, &size, nullptr) != VK_SUCCESS)
+        return false;
+
+    std::vector<char> cacheData(size);
+    if (vkGetPipelineCacheData(renderDevice.device, pipelineCache, &size, cacheData.data()) != VK_SUCCESS)
+        return false;
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    file.write(cacheData.data(), size);
+
+    return file.good();
+}
+
 VkPhysicalDeviceProperties getPhysicalDeviceProperties(VulkanRenderDevice& renderDevice)
 {
     VkPhysicalDeviceProperties physicalDeviceProperties;
@@ -7,76 +7,133 @@
 
 #include <vector>
 #include <fstream>
+#include <algorithm>
 #include <optional>
 #include <glfw/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/integer.hpp>
 #include "vulkan_types.hpp"
+#include "../utils/image_data.hpp"
 #include "debug.hpp"
 
 
-void createInstance(VulkanInstance& instance);
+void createInstance(VulkanInstance& instance, bool headless);
 void destroyInstance(VulkanInstance& instance);
 
 void createSurface(VulkanInstance& instance, GLFWwindow* window);
 
 void createRenderingDevice(VulkanInstance& instance, VulkanRenderDevice& renderDevice);
+void createHeadlessRenderingDevice(VulkanInstance& instance, VulkanRenderDevice& renderDevice, VkExtent2D extent);
 void destroyRenderingDevice(VulkanRenderDevice& renderDevice);
 
-std::vector<const char*> getInstanceExtensions();
-std::vector<const char*> getDeviceExtensions();
+std::vector<const char*> getInstanceExtensions(bool headless);
+std::vector<const char*> getDeviceExtensions(bool headless);
 
 void pickPhysicalDevice(VulkanInstance& instance, VulkanRenderDevice& device);
 void createDevice(VulkanRenderDevice& renderDevice);
 std::optional<uint32_t> findQueueFamilyIndex(VulkanRenderDevice& renderDevice, VkQueueFlags capabilitiesFlags);
-
-void createSwapchain(VulkanInstance& instance, VulkanRenderDevice& renderDevice);
+bool isDeviceExtensionSupported(VulkanRenderDevice& renderDevice, const char* extension);
+bool supportsGraphicsPipelineLibrary(VulkanRenderDevice& renderDevice);
+
+void createSwapchain(VulkanInstance& instance,
+                     VulkanRenderDevice& renderDevice,
+                     VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
+VkPresentModeKHR choosePresentMode(VulkanInstance& instance, VulkanRenderDevice& renderDevice, PresentPolicy policy);
+const char* getPresentModeName(VkPresentModeKHR presentMode);
 void createSwapchainImages(VulkanRenderDevice& renderDevice);
+void createHeadlessImages(VulkanRenderDevice& renderDevice, VkExtent2D extent);
 
 void createCommandPool(VulkanRenderDevice& renderDevice);
-void createCommandBuffer(VulkanRenderDevice& renderDevice);
+void createFrames(VulkanRenderDevice& renderDevice);
+
+SecondaryCommandPool createSecondaryCommandPool(VulkanRenderDevice& renderDevice);
+void destroySecondaryCommandPool(VulkanRenderDevice& renderDevice, SecondaryCommandPool& pool);
+void resetSecondaryCommandPool(VulkanRenderDevice& renderDevice, SecondaryCommandPool& pool);
+VkCommandBuffer allocateSecondaryCommandBuffer(VulkanRenderDevice& renderDevice, SecondaryCommandPool& pool);
 
 VkSemaphore createSemaphore(VulkanRenderDevice& renderDevice);
+VkSemaphore createTimelineSemaphore(VulkanRenderDevice& renderDevice);
+
+uint64_t submitCommandBuffer(VulkanRenderDevice& renderDevice,
+                             VkCommandBuffer commandBuffer,
+                             VkSemaphore waitSemaphore = VK_NULL_HANDLE,
+                             VkPipelineStageFlags waitStage = 0,
+                             VkSemaphore signalSemaphore = VK_NULL_HANDLE);
+
+uint64_t getCompletedTicket(VulkanRenderDevice& renderDevice);
+bool isTicketComplete(VulkanRenderDevice& renderDevice, uint64_t ticket);
+void waitForTicket(VulkanRenderDevice& renderDevice, uint64_t ticket);
+void waitForAllTickets(VulkanRenderDevice& renderDevice);
+
+void deferDestruction(VulkanRenderDevice& renderDevice, uint64_t ticket, std::function<void()> destroy);
+void flushDeletionQueue(VulkanRenderDevice& renderDevice, bool waitForGPU = false);
 
 VulkanBuffer createBuffer(VulkanRenderDevice& renderDevice,
                           VkDeviceSize size,
                           VkBufferUsageFlags usage,
-                          VkMemoryPropertyFlags memoryProperties);
+                          VkMemoryPropertyFlags memoryProperties,
+                          MemoryCategory category);
 VulkanBuffer createBuffer(VulkanRenderDevice& renderDevice,
                           VkDeviceSize size,
                           VkBufferUsageFlags usage,
                           VkMemoryPropertyFlags memoryProperties,
-                          void* bufferData);
+                          MemoryCategory category,
+                          const void* bufferData);
 
 void destroyBuffer(VulkanRenderDevice& renderDevice, VulkanBuffer& buffer);
+void deferDestroyBuffer(VulkanRenderDevice& renderDevice, VulkanBuffer& buffer);
 
 VulkanBuffer createBufferWithStaging(VulkanRenderDevice& renderDevice,
                                      VkDeviceSize size,
                                      VkBufferUsageFlags usage,
-                                     void* bufferData);
+                                     MemoryCategory category,
+                                     const void* bufferData);
+
+UniformRingBuffer createUniformRingBuffer(VulkanRenderDevice& renderDevice, VkDeviceSize frameSize);
+void destroyUniformRingBuffer(VulkanRenderDevice& renderDevice, UniformRingBuffer& ringBuffer);
+void beginUniformRingFrame(UniformRingBuffer& ringBuffer, uint32_t frameIndex);
+UniformAllocation allocateUniform(UniformRingBuffer& ringBuffer, VkDeviceSize size);
 
-VulkanBuffer createVertexBuffer(VulkanRenderDevice& renderDevice, VkDeviceSize size, void* bufferData);
+VulkanBuffer createVertexBuffer(VulkanRenderDevice& renderDevice, VkDeviceSize size, const void* bufferData);
 
-IndexBuffer createIndexBuffer(VulkanRenderDevice& renderDevice, VkDeviceSize size, void* bufferData);
+IndexBuffer createIndexBuffer(VulkanRenderDevice& renderDevice, VkDeviceSize size, const void* bufferData);
 void destroyIndexBuffer(VulkanRenderDevice& renderDevice, IndexBuffer& indexBuffer);
 
-void copyBuffer(VulkanRenderDevice& renderDevice, VulkanBuffer& srcBuffer, VulkanBuffer& dstBuffer, VkDeviceSize size);
+uint64_t copyBuffer(VulkanRenderDevice& renderDevice,
+                    VulkanBuffer& srcBuffer,
+                    VulkanBuffer& dstBuffer,
+                    VkDeviceSize size,
+                    VkPipelineStageFlags2 dstStageMask,
+                    VkAccessFlags2 dstAccessMask);
 
 std::optional<uint32_t> findSuitableMemoryType(VulkanRenderDevice& renderDevice,
                                                uint32_t resourceSupportedMemoryTypes,
                                                VkMemoryPropertyFlags desiredMemoryProperties);
 
+// all device memory goes through these, so every allocation is accounted to its category
+VkDeviceMemory allocateMemory(VulkanRenderDevice& renderDevice,
+                              const VkMemoryAllocateInfo& allocateInfo,
+                              MemoryCategory category);
+void freeMemory(VulkanRenderDevice& renderDevice, VkDeviceMemory memory);
+
+MemoryStats getMemoryStats(VulkanRenderDevice& renderDevice);
+const char* getMemoryCategoryName(MemoryCategory category);
+void writeMemoryReport(VulkanRenderDevice& renderDevice, const std::string& filename);
+uint32_t getTextureMipLevelsToDrop(VulkanRenderDevice& renderDevice, uint32_t width, uint32_t height);
+
 VkCommandBuffer beginSingleCommand(VulkanRenderDevice& renderDevice);
-void endSingleCommand(VulkanRenderDevice& renderDevice, VkCommandBuffer commandBuffer);
+uint64_t endSingleCommand(VulkanRenderDevice& renderDevice, VkCommandBuffer commandBuffer);
 
 VulkanImage createImage(VulkanRenderDevice& renderDevice,
                         VkFormat format,
                         uint32_t width, uint32_t height,
                         VkImageUsageFlags usage,
                         VkImageAspectFlags aspectMask,
+                        MemoryCategory category,
                         VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT,
                         uint32_t mipLevels = 1);
 void destroyImage(VulkanRenderDevice& renderDevice, VulkanImage& image);
+void deferDestroyImage(VulkanRenderDevice& renderDevice, VulkanImage& image);
 
 VkImageView createImageView(VulkanRenderDevice& renderDevice,
                             VkImage image,
@@ -97,15 +154,40 @@ void copyBufferToImage(VulkanRenderDevice& renderDevice,
 
 VulkanTexture createTexture(VulkanRenderDevice& renderDevice, const std::string& filename);
 VulkanTexture createTextureWithMips(VulkanRenderDevice& renderDevice, const std::string& filename);
+VulkanTexture createTextureWithMips(VulkanRenderDevice& renderDevice, const ImageData& imageData, TextureUploadStats& stats);
 void destroyTexture(VulkanRenderDevice& renderDevice, VulkanTexture& texture);
+void deferDestroyTexture(VulkanRenderDevice& renderDevice, VulkanTexture& texture);
 void createSampler(VulkanRenderDevice& renderDevice, VulkanTexture& texture, uint32_t mipLevels);
 void generateMipMaps(VulkanRenderDevice& renderDevice,
                      VulkanImage& image,
                      uint32_t width, uint32_t height,
                      uint32_t mipLevels);
 
+GpuTimer createGpuTimer(VulkanRenderDevice& renderDevice);
+void destroyGpuTimer(VulkanRenderDevice& renderDevice, GpuTimer& gpuTimer);
+void beginGpuTimer(GpuTimer& gpuTimer, VkCommandBuffer commandBuffer, uint32_t frameIndex);
+void endGpuTimer(GpuTimer& gpuTimer, VkCommandBuffer commandBuffer, uint32_t frameIndex);
+std::optional<double> readGpuTimer(VulkanRenderDevice& renderDevice, GpuTimer& gpuTimer, uint32_t frameIndex);
+
+PipelineStatistics createPipelineStatistics(VulkanRenderDevice& renderDevice);
+void destroyPipelineStatistics(VulkanRenderDevice& renderDevice, PipelineStatistics& pipelineStatistics);
+void resetPipelineStatistics(PipelineStatistics& pipelineStatistics, VkCommandBuffer commandBuffer, uint32_t frameIndex);
+void beginPipelineStatistics(PipelineStatistics& pipelineStatistics, VkCommandBuffer commandBuffer, uint32_t frameIndex);
+void endPipelineStatistics(PipelineStatistics& pipelineStatistics, VkCommandBuffer commandBuffer, uint32_t frameIndex);
+std::optional<uint64_t> readFragmentInvocations(VulkanRenderDevice& renderDevice,
+                                                PipelineStatistics& pipelineStatistics,
+                                                uint32_t frameIndex);
+
+VkDeviceSize getImageMemorySize(VulkanRenderDevice& renderDevice, VulkanImage& image);
+VkDeviceSize getImageMemoryCommitment(VulkanRenderDevice& renderDevice, VulkanImage& image);
+
 VkShaderModule createShaderModule(VulkanRenderDevice& renderDevice, const std::string& filename);
 
+// starts from the file's contents when they were written for the same device and driver
+VkPipelineCache createPipelineCache(VulkanRenderDevice& renderDevice, const std::string& filename);
+// best effort, runs during shutdown. A cache that wasn't saved is rebuilt on the next start.
+bool savePipelineCache(VulkanRenderDevice& renderDevice, VkPipelineCache pipelineCache, const std::string& filename);
+
 VkPhysicalDeviceProperties getPhysicalDeviceProperties(VulkanRenderDevice& renderDevice);
 
 VkSampleCountFlagBits getMaxSampleCount(VulkanRenderDevice& renderDevice);
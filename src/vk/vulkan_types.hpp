@@ -5,11 +5,16 @@
 #ifndef VULKAN3DMODELVIEWER_VULKAN_TYPES_HPP
 #define VULKAN3DMODELVIEWER_VULKAN_TYPES_HPP
 
+#include <array>
+#include <mutex>
 #include <vector>
+#include <unordered_map>
 #include <vulkan/vulkan.h>
 #include <functional>
 
 
+static constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+
 struct VulkanInstance
 {
     VkInstance instance;
@@ -17,6 +22,94 @@ struct VulkanInstance
     VkDebugUtilsMessengerEXT debugMessenger;
 };
 
+// preference order used when picking the swapchain present mode
+enum class PresentPolicy
+{
+    VSync,          // FIFO
+    AdaptiveVSync,  // FIFO_RELAXED -> FIFO
+    LowLatency,     // MAILBOX -> IMMEDIATE -> FIFO
+    Uncapped        // IMMEDIATE -> MAILBOX -> FIFO
+};
+
+struct PendingDestruction
+{
+    uint64_t ticket;
+    std::function<void()> destroy;
+};
+
+struct DeletionStats
+{
+    uint32_t destroyedCount;
+    double cpuTimeMs;
+};
+
+// destruction requests run once the timeline semaphore reaches their ticket
+struct DeletionQueue
+{
+    std::vector<PendingDestruction> pending;
+    DeletionStats lastFlush;
+    DeletionStats worstFlush;
+};
+
+// what a device memory allocation holds, the memory tracker accounts usage per category
+enum class MemoryCategory
+{
+    Mesh,
+    Texture,
+    Attachment,
+    Staging,
+    Uniform
+};
+
+static constexpr uint32_t MEMORY_CATEGORY_COUNT = 5;
+
+struct TrackedAllocation
+{
+    VkDeviceSize size;
+    uint32_t heapIndex;
+    MemoryCategory category;
+};
+
+// every live device memory allocation, allocations may come from any thread
+struct MemoryTracker
+{
+    std::mutex mutex;
+    std::unordered_map<VkDeviceMemory, TrackedAllocation> allocations;
+    std::array<VkDeviceSize, MEMORY_CATEGORY_COUNT> categoryBytes {};
+    std::array<VkDeviceSize, MEMORY_CATEGORY_COUNT> peakCategoryBytes {};
+    std::array<uint32_t, MEMORY_CATEGORY_COUNT> categoryAllocationCounts {};
+    std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heapBytes {};
+};
+
+struct MemoryHeapStats
+{
+    VkDeviceSize size;
+    // how much the process can allocate before allocations fail or start paging, and how
+    // much it uses including memory allocated by the driver. Without VK_EXT_memory_budget
+    // the budget is the heap size and the usage only what the tracker knows about.
+    VkDeviceSize budget;
+    VkDeviceSize usage;
+    VkDeviceSize trackedBytes;
+    bool deviceLocal;
+};
+
+struct MemoryStats
+{
+    std::vector<MemoryHeapStats> heaps;
+    std::array<VkDeviceSize, MEMORY_CATEGORY_COUNT> categoryBytes;
+    std::array<VkDeviceSize, MEMORY_CATEGORY_COUNT> peakCategoryBytes;
+    std::array<uint32_t, MEMORY_CATEGORY_COUNT> categoryAllocationCounts;
+    bool budgetQueried;
+};
+
+struct VulkanFrame
+{
+    VkCommandBuffer commandBuffer;
+    VkSemaphore imageReadySemaphore;
+    VkSemaphore renderFinishedSemaphore;
+    uint64_t ticket;
+};
+
 struct VulkanRenderDevice
 {
     VkPhysicalDevice physicalDevice;
@@ -24,24 +117,87 @@ struct VulkanRenderDevice
     VkQueue graphicsQueue;
 
     VkCommandPool commandPool;
-    VkCommandBuffer commandBuffer;
 
     uint32_t graphicsQueueFamilyIndex;
 
-    VkSemaphore imageReadySemaphore;
-    VkSemaphore renderFinishedSemaphore;
+    // optional features are only enabled when the physical device has them
+    VkPhysicalDeviceFeatures enabledFeatures;
+    bool graphicsPipelineLibrary;
+    bool memoryBudget;
+
+    // every queue submission signals the timeline semaphore with a new value (ticket)
+    VkSemaphore timelineSemaphore;
+    uint64_t lastSubmittedTicket;
+
+    std::array<VulkanFrame, FRAMES_IN_FLIGHT> frames;
+    uint32_t frameIndex;
+
+    DeletionQueue deletionQueue;
+    MemoryTracker memoryTracker;
 
     VkSwapchainKHR swapchain;
+    PresentPolicy presentPolicy;
+    VkPresentModeKHR presentMode;
+    uint32_t requestedSwapchainImageCount;
     std::vector<VkImage> swapchainImages;
     std::vector<VkImageView> swapchainImageViews;
     VkFormat swapchainFormat;
     VkExtent2D swapchainExtent;
+
+    // without a surface, frames are rendered into these images in place of the swapchain's.
+    // There's one per frame in flight, nothing is acquired or presented.
+    bool headless;
+    std::vector<VulkanImage> headlessImages;
 };
 
 struct VulkanBuffer
 {
     VkBuffer buffer;
     VkDeviceMemory memory;
+    uint64_t lastUse;
+};
+
+// host visible buffer split into one region per frame in flight, addressed with dynamic offsets
+struct UniformRingBuffer
+{
+    VulkanBuffer buffer;
+    uint8_t* mappedData;
+    VkDeviceSize frameSize;
+    VkDeviceSize alignment;
+    VkDeviceSize frameOffset;
+    VkDeviceSize head;
+};
+
+struct UniformAllocation
+{
+    void* data;
+    uint32_t offset;
+};
+
+// pair of timestamps around each frame in flight
+struct GpuTimer
+{
+    VkQueryPool queryPool;
+    double timestampPeriod;
+    bool supported;
+    std::array<bool, FRAMES_IN_FLIGHT> written;
+};
+
+// secondary command buffers of one recording thread and frame in flight. The pool is
+// reset as a whole once its frame retired and the buffers are reused afterwards.
+struct SecondaryCommandPool
+{
+    VkCommandPool commandPool;
+    std::vector<VkCommandBuffer> commandBuffers;
+    uint32_t usedCount;
+};
+
+// fragment shader invocations of each frame in flight
+struct PipelineStatistics
+{
+    VkQueryPool queryPool;
+    bool supported;
+    std::array<bool, FRAMES_IN_FLIGHT> written;
 };
 
 struct IndexBuffer
@@ -55,6 +211,8 @@ struct VulkanImage
     VkImage image;
     VkImageView imageView;
     VkDeviceMemory memory;
+    bool lazilyAllocated;
+    uint64_t lastUse;
 };
 
 struct VulkanTexture
@@ -63,6 +221,15 @@ struct VulkanTexture
     VkSampler sampler;
 };
 
+// host time of texture creation by step, the GPU work is submitted but not waited for
+struct TextureUploadStats
+{
+    double uploadMs;
+    double mipGenerationMs;
+    VkDeviceSize uploadBytes;
+    VkDeviceSize mipBytes;
+};
+
 inline bool operator==(const VulkanTexture& left, const VulkanTexture& right)
 {
     return (left.image.image == right.image.image &&
@@ -0,0 +1,599 @@
+//
+// Created by Gianni on 19/10/2026.
+//
+
+// Writes synthetic scenes for scaling tests: a scene file placing the generated meshes,
+// one model file per unique mesh and one texture per material. Meshes are bumpy grid
+// patches with exactly the requested triangle count, so the importer, upload, culling and
+// draw paths can be measured from a single triangle up to a hundred million.
+
+#include <cmath>
+#include <array>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <filesystem>
+
+
+enum class MeshFormat
+{
+    Obj,
+    Ply // binary little endian
+};
+
+struct GeneratorOptions
+{
+    std::string outputDirectory;
+    uint64_t meshCount = 100; // meshes placed in the scene
+    uint64_t trianglesPerMesh = 10000;
+    uint64_t totalTriangles = 0; // overrides trianglesPerMesh when given
+    uint64_t instancingRatio = 1; // placements per unique mesh
+    uint32_t materialCount = 4;
+    uint32_t textureSize = 512; // 0 leaves the materials untextured
+    MeshFormat format = MeshFormat::Obj;
+    uint32_t seed = 1;
+};
+
+struct Vertex
+{
+    std::array<float, 3> position;
+    std::array<float, 3> normal;
+    std::array<float, 2> texCoords;
+};
+
+// triangles of a patch of rows x columns quads, the last quads stay empty to hit the count
+struct Patch
+{
+    uint64_t triangleCount;
+    uint64_t columns;
+    uint64_t rows;
+    float phaseX;
+    float phaseZ;
+    float frequency;
+};
+
+static constexpr float INSTANCE_SPACING = 2.5f;
+static constexpr size_t WRITE_BUFFER_SIZE = 1 << 20;
+// placed triangles, beyond it the output runs into tens of gigabytes and a typo fills the disk
+static constexpr uint64_t MAX_SCENE_TRIANGLES = 100'000'000;
+static constexpr double MB = 1024.0 * 1024.0;
+
+static void printUsage()
+{
+    std::cout << "Usage: vmv_scenegen <output directory> [options]\n"
+                 "    --meshes <n>              meshes placed in the scene (100)\n"
+                 "    --triangles-per-mesh <n>  triangles of every mesh (10000)\n"
+                 "    --triangles <n>           total triangles, rounded up to a multiple of the mesh count\n"
+                 "    --instancing <n>          placements per unique mesh (1)\n"
+                 "    --materials <n>           materials, assigned round robin (4)\n"
+                 "    --texture-size <n>        edge length of the textures, 0 for none (512)\n"
+                 "    --format <obj|ply>        text OBJ or binary PLY meshes (obj)\n"
+                 "    --seed <n>                varies the shapes and placements (1)\n"
+                 "The requested triangles are limited to 100000000 per scene.\n";
+}
+
+static GeneratorOptions parseGeneratorOptions(int argc, char** argv)
+{
+    GeneratorOptions options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        auto nextValue = [&] () -> std::string {
+            if (i + 1 >= argc)
+                throw std::runtime_error("Missing value for option: " + arg);
+            return argv[++i];
+        };
+
+        // stoul and stoull only name themselves in their exceptions
+        auto nextCount = [&] () -> uint64_t {
+            std::string value = nextValue();
+            try
+            {
+                return std::stoull(value);
+            }
+            catch (const std::logic_error&)
+            {
+                throw std::runtime_error("Invalid value for option " + arg + ": " + value);
+            }
+        };
+
+        if (arg == "--meshes")
+            options.meshCount = nextCount();
+        else if (arg == "--triangles-per-mesh")
+            options.trianglesPerMesh = nextCount();
+        else if (arg == "--triangles")
+            options.totalTriangles = nextCount();
+        else if (arg == "--instancing")
+            options.instancingRatio = nextCount();
+        else if (arg == "--materials")
+            options.materialCount = static_cast<uint32_t>(nextCount());
+        else if (arg == "--texture-size")
+            options.textureSize = static_cast<uint32_t>(nextCount());
+        else if (arg == "--format")
+        {
+            std::string format = nextValue();
+            if (format == "obj")
+                options.format = MeshFormat::Obj;
+            else if (format == "ply")
+                options.format = MeshFormat::Ply;
+            else
+                throw std::runtime_error("Unknown mesh format: " + format);
+        }
+        else if (arg == "--seed")
+            options.seed = static_cast<uint32_t>(nextCount());
+        else if (!arg.starts_with("--") && options.outputDirectory.empty())
+            options.outputDirectory = arg;
+        else
+            throw std::runtime_error("Unknown option: " + arg);
+    }
+
+    if (options.outputDirectory.empty())
+        throw std::runtime_error("Missing output directory");
+
+    if (options.meshCount == 0 || options.instancingRatio == 0 || options.materialCount == 0)
+        throw std::runtime_error("Mesh count, instancing ratio and material count have to be positive");
+
+    if (options.textureSize > UINT16_MAX)
+        throw std::runtime_error("Textures can be at most 65535 pixels wide");
+
+    // the cap is on the requested count, rounding --triangles up below adds less than a triangle per mesh.
+    // divided instead of multiplied, the product of two large counts would overflow
+    if (options.totalTriangles > MAX_SCENE_TRIANGLES || options.meshCount > MAX_SCENE_TRIANGLES ||
+        (options.totalTriangles == 0 && options.trianglesPerMesh > MAX_SCENE_TRIANGLES / options.meshCount))
+        throw std::runtime_error("Scenes can have at most 100000000 triangles, lower the mesh or triangle count");
+
+    // the meshes get the same count, so the total is rounded up to a multiple of the mesh count
+    if (options.totalTriangles > 0)
+        options.trianglesPerMesh = (options.totalTriangles + options.meshCount - 1) / options.meshCount;
+
+    if (options.trianglesPerMesh == 0)
+        throw std::runtime_error("Meshes need at least one triangle");
+
+    return options;
+}
+
+// buffered output, formatting a line at a time through snprintf is far slower without it
+class FileWriter
+{
+public:
+    explicit FileWriter(const std::filesystem::path& path)
+        : mFile(path, std::ios::binary)
+        , mBytesWritten()
+    {
+        if (!mFile.is_open())
+            throw std::runtime_error("Failed to write " + path.string());
+
+        mBuffer.reserve(WRITE_BUFFER_SIZE);
+    }
+
+    ~FileWriter()
+    {
+        flush();
+    }
+
+    void write(const void* data, size_t size)
+    {
+        if (mBuffer.size() + size > WRITE_BUFFER_SIZE)
+            flush();
+
+        mBuffer.append(static_cast<const char*>(data), size);
+        mBytesWritten += size;
+    }
+
+    template<typename... Args>
+    void print(const char* format, Args... args)
+    {
+        char line[256];
+        int length = std::snprintf(line, sizeof(line), format, args...);
+        write(line, static_cast<size_t>(std::min(length, static_cast<int>(sizeof(line)) - 1)));
+    }
+
+    void flush()
+    {
+        mFile.write(mBuffer.data(), static_cast<std::streamsize>(mBuffer.size()));
+        mBuffer.clear();
+    }
+
+    uint64_t bytesWritten() const
+    {
+        return mBytesWritten;
+    }
+
+private:
+    std::ofstream mFile;
+    std::string mBuffer;
+    uint64_t mBytesWritten;
+};
+
+static Patch getPatch(uint64_t triangleCount, std::mt19937& random)
+{
+    std::uniform_real_distribution<float> phase(0.f, 6.2831853f);
+    std::uniform_real_distribution<float> frequency(2.f, 8.f);
+
+    uint64_t quadCount = (triangleCount + 1) / 2;
+    auto columns = static_cast<uint64_t>(std::ceil(std::sqrt(static_cast<double>(quadCount))));
+    uint64_t rows = (quadCount + columns - 1) / columns;
+
+    return {triangleCount, columns, rows, phase(random), phase(random), frequency(random)};
+}
+
+static uint64_t getVertexCount(const Patch& patch)
+{
+    return (patch.columns + 1) * (patch.rows + 1);
+}
+
+static uint64_t getDigitCount(uint64_t value)
+{
+    uint64_t digits = 1;
+
+    for (; value >= 10; value /= 10)
+        ++digits;
+
+    return digits;
+}
+
+// from typical line lengths for OBJ, the index digits are taken from the largest index
+static uint64_t getEstimatedMeshSize(const Patch& patch, MeshFormat format)
+{
+    uint64_t vertexCount = getVertexCount(patch);
+
+    if (format == MeshFormat::Ply)
+        return 512 + vertexCount * sizeof(float) * 8 + patch.triangleCount * 13;
+
+    uint64_t faceLineSize = 2 + 3 * (3 * getDigitCount(vertexCount) + 3);
+    return 64 + vertexCount * 80 + patch.triangleCount * faceLineSize;
+}
+
+// a height field over the unit square, with the normal from its derivatives
+static Vertex getPatchVertex(const Patch& patch, uint64_t column, uint64_t row)
+{
+    static constexpr float amplitude = 0.05f;
+
+    float u = static_cast<float>(column) / static_cast<float>(patch.columns);
+    float v = static_cast<float>(row) / static_cast<float>(patch.rows);
+
+    float sinX = std::sin(u * patch.frequency + patch.phaseX);
+    float cosX = std::cos(u * patch.frequency + patch.phaseX);
+    float sinZ = std::sin(v * patch.frequency + patch.phaseZ);
+    float cosZ = std::cos(v * patch.frequency + patch.phaseZ);
+
+    float height = amplitude * sinX * cosZ;
+    float dx = amplitude * patch.frequency * cosX * cosZ;
+    float dz = -amplitude * patch.frequency * sinX * sinZ;
+    float length = std::sqrt(dx * dx + 1.f + dz * dz);
+
+    return {
+        {u - 0.5f, height, v - 0.5f},
+        {-dx / length, 1.f / length, -dz / length},
+        {u, v}
+    };
+}
+
+// calls emit with the three vertex indices of every triangle
+template<typename Emit>
+static void forEachTriangle(const Patch& patch, Emit emit)
+{
+    uint64_t stride = patch.columns + 1;
+    uint64_t emitted = 0;
+
+    for (uint64_t row = 0; row < patch.rows; ++row)
+    {
+        for (uint64_t column = 0; column < patch.columns; ++column)
+        {
+            uint64_t v0 = row * stride + column;
+            uint64_t v1 = v0 + 1;
+            uint64_t v2 = v0 + stride;
+            uint64_t v3 = v2 + 1;
+
+            for (const std::array<uint64_t, 3>& triangle : {std::array {v0, v2, v1}, std::array {v1, v2, v3}})
+            {
+                if (emitted++ == patch.triangleCount)
+                    return;
+
+                emit(triangle);
+            }
+        }
+    }
+}
+
+static std::string getMaterialName(uint32_t material)
+{
+    return "material_" + std::to_string(material);
+}
+
+static std::string getTextureName(uint32_t material)
+{
+    return "texture_" + std::to_string(material) + ".tga";
+}
+
+static std::array<uint8_t, 3> getMaterialColor(uint32_t material)
+{
+    // spread the hues with the golden ratio
+    float hue = std::fmod(static_cast<float>(material) * 0.618034f, 1.f) * 6.f;
+    float x = 1.f - std::abs(std::fmod(hue, 2.f) - 1.f);
+
+    std::array<float, 3> color {};
+    switch (static_cast<int>(hue))
+    {
+        case 0: color = {1.f, x, 0.f}; break;
+        case 1: color = {x, 1.f, 0.f}; break;
+        case 2: color = {0.f, 1.f, x}; break;
+        case 3: color = {0.f, x, 1.f}; break;
+        case 4: color = {x, 0.f, 1.f}; break;
+        default: color = {1.f, 0.f, x}; break;
+    }
+
+    return {
+        static_cast<uint8_t>(64 + color.at(0) * 191),
+        static_cast<uint8_t>(64 + color.at(1) * 191),
+        static_cast<uint8_t>(64 + color.at(2) * 191)
+    };
+}
+
+// uncompressed 32 bit TGA with a checker pattern in the material's color
+static uint64_t writeTexture(const std::filesystem::path& path, uint32_t size, uint32_t material)
+{
+    FileWriter file(path);
+
+    std::array<uint8_t, 18> header {};
+    header.at(2) = 2; // uncompressed true color
+    header.at(12) = static_cast<uint8_t>(size);
+    header.at(13) = static_cast<uint8_t>(size >> 8);
+    header.at(14) = static_cast<uint8_t>(size);
+    header.at(15) = static_cast<uint8_t>(size >> 8);
+    header.at(16) = 32;
+    header.at(17) = 0x28; // 8 alpha bits, rows from the top
+    file.write(header.data(), header.size());
+
+    std::array<uint8_t, 3> color = getMaterialColor(material);
+    uint32_t cellSize = std::max(size / 8, 1u);
+    std::vector<uint8_t> row(static_cast<size_t>(size) * 4);
+
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            bool dark = (x / cellSize + y / cellSize) % 2;
+            uint8_t* pixel = row.data() + static_cast<size_t>(x) * 4;
+
+            // BGRA
+            pixel[0] = dark? color.at(2) / 2 : color.at(2);
+            pixel[1] = dark? color.at(1) / 2 : color.at(1);
+            pixel[2] = dark? color.at(0) / 2 : color.at(0);
+            pixel[3] = 255;
+        }
+
+        file.write(row.data(), row.size());
+    }
+
+    return file.bytesWritten();
+}
+
+static uint64_t writeMaterialLibrary(const std::filesystem::path& path, const GeneratorOptions& options)
+{
+    FileWriter file(path);
+
+    for (uint32_t material = 0; material < options.materialCount; ++material)
+    {
+        std::array<uint8_t, 3> color = getMaterialColor(material);
+
+        file.print("newmtl %s\n", getMaterialName(material).c_str());
+        file.print("Kd %.3f %.3f %.3f\n", color.at(0) / 255.f, color.at(1) / 255.f, color.at(2) / 255.f);
+
+        if (options.textureSize > 0)
+            file.print("map_Kd %s\n", getTextureName(material).c_str());
+
+        file.print("\n");
+    }
+
+    return file.bytesWritten();
+}
+
+static uint64_t writeObjMesh(const std::filesystem::path& path, const Patch& patch, uint32_t material)
+{
+    FileWriter file(path);
+
+    file.print("mtllib materials.mtl\n");
+
+    for (uint64_t row = 0; row <= patch.rows; ++row)
+    {
+        for (uint64_t column = 0; column <= patch.columns; ++column)
+        {
+            Vertex vertex = getPatchVertex(patch, column, row);
+
+            file.print("v %.6f %.6f %.6f\n", vertex.position.at(0), vertex.position.at(1), vertex.position.at(2));
+            file.print("vn %.5f %.5f %.5f\n", vertex.normal.at(0), vertex.normal.at(1), vertex.normal.at(2));
+            file.print("vt %.6f %.6f\n", vertex.texCoords.at(0), vertex.texCoords.at(1));
+        }
+    }
+
+    file.print("usemtl %s\n", getMaterialName(material).c_str());
+
+    // OBJ indices start at 1, every vertex has a position, texture coordinate and normal of the same index
+    forEachTriangle(patch, [&file] (const std::array<uint64_t, 3>& triangle) {
+        unsigned long long a = triangle.at(0) + 1;
+        unsigned long long b = triangle.at(1) + 1;
+        unsigned long long c = triangle.at(2) + 1;
+
+        file.print("f %llu/%llu/%llu %llu/%llu/%llu %llu/%llu/%llu\n", a, a, a, b, b, b, c, c, c);
+    });
+
+    return file.bytesWritten();
+}
+
+static uint64_t writePlyMesh(const std::filesystem::path& path,
+                             const Patch& patch,
+                             uint32_t material,
+                             const GeneratorOptions& options)
+{
+    if (getVertexCount(patch) > UINT32_MAX)
+        throw std::runtime_error("Too many vertices for 32 bit PLY indices");
+
+    FileWriter file(path);
+
+    file.print("ply\nformat binary_little_endian 1.0\n");
+
+    // the texture comment is how assimp's PLY importer finds a mesh's texture
+    if (options.textureSize > 0)
+        file.print("comment TextureFile %s\n", getTextureName(material).c_str());
+
+    file.print("element vertex %llu\n", static_cast<unsigned long long>(getVertexCount(patch)));
+    file.print("property float x\nproperty float y\nproperty float z\n");
+    file.print("property float nx\nproperty float ny\nproperty float nz\n");
+    file.print("property float s\nproperty float t\n");
+    file.print("element face %llu\n", static_cast<unsigned long long>(patch.triangleCount));
+    file.print("property list uchar uint vertex_indices\nend_header\n");
+
+    // Vertex has no padding, its floats are in the order the header declares
+    static_assert(sizeof(Vertex) == 8 * sizeof(float));
+
+    for (uint64_t row = 0; row <= patch.rows; ++row)
+    {
+        for (uint64_t column = 0; column <= patch.columns; ++column)
+        {
+            Vertex vertex = getPatchVertex(patch, column, row);
+            file.write(&vertex, sizeof(vertex));
+        }
+    }
+
+    forEachTriangle(patch, [&file] (const std::array<uint64_t, 3>& triangle) {
+        std::array<uint8_t, 13> face {3};
+
+        for (size_t i = 0; i < 3; ++i)
+        {
+            auto index = static_cast<uint32_t>(triangle.at(i));
+            std::memcpy(face.data() + 1 + i * 4, &index, sizeof(index));
+        }
+
+        file.write(face.data(), face.size());
+    });
+
+    return file.bytesWritten();
+}
+
+// instances fill a square grid in the xz plane, unique meshes are interleaved across it
+static uint64_t writeScene(const std::filesystem::path& path,
+                           const std::vector<std::string>& meshFiles,
+                           const GeneratorOptions& options,
+                           std::mt19937& random)
+{
+    std::uniform_real_distribution<float> rotation(0.f, 360.f);
+
+    auto gridSize = static_cast<uint64_t>(std::ceil(std::sqrt(static_cast<double>(options.meshCount))));
+    float offset = static_cast<float>(gridSize - 1) * INSTANCE_SPACING * 0.5f;
+
+    FileWriter file(path);
+
+    file.print("# %llu meshes of %llu triangles, %llu unique\n",
+               static_cast<unsigned long long>(options.meshCount),
+               static_cast<unsigned long long>(options.trianglesPerMesh),
+               static_cast<unsigned long long>(meshFiles.size()));
+
+    for (uint64_t mesh = 0; mesh < meshFiles.size(); ++mesh)
+    {
+        file.print("model %s\n", meshFiles.at(mesh).c_str());
+
+        for (uint64_t instance = mesh; instance < options.meshCount; instance += meshFiles.size())
+        {
+            float x = static_cast<float>(instance % gridSize) * INSTANCE_SPACING - offset;
+            float z = static_cast<float>(instance / gridSize) * INSTANCE_SPACING - offset;
+
+            file.print("instance %.3f 0 %.3f 0 %.1f 0\n", x, z, rotation(random));
+        }
+    }
+
+    return file.bytesWritten();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || std::string(argv[1]) == "--help")
+    {
+        printUsage();
+        return argc < 2;
+    }
+
+    GeneratorOptions options;
+
+    try
+    {
+        options = parseGeneratorOptions(argc, argv);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << "\n\n";
+        printUsage();
+        return 1;
+    }
+
+    std::filesystem::path directory(options.outputDirectory);
+    std::filesystem::create_directories(directory);
+
+    std::mt19937 random(options.seed);
+    uint64_t uniqueMeshCount = (options.meshCount + options.instancingRatio - 1) / options.instancingRatio;
+    uint64_t bytesWritten = 0;
+
+    // the phases don't change the size, a throwaway generator leaves the seeded shapes as they were
+    std::mt19937 estimateRandom;
+    Patch estimatePatch = getPatch(options.trianglesPerMesh, estimateRandom);
+    uint64_t estimatedSize = uniqueMeshCount * getEstimatedMeshSize(estimatePatch, options.format);
+    estimatedSize += options.meshCount * 48;
+
+    if (options.textureSize > 0)
+    {
+        uint64_t textureSize = options.textureSize;
+        estimatedSize += options.materialCount * (18 + textureSize * textureSize * 4);
+    }
+
+    std::cout << "Writing about " << static_cast<double>(estimatedSize) / MB << " MB to " << directory.string() << '\n';
+
+    if (options.textureSize > 0)
+    {
+        for (uint32_t material = 0; material < options.materialCount; ++material)
+            bytesWritten += writeTexture(directory / getTextureName(material), options.textureSize, material);
+    }
+
+    if (options.format == MeshFormat::Obj)
+        bytesWritten += writeMaterialLibrary(directory / "materials.mtl", options);
+
+    std::vector<std::string> meshFiles;
+    meshFiles.reserve(uniqueMeshCount);
+
+    for (uint64_t mesh = 0; mesh < uniqueMeshCount; ++mesh)
+    {
+        auto material = static_cast<uint32_t>(mesh % options.materialCount);
+        Patch patch = getPatch(options.trianglesPerMesh, random);
+
+        if (options.format == MeshFormat::Obj)
+        {
+            meshFiles.push_back("mesh_" + std::to_string(mesh) + ".obj");
+            bytesWritten += writeObjMesh(directory / meshFiles.back(), patch, material);
+        }
+        else
+        {
+            meshFiles.push_back("mesh_" + std::to_string(mesh) + ".ply");
+            bytesWritten += writePlyMesh(directory / meshFiles.back(), patch, material, options);
+        }
+    }
+
+    bytesWritten += writeScene(directory / "scene.txt", meshFiles, options, random);
+
+    std::cout << "Wrote " << (directory / "scene.txt").string() << ": "
+              << options.meshCount * options.trianglesPerMesh << " triangles in " << options.meshCount
+              << " meshes (" << uniqueMeshCount << " unique, " << uniqueMeshCount * options.trianglesPerMesh
+              << " triangles stored), " << options.materialCount << " materials, "
+              << static_cast<double>(bytesWritten) / MB << " MB\n";
+
+    if (options.totalTriangles > 0 && options.totalTriangles % options.meshCount != 0)
+        std::cout << "--triangles " << options.totalTriangles << " was rounded up to a multiple of the "
+                  << options.meshCount << " meshes\n";
+}